@@ -67,13 +67,6 @@ static const struct device *const pll_dev_1 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL
 #define IP_TMR_ADDR     0x5
 #define IP_CFG1_ADDR    0x6
 
-/* therm_trip temperature in degrees C */
-#define ALARM_A_THERM_TRIP_TEMP 83
-/* BH prod spec 7.3 gives Tj,shutdown=110C, tmons are +-1C calibrated */
-#define ALARM_B_THERM_TRIP_TEMP 109
-
-#define TS_HYSTERESIS_DELTA 5
-
 #define ALL_AGING_OSC 0x7 /* enable delay chain 19, 20, 21 for aging measurement */
 
 #define NUM_TS 8
@@ -267,8 +260,9 @@ static inline void pvt_tt_bh_interrupt_config(void)
 	pvt_cntl_vm_alarma_cfg_reg_u pvt_alarma_cfg;
 
 	pvt_alarma_cfg.val = PVT_CNTL_VM_ALARMA_CFG_REG_DEFAULT;
-	pvt_alarma_cfg.f.hyst_thresh = temp_to_dout(ALARM_A_THERM_TRIP_TEMP - TS_HYSTERESIS_DELTA);
-	pvt_alarma_cfg.f.alarm_thresh = temp_to_dout(ALARM_A_THERM_TRIP_TEMP);
+	pvt_alarma_cfg.f.hyst_thresh =
+		temp_to_dout(PVT_TT_BH_ALARM_A_TEMP - PVT_TT_BH_ALARM_HYSTERESIS);
+	pvt_alarma_cfg.f.alarm_thresh = temp_to_dout(PVT_TT_BH_ALARM_A_TEMP);
 	for (uint32_t i = 0; i < NUM_TS; i++) {
 		sys_write32(pvt_alarma_cfg.val, GET_TS_REG_ADDR(i, ALARMA_CFG));
 	}
@@ -277,8 +271,9 @@ static inline void pvt_tt_bh_interrupt_config(void)
 	pvt_cntl_vm_alarmb_cfg_reg_u pvt_alarmb_cfg;
 
 	pvt_alarmb_cfg.val = PVT_CNTL_VM_ALARMB_CFG_REG_DEFAULT;
-	pvt_alarmb_cfg.f.hyst_thresh = temp_to_dout(ALARM_B_THERM_TRIP_TEMP - TS_HYSTERESIS_DELTA);
-	pvt_alarmb_cfg.f.alarm_thresh = temp_to_dout(ALARM_B_THERM_TRIP_TEMP);
+	pvt_alarmb_cfg.f.hyst_thresh =
+		temp_to_dout(PVT_TT_BH_ALARM_B_TEMP - PVT_TT_BH_ALARM_HYSTERESIS);
+	pvt_alarmb_cfg.f.alarm_thresh = temp_to_dout(PVT_TT_BH_ALARM_B_TEMP);
 	for (uint32_t i = 0; i < NUM_TS; i++) {
 		sys_write32(pvt_alarmb_cfg.val, GET_TS_REG_ADDR(i, ALARMB_CFG));
 	}
@@ -447,13 +442,17 @@ static int pvt_tt_bh_init(const struct device *dev)
 		}
 	}
 
+	if (IS_ENABLED(CONFIG_PVT_TT_BH_SCAN)) {
+		pvt_tt_bh_scan_start(dev);
+	}
+
 	return 0;
 }
 
 static const struct sensor_driver_api pvt_tt_bh_driver_api = {
 	.attr_set = NULL,
 	.attr_get = pvt_tt_bh_attr_get,
-	.trigger_set = NULL,
+	.trigger_set = pvt_tt_bh_trigger_set,
 
 	/* Not implemented due to newer read (submit) and decode API preferred. */
 	.sample_fetch = NULL,
@@ -474,7 +473,16 @@ static const struct sensor_driver_api pvt_tt_bh_driver_api = {
 		.therm_cali_delta = pvt_tt_bh_therm_cali_delta,                                    \
 	};                                                                                         \
                                                                                                    \
-	static struct pvt_tt_bh_data pvt_tt_bh_data_##_id = {};                                    \
+	IF_ENABLED(CONFIG_PVT_TT_BH_SCAN,                                                          \
+		   (static struct pvt_tt_bh_sample                                                 \
+			    pvt_tt_bh_ts_cache[DT_PROP(DT_DRV_INST(id), num_ts)];                  \
+		    static struct pvt_tt_bh_sample                                                 \
+			    pvt_tt_bh_pd_cache[DT_PROP(DT_DRV_INST(id), num_pd)];))                \
+                                                                                                   \
+	static struct pvt_tt_bh_data pvt_tt_bh_data_##_id = {                                      \
+		IF_ENABLED(CONFIG_PVT_TT_BH_SCAN,                                                  \
+			   (.ts = pvt_tt_bh_ts_cache, .pd = pvt_tt_bh_pd_cache,))                  \
+	};                                                                                         \
                                                                                                    \
 	DEVICE_DT_INST_DEFINE(id, pvt_tt_bh_init, NULL, &pvt_tt_bh_data_##_id,                     \
 			      &pvt_tt_bh_config_##_id, POST_KERNEL, CONFIG_SENSOR_INIT_PRIORITY,   \
@@ -136,7 +136,8 @@ static int pvt_tt_bh_decode_sample(const uint8_t *buf, struct sensor_chan_spec c
 			break;
 		}
 		case SENSOR_CHAN_PVT_TT_BH_TS:
-		case SENSOR_CHAN_PVT_TT_BH_TS_AVG: {
+		case SENSOR_CHAN_PVT_TT_BH_TS_AVG:
+		case SENSOR_CHAN_PVT_TT_BH_TS_MAX: {
 			data_converted = pvt_tt_bh_raw_to_temp(data->raw);
 			break;
 		}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief PVT emulation driver for native simulation
+ *
+ * Accepts the temperature alarm triggers of the PVT driver, and raises them
+ * when a test asks it to.
+ */
+
+#define DT_DRV_COMPAT tenstorrent_bh_pvt_emul
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
+#include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+struct pvt_tt_bh_emul_data {
+	struct k_spinlock lock;
+	sensor_trigger_handler_t handler[2]; /* SENSOR_TRIG_PVT_TT_BH_ALARM_A, _B */
+	const struct sensor_trigger *trigger[2];
+};
+
+static int pvt_tt_bh_emul_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+				      sensor_trigger_handler_t handler)
+{
+	struct pvt_tt_bh_emul_data *data = dev->data;
+	uint32_t alarm = (int)trig->type - SENSOR_TRIG_PVT_TT_BH_ALARM_A;
+
+	if (alarm >= ARRAY_SIZE(data->handler) || (int)trig->chan != SENSOR_CHAN_PVT_TT_BH_TS_MAX) {
+		return -ENOTSUP;
+	}
+
+	K_SPINLOCK(&data->lock) {
+		data->handler[alarm] = handler;
+		data->trigger[alarm] = trig;
+	}
+
+	return 0;
+}
+
+int pvt_tt_bh_emul_raise_alarm(const struct device *dev, enum pvt_tt_bh_trigger alarm)
+{
+	struct pvt_tt_bh_emul_data *data = dev->data;
+	uint32_t i = alarm - SENSOR_TRIG_PVT_TT_BH_ALARM_A;
+	sensor_trigger_handler_t handler = NULL;
+	const struct sensor_trigger *trigger = NULL;
+
+	if (i >= ARRAY_SIZE(data->handler)) {
+		return -EINVAL;
+	}
+
+	K_SPINLOCK(&data->lock) {
+		handler = data->handler[i];
+		trigger = data->trigger[i];
+	}
+
+	if (handler == NULL) {
+		return -ENOENT;
+	}
+
+	handler(dev, trigger);
+	return 0;
+}
+
+static const struct sensor_driver_api pvt_tt_bh_emul_driver_api = {
+	.trigger_set = pvt_tt_bh_emul_trigger_set,
+};
+
+#define DEFINE_PVT_TT_BH_EMUL(id)                                                                  \
+	static struct pvt_tt_bh_emul_data pvt_tt_bh_emul_data_##id;                                \
+	DEVICE_DT_INST_DEFINE(id, NULL, NULL, &pvt_tt_bh_emul_data_##id, NULL, POST_KERNEL,        \
+			      CONFIG_SENSOR_INIT_PRIORITY, &pvt_tt_bh_emul_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(DEFINE_PVT_TT_BH_EMUL)
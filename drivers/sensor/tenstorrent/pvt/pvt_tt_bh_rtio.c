@@ -119,8 +119,12 @@ typedef enum {
 	VM = 2,
 } PvtType;
 
-static uint32_t selected_pd_delay_chain = 0xFF; /* Invalid initial value */
+#define NO_DELAY_CHAIN 0xFF
+
+static uint32_t selected_pd_delay_chain = NO_DELAY_CHAIN;
 static uint32_t new_delay_chain = 1;
+/* Held by readers that need a delay chain for the whole of a read */
+static K_MUTEX_DEFINE(delay_chain_mutex);
 
 static void wait_sdif_ready(uint32_t status_reg_addr)
 {
@@ -150,6 +154,9 @@ static void select_delay_chain_and_start_pd_conv(uint32_t delay_chain)
 	if (delay_chain != selected_pd_delay_chain) {
 		pd_ip_cfg0_u ip_cfg0;
 
+		/* Keep the background scan from caching samples while the chain changes */
+		selected_pd_delay_chain = NO_DELAY_CHAIN;
+
 		ip_cfg0.val = 0;
 		ip_cfg0.f.run_mode = 0; /* MODE_PD_CNV */
 		ip_cfg0.f.oscillator_enable = ALL_AGING_OSC;
@@ -184,6 +191,23 @@ static uint32_t get_pvt_addr(PvtType type, uint32_t id, uint32_t base_addr)
 	return id * offset + base_addr;
 }
 
+static ReadStatus read_sdif_data(PvtType type, uint32_t id, uint16_t *data,
+				 uint32_t sdif_data_base_addr)
+{
+	pvt_cntl_ts_pd_sdif_data_reg_u ts_sdif_data;
+
+	ts_sdif_data.val = sys_read32(get_pvt_addr(type, id, sdif_data_base_addr));
+
+	if (ts_sdif_data.f.sample_fault) {
+		return SampleFault;
+	}
+	if (ts_sdif_data.f.sample_type != ValidData) {
+		return IncorrectSampleType;
+	}
+	*data = ts_sdif_data.f.sample_data;
+	return ReadOk;
+}
+
 static ReadStatus read_pvt_auto_mode(PvtType type, uint32_t id, uint16_t *data,
 				     uint32_t sdif_done_base_addr, uint32_t sdif_data_base_addr)
 {
@@ -204,48 +228,126 @@ static ReadStatus read_pvt_auto_mode(PvtType type, uint32_t id, uint16_t *data,
 		return SdifTimeout;
 	}
 
-	pvt_cntl_ts_pd_sdif_data_reg_u ts_sdif_data;
+	return read_sdif_data(type, id, data, sdif_data_base_addr);
+}
 
-	ts_sdif_data.val = sys_read32(get_pvt_addr(type, id, sdif_data_base_addr));
+#ifdef CONFIG_PVT_TT_BH_SCAN
+static bool cache_fresh(const struct pvt_tt_bh_sample *sample, uint32_t delay_chain)
+{
+	return sample->timestamp != 0 && sample->delay_chain == delay_chain &&
+	       k_uptime_ticks() - sample->timestamp <=
+		       k_ms_to_ticks_ceil64(CONFIG_PVT_TT_BH_SCAN_MAX_AGE_MS);
+}
 
-	if (ts_sdif_data.f.sample_fault) {
-		return SampleFault;
+static void cache_store(const struct device *dev, struct pvt_tt_bh_sample *sample,
+			uint32_t delay_chain, uint16_t raw)
+{
+	struct pvt_tt_bh_data *pvt_data = dev->data;
+
+	K_SPINLOCK(&pvt_data->lock) {
+		sample->timestamp = k_uptime_ticks();
+		sample->raw = raw;
+		sample->delay_chain = delay_chain;
 	}
-	if (ts_sdif_data.f.sample_type != ValidData) {
-		return IncorrectSampleType;
+}
+
+static bool cache_load(const struct device *dev, const struct pvt_tt_bh_sample *sample,
+		       uint32_t delay_chain, uint16_t *raw)
+{
+	struct pvt_tt_bh_data *pvt_data = dev->data;
+	bool fresh;
+
+	K_SPINLOCK(&pvt_data->lock) {
+		fresh = cache_fresh(sample, delay_chain);
+		if (fresh) {
+			*raw = sample->raw;
+		}
 	}
-	*data = ts_sdif_data.f.sample_data;
-	return ReadOk;
+
+	return fresh;
 }
 
+#define CACHE_STORE(dev, name, id, delay_chain, raw)                                               \
+	cache_store(dev, &((struct pvt_tt_bh_data *)(dev)->data)->name[id], delay_chain, raw)
+#define CACHE_LOAD(dev, name, id, delay_chain, raw)                                                \
+	cache_load(dev, &((struct pvt_tt_bh_data *)(dev)->data)->name[id], delay_chain, raw)
+#else
+#define CACHE_STORE(dev, name, id, delay_chain, raw)
+#define CACHE_LOAD(dev, name, id, delay_chain, raw) false
+#endif
+
 static ReadStatus read_ts(const struct device *dev, uint8_t chan, uint16_t *data)
 {
 	struct pvt_tt_bh_config *pvt_cfg = (struct pvt_tt_bh_config *)dev->config;
 
+	if (CACHE_LOAD(dev, ts, chan, 0, data)) {
+		return ReadOk;
+	}
+
 	ReadStatus status = read_pvt_auto_mode(TS, chan, data, PVT_CNTL_TS_00_SDIF_DONE_REG_ADDR,
 					       PVT_CNTL_TS_00_SDIF_DATA_REG_ADDR);
 
 	*data -= pvt_cfg->therm_cali_delta[chan];
+	if (status == ReadOk) {
+		CACHE_STORE(dev, ts, chan, 0, *data);
+	}
 	return status;
 }
 
-static ReadStatus read_ts_avg(const struct device *dev, uint16_t *sum)
+/*
+ * Read every temperature sensor once. Each calibrated reading is stored in
+ * per_sensor, when given, along with the hottest reading and the mean.
+ */
+static ReadStatus sweep_ts(const struct device *dev, struct pvt_tt_bh_rtio_data *per_sensor,
+			   uint16_t *max, uint16_t *mean)
 {
 	struct pvt_tt_bh_config *pvt_cfg = (struct pvt_tt_bh_config *)dev->config;
+	uint32_t sum = 0;
 
-	*sum = 0;
-	for (int i = 0; i < 8; i++) {
+	*max = 0;
+	for (uint8_t i = 0; i < pvt_cfg->num_ts; i++) {
 		uint16_t data;
+		ReadStatus status = read_ts(dev, i, &data);
 
-		read_pvt_auto_mode(TS, i, &data, PVT_CNTL_TS_00_SDIF_DONE_REG_ADDR,
-				   PVT_CNTL_TS_00_SDIF_DATA_REG_ADDR);
+		if (status != ReadOk) {
+			return status;
+		}
 
-		*sum += data - pvt_cfg->therm_cali_delta[i];
+		if (per_sensor != NULL) {
+			per_sensor[i].spec =
+				(struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS, i};
+			per_sensor[i].raw = data;
+		}
+		*max = MAX(*max, data);
+		sum += data;
 	}
-	*sum /= 8;
+	*mean = sum / pvt_cfg->num_ts;
 	return ReadOk;
 }
 
+static ReadStatus read_ts_avg(const struct device *dev, uint16_t *avg)
+{
+	uint16_t max;
+
+	return sweep_ts(dev, NULL, &max, avg);
+}
+
+static ReadStatus read_ts_max(const struct device *dev, uint16_t *max)
+{
+	uint16_t avg;
+
+	return sweep_ts(dev, NULL, max, &avg);
+}
+
+/* Fills PVT_TT_BH_TS_SWEEP_ENTRIES(num_ts) entries of data */
+static ReadStatus read_ts_sweep(const struct device *dev, struct pvt_tt_bh_rtio_data *data)
+{
+	data[0].spec = (struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS_MAX, 0};
+	data[1].spec = (struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS_AVG, 0};
+
+	return sweep_ts(dev, &data[2], &data[0].raw, &data[1].raw);
+}
+
 /* can not readback supply check in auto mode, use manual read instead */
 static ReadStatus read_vm(uint32_t id, uint16_t *data)
 {
@@ -268,23 +370,205 @@ static ReadStatus read_vm(uint32_t id, uint16_t *data)
 	return ReadOk;
 }
 
-static ReadStatus read_pd(uint32_t id, uint32_t delay_chain, uint16_t *data)
+static ReadStatus read_pd(const struct device *dev, uint32_t id, uint32_t delay_chain,
+			  uint16_t *data)
 {
+	if (CACHE_LOAD(dev, pd, id, delay_chain, data)) {
+		return ReadOk;
+	}
+
 	select_delay_chain_and_start_pd_conv(delay_chain);
 
-	return read_pvt_auto_mode(PD, id, data, PVT_CNTL_PD_00_SDIF_DONE_REG_ADDR,
-				  PVT_CNTL_PD_00_SDIF_DATA_REG_ADDR);
+	ReadStatus status = read_pvt_auto_mode(PD, id, data, PVT_CNTL_PD_00_SDIF_DONE_REG_ADDR,
+					       PVT_CNTL_PD_00_SDIF_DATA_REG_ADDR);
+
+	if (status == ReadOk) {
+		CACHE_STORE(dev, pd, id, delay_chain, *data);
+	}
+	return status;
 }
 
-static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
+#ifdef CONFIG_PVT_TT_BH_SCAN
+/*
+ * The controller raises its alarms as an interrupt, which is not wired up, so
+ * the scan compares the hottest cached sample against the same thresholds.
+ */
+static void check_alarms(const struct device *dev)
+{
+	struct pvt_tt_bh_data *pvt_data = dev->data;
+	const struct pvt_tt_bh_config *pvt_cfg = dev->config;
+	sensor_trigger_handler_t handler[ARRAY_SIZE(pvt_data->alarm)];
+	const struct sensor_trigger *trigger[ARRAY_SIZE(pvt_data->alarm)];
+	uint16_t hottest = 0;
+
+	K_SPINLOCK(&pvt_data->lock) {
+		for (uint8_t i = 0; i < pvt_cfg->num_ts; i++) {
+			if (cache_fresh(&pvt_data->ts[i], 0)) {
+				hottest = MAX(hottest, pvt_data->ts[i].raw);
+			}
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(pvt_data->alarm); i++) {
+			handler[i] = pvt_data->alarm[i].handler;
+			trigger[i] = pvt_data->alarm[i].trigger;
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(pvt_data->alarm); i++) {
+		struct pvt_tt_bh_alarm *alarm = &pvt_data->alarm[i];
+
+		if (!alarm->raised && hottest >= alarm->raise) {
+			alarm->raised = true;
+			if (handler[i] != NULL) {
+				handler[i](dev, trigger[i]);
+			}
+		} else if (alarm->raised && hottest < alarm->clear) {
+			alarm->raised = false;
+		}
+	}
+}
+
+static K_THREAD_STACK_DEFINE(scan_stack, CONFIG_PVT_TT_BH_SCAN_STACK_SIZE);
+static struct k_work_q scan_wq;
+
+/*
+ * TS and PD convert continuously once started. Collect whichever conversions
+ * have completed since the last scan, without waiting for any that have not.
+ * PD samples are only kept for the delay chain the last PD read selected.
+ * Called with reg_lock held.
+ */
+static void collect_conversions(const struct device *dev)
+{
+	const struct pvt_tt_bh_config *pvt_cfg = dev->config;
+	uint32_t delay_chain = selected_pd_delay_chain;
+	uint16_t data;
+
+	for (uint8_t i = 0; i < pvt_cfg->num_ts; i++) {
+		if (sys_read32(GET_TS_REG_ADDR(i, SDIF_DONE)) &&
+		    read_sdif_data(TS, i, &data, PVT_CNTL_TS_00_SDIF_DATA_REG_ADDR) == ReadOk) {
+			CACHE_STORE(dev, ts, i, 0, data - pvt_cfg->therm_cali_delta[i]);
+		}
+	}
+
+	for (uint8_t i = 0; i < pvt_cfg->num_pd && delay_chain != NO_DELAY_CHAIN; i++) {
+		if (sys_read32(GET_PD_REG_ADDR(i, SDIF_DONE)) &&
+		    read_sdif_data(PD, i, &data, PVT_CNTL_PD_00_SDIF_DATA_REG_ADDR) == ReadOk) {
+			CACHE_STORE(dev, pd, i, delay_chain, data);
+		}
+	}
+}
+
+/*
+ * Runs on its own low priority work queue. A read in progress owns the
+ * registers and fills the cache itself, so the scan skips the collection then.
+ */
+static void scan(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct pvt_tt_bh_data *pvt_data = CONTAINER_OF(dwork, struct pvt_tt_bh_data, scan_work);
+	const struct device *dev = pvt_data->dev;
+
+	if (k_mutex_lock(&pvt_data->reg_lock, K_NO_WAIT) == 0) {
+		collect_conversions(dev);
+		k_mutex_unlock(&pvt_data->reg_lock);
+	}
+
+	check_alarms(dev);
+
+	k_work_reschedule_for_queue(&scan_wq, dwork, K_USEC(CONFIG_PVT_TT_BH_SCAN_PERIOD_US));
+}
+
+/* Whether every channel of the read can be served from the cache */
+static bool cache_covers(const struct sensor_read_config *sensor_cfg)
+{
+	const struct pvt_tt_bh_config *pvt_cfg = sensor_cfg->sensor->config;
+	struct pvt_tt_bh_data *pvt_data = sensor_cfg->sensor->data;
+	bool covered = true;
+
+	K_SPINLOCK(&pvt_data->lock) {
+		for (size_t i = 0; i < sensor_cfg->count && covered; i++) {
+			const struct sensor_chan_spec *chan = &sensor_cfg->channels[i];
+
+			switch (chan->chan_type) {
+			case SENSOR_CHAN_PVT_TT_BH_PD:
+				covered = chan->chan_idx < pvt_cfg->num_pd &&
+					  cache_fresh(&pvt_data->pd[chan->chan_idx],
+						      new_delay_chain);
+				break;
+			case SENSOR_CHAN_PVT_TT_BH_VM:
+				/* VM is read without waiting anyway */
+				covered = chan->chan_idx < pvt_cfg->num_vm;
+				break;
+			case SENSOR_CHAN_PVT_TT_BH_TS:
+				covered = chan->chan_idx < pvt_cfg->num_ts &&
+					  cache_fresh(&pvt_data->ts[chan->chan_idx], 0);
+				break;
+			case SENSOR_CHAN_PVT_TT_BH_TS_AVG:
+			case SENSOR_CHAN_PVT_TT_BH_TS_MAX:
+			case SENSOR_CHAN_PVT_TT_BH_TS_SWEEP:
+				for (uint8_t j = 0; j < pvt_cfg->num_ts && covered; j++) {
+					covered = cache_fresh(&pvt_data->ts[j], 0);
+				}
+				break;
+			default:
+				covered = false;
+				break;
+			}
+		}
+	}
+
+	return covered;
+}
+
+void pvt_tt_bh_scan_start(const struct device *dev)
+{
+	struct pvt_tt_bh_data *pvt_data = dev->data;
+
+	const int alarm_temp[] = {PVT_TT_BH_ALARM_A_TEMP, PVT_TT_BH_ALARM_B_TEMP};
+
+	BUILD_ASSERT(ARRAY_SIZE(alarm_temp) == ARRAY_SIZE(pvt_data->alarm));
+
+	for (size_t i = 0; i < ARRAY_SIZE(pvt_data->alarm); i++) {
+		struct sensor_value raise = {.val1 = alarm_temp[i]};
+		struct sensor_value clear = {.val1 = alarm_temp[i] - PVT_TT_BH_ALARM_HYSTERESIS};
+
+		pvt_data->alarm[i].raise = pvt_tt_bh_temp_to_raw(&raise);
+		pvt_data->alarm[i].clear = pvt_tt_bh_temp_to_raw(&clear);
+	}
+
+	static const struct k_work_queue_config cfg = {.name = "pvt_scan"};
+
+	k_work_queue_init(&scan_wq);
+	k_work_queue_start(&scan_wq, scan_stack, K_THREAD_STACK_SIZEOF(scan_stack),
+			   CONFIG_PVT_TT_BH_SCAN_PRIORITY, &cfg);
+
+	pvt_data->dev = dev;
+	k_mutex_init(&pvt_data->reg_lock);
+	k_work_init_delayable(&pvt_data->scan_work, scan);
+	k_work_schedule_for_queue(&scan_wq, &pvt_data->scan_work, K_NO_WAIT);
+}
+#endif
+
+static void read_sample(struct rtio_iodev_sqe *iodev_sqe)
 {
 	const struct sensor_read_config *sensor_cfg =
 		(const struct sensor_read_config *)iodev_sqe->sqe.iodev->data;
-	uint32_t min_buffer_len = sizeof(struct pvt_tt_bh_rtio_data) * sensor_cfg->count;
+	const struct pvt_tt_bh_config *pvt_cfg =
+		(const struct pvt_tt_bh_config *)sensor_cfg->sensor->config;
+	uint32_t num_entries = 0;
+	uint32_t min_buffer_len;
 	uint8_t *buf;
 	uint32_t buf_len;
 	int ret;
 
+	/* A sweep fills an entry for each sensor and the summaries, every other channel one */
+	for (size_t i = 0; i < sensor_cfg->count; i++) {
+		num_entries += sensor_cfg->channels[i].chan_type == SENSOR_CHAN_PVT_TT_BH_TS_SWEEP
+				       ? PVT_TT_BH_TS_SWEEP_ENTRIES(pvt_cfg->num_ts)
+				       : 1;
+	}
+	min_buffer_len = sizeof(struct pvt_tt_bh_rtio_data) * num_entries;
+
 	/* Get RTIO output buffer. */
 	ret = rtio_sqe_rx_buf(iodev_sqe, min_buffer_len, min_buffer_len, &buf, &buf_len);
 	if (ret != 0) {
@@ -293,17 +577,13 @@ static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
 		return;
 	}
 
-	/* struct pvt_tt_bh_rtio_data *data = (struct pvt_tt_bh_rtio_data *)buf; */
 	struct pvt_tt_bh_rtio_data *data = (struct pvt_tt_bh_rtio_data *)buf;
 	ReadStatus status;
 
-	const struct pvt_tt_bh_config *pvt_cfg =
-		(const struct pvt_tt_bh_config *)sensor_cfg->sensor->config;
-
-	for (size_t i = 0; i < sensor_cfg->count; i++) {
+	for (size_t i = 0; i < sensor_cfg->count; i++, data++) {
 		const struct sensor_chan_spec *chan = &sensor_cfg->channels[i];
 
-		data[i].spec = *chan;
+		data->spec = *chan;
 
 		/* Validate channel index bounds and read data */
 		switch (chan->chan_type) {
@@ -314,7 +594,8 @@ static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
 				rtio_iodev_sqe_err(iodev_sqe, -EINVAL);
 				return;
 			}
-			status = read_pd(chan->chan_idx, new_delay_chain, &data[i].raw);
+			status = read_pd(sensor_cfg->sensor, chan->chan_idx, new_delay_chain,
+					 &data->raw);
 			break;
 		case SENSOR_CHAN_PVT_TT_BH_VM:
 			if (chan->chan_idx >= pvt_cfg->num_vm) {
@@ -323,7 +604,7 @@ static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
 				rtio_iodev_sqe_err(iodev_sqe, -EINVAL);
 				return;
 			}
-			status = read_vm(chan->chan_idx, &data[i].raw);
+			status = read_vm(chan->chan_idx, &data->raw);
 			break;
 		case SENSOR_CHAN_PVT_TT_BH_TS:
 			if (chan->chan_idx >= pvt_cfg->num_ts) {
@@ -332,11 +613,18 @@ static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
 				rtio_iodev_sqe_err(iodev_sqe, -EINVAL);
 				return;
 			}
-			status = read_ts(sensor_cfg->sensor, chan->chan_idx, &data[i].raw);
+			status = read_ts(sensor_cfg->sensor, chan->chan_idx, &data->raw);
 			break;
 		case SENSOR_CHAN_PVT_TT_BH_TS_AVG:
 			/* Channel index is ignored as this is the average for all TS channels. */
-			status = read_ts_avg(sensor_cfg->sensor, &data[i].raw);
+			status = read_ts_avg(sensor_cfg->sensor, &data->raw);
+			break;
+		case SENSOR_CHAN_PVT_TT_BH_TS_MAX:
+			status = read_ts_max(sensor_cfg->sensor, &data->raw);
+			break;
+		case SENSOR_CHAN_PVT_TT_BH_TS_SWEEP:
+			status = read_ts_sweep(sensor_cfg->sensor, data);
+			data += PVT_TT_BH_TS_SWEEP_ENTRIES(pvt_cfg->num_ts) - 1;
 			break;
 		default:
 			LOG_ERR("Unsupported channel type: %d", chan->chan_type);
@@ -354,6 +642,28 @@ static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
 	rtio_iodev_sqe_ok(iodev_sqe, 0);
 }
 
+static struct pvt_tt_bh_data *sqe_data(struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct sensor_read_config *sensor_cfg =
+		(const struct sensor_read_config *)iodev_sqe->sqe.iodev->data;
+
+	return sensor_cfg->sensor->data;
+}
+
+/* Runs on the RTIO work queue, and may wait for conversions */
+static void pvt_tt_bh_submit_sample(struct rtio_iodev_sqe *iodev_sqe)
+{
+#ifdef CONFIG_PVT_TT_BH_SCAN
+	struct pvt_tt_bh_data *pvt_data = sqe_data(iodev_sqe);
+
+	k_mutex_lock(&pvt_data->reg_lock, K_FOREVER);
+	read_sample(iodev_sqe);
+	k_mutex_unlock(&pvt_data->reg_lock);
+#else
+	read_sample(iodev_sqe);
+#endif
+}
+
 void pvt_tt_bh_submit(const struct device *sensor, struct rtio_iodev_sqe *sqe)
 {
 	const struct rtio_sqe *event = &sqe->sqe;
@@ -370,12 +680,68 @@ void pvt_tt_bh_submit(const struct device *sensor, struct rtio_iodev_sqe *sqe)
 		return;
 	}
 
+#ifdef CONFIG_PVT_TT_BH_SCAN
+	struct pvt_tt_bh_data *pvt_data = sqe_data(sqe);
+
+	/* Complete reads the background scan has collected at once. A sample that ages out
+	 * meanwhile is read from the registers, so the caller still can't race the scan.
+	 */
+	if (cache_covers((const struct sensor_read_config *)event->iodev->data) &&
+	    k_mutex_lock(&pvt_data->reg_lock, K_NO_WAIT) == 0) {
+		read_sample(sqe);
+		k_mutex_unlock(&pvt_data->reg_lock);
+		return;
+	}
+#endif
+
 	struct rtio_work_req *req = rtio_work_req_alloc();
 
 	rtio_work_req_submit(req, sqe, pvt_tt_bh_submit_sample);
 }
 
+int pvt_tt_bh_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+			  sensor_trigger_handler_t handler)
+{
+#ifdef CONFIG_PVT_TT_BH_SCAN
+	struct pvt_tt_bh_data *pvt_data = dev->data;
+	uint32_t alarm = (int)trig->type - SENSOR_TRIG_PVT_TT_BH_ALARM_A;
+
+	if (alarm >= ARRAY_SIZE(pvt_data->alarm) ||
+	    (int)trig->chan != SENSOR_CHAN_PVT_TT_BH_TS_MAX) {
+		return -ENOTSUP;
+	}
+
+	K_SPINLOCK(&pvt_data->lock) {
+		pvt_data->alarm[alarm].handler = handler;
+		pvt_data->alarm[alarm].trigger = trig;
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 void pvt_tt_bh_delay_chain_set(uint32_t new_delay_chain_)
 {
+	k_mutex_lock(&delay_chain_mutex, K_FOREVER);
 	new_delay_chain = new_delay_chain_;
+	k_mutex_unlock(&delay_chain_mutex);
+}
+
+uint32_t pvt_tt_bh_delay_chain_lock(uint32_t delay_chain)
+{
+	uint32_t prev;
+
+	k_mutex_lock(&delay_chain_mutex, K_FOREVER);
+	prev = new_delay_chain;
+	new_delay_chain = delay_chain;
+
+	return prev;
+}
+
+void pvt_tt_bh_delay_chain_unlock(uint32_t delay_chain)
+{
+	new_delay_chain = delay_chain;
+	k_mutex_unlock(&delay_chain_mutex);
 }
@@ -215,6 +215,113 @@ struct get_voltage_curve_from_freq_rqst {
 	uint32_t input_freq_mhz;
 };
 
+/** @brief Host request to read the active VF curve
+ * @details Requests of this type are processed by @ref get_vf_curve_handler. The response
+ * holds the curve source (0 for the built in quadratic, 1 for the fw_table, 2 for a runtime
+ * curve) in bits 0-7 of data[1] and the number of points in bits 8-15, the signed frequency
+ * and voltage margins in MHz and mV in data[2] and data[3], and up to four points from
+ * @ref first_point in data[4] to data[7], each with the frequency in MHz in bits 0-15 and the
+ * voltage in mV in bits 16-31.
+ */
+struct get_vf_curve_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_GET_VF_CURVE */
+	uint8_t command_code;
+
+	/** @brief Index of the first point to return */
+	uint8_t first_point;
+};
+
+/** @brief Host request to control the adaptive voltage margin
+ * @details Requests of this type are processed by @ref adaptive_margin_handler. Operation 0
+ * reads the status, 1 enables adaptation and clears a fallback, 2 disables adaptation and
+ * restores the static margin, and 3 reads history entry @ref index. Operations 0 to 2 respond
+ * with the state in bits 0-7 of data[1], the trim in mV in bits 8-15 and the aging slowdown in
+ * permille in bits 16-31, the slack and reference slack in permille in data[2] and data[3], the
+ * number of history entries in data[4] and the number of starts in data[5]. Operation 3
+ * responds with the entry's uptime in seconds in data[1], and its event, trim and slack in
+ * permille in bits 0-7, 8-15 and 16-31 of data[2].
+ */
+struct adaptive_margin_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_ADAPTIVE_MARGIN */
+	uint8_t command_code;
+
+	/** @brief The operation to perform */
+	uint8_t op;
+
+	/** @brief Two bytes of padding */
+	uint8_t pad[2];
+
+	/** @brief History entry to read, counted from the first entry ever recorded */
+	uint32_t index;
+};
+
+/** @brief Host request for AICLK limiter statistics
+ * @details Requests of this type are processed by @ref aiclk_limiters_handler. The response
+ * holds the limiter that set AICLK in the latest DVFS update in bits 0-7 of data[1] and the
+ * number of limiters in bits 8-15. For @ref limiter it holds the number of updates in which it
+ * set AICLK in data[2], the sum over those updates of the highest min arbiter request minus
+ * AICLK in MHz in data[3] (low word) and data[4] (high word), and the uptime in ms of the
+ * latest of them in data[5] (low word) and data[6] (high word). Only max arbiters remove
+ * frequency, so the sum is 0 for the other limiters.
+ */
+struct aiclk_limiters_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_AICLK_LIMITERS */
+	uint8_t command_code;
+
+	/** @brief The limiter to report on */
+	uint8_t limiter;
+
+	/** @brief Set to 1 to clear all statistics after reading */
+	uint8_t reset: 1;
+};
+
+/** @brief Host request to read or control the DVFS flight recorder
+ * @details Requests of this type are processed by @ref dvfs_recorder_handler. Operation 0
+ * reads the status, 1 copies @ref num_records ticks starting at tick @ref first into the bulk
+ * mailbox at @ref offset, 2 freezes the recorder and 3 discards the recording and rearms it.
+ * Operations 0, 2 and 3 respond with the state in bits 0-7 of data[1], the trigger in bits
+ * 8-15 and the size of a tick in bytes in bits 16-31, the number of ticks recorded since the
+ * recorder was armed in data[2], the tick at which it was triggered in data[3] and the number
+ * of ticks it keeps in data[4]. Operation 1 responds with the CRC-32 of the copied ticks in
+ * data[1].
+ */
+struct dvfs_recorder_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_DVFS_RECORDER */
+	uint8_t command_code;
+
+	/** @brief The operation to perform */
+	uint8_t op;
+
+	/** @brief Number of ticks to read */
+	uint16_t num_records;
+
+	/** @brief First tick to read, counted from the first tick since the recorder was armed */
+	uint32_t first;
+
+	/** @brief Offset into the bulk mailbox to copy the ticks to */
+	uint32_t offset;
+};
+
+/** @brief Host request to set or read the scheduling of a message queue
+ * @details Messages of this type are processed by @ref msgqueue_sched_handler.
+ *
+ * The response returns the priority of the queue in data[1] and its budget in data[2], after
+ * any update.
+ */
+struct msgqueue_sched_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_MSGQUEUE_SCHED */
+	uint8_t command_code;
+
+	/** @brief The message queue to configure */
+	uint8_t msgqueue_id;
+
+	/** @brief The new priority, 0 being the most urgent */
+	uint8_t priority;
+
+	/** @brief The new budget in messages per pass, or 0 to only read the settings */
+	uint8_t budget;
+};
+
 /** @brief Host request for debug NOC translation
  * @details Messages of this type are processed by @ref debug_noc_translation_handler
  */
@@ -343,6 +450,137 @@ struct asic_state_rqst {
 	uint8_t command_code;
 };
 
+/** @brief Host request for message queue statistics
+ * @details Messages of this type are processed by @ref get_msg_stats_handler.
+ * Page 0 returns count, min/max/mean service time (ns), max/mean queueing delay (ns) and the
+ * number of untracked messages. Pages 1-3 return the log2(us) service time histogram and pages
+ * 4-6 the queueing delay histogram, seven buckets per page. Page 7 returns wakeups, timer
+ * wakeups, doorbells, messages, max messages per wakeup and response pointer updates across all
+ * message codes. Page 8 returns the log2 histogram of messages per wakeup.
+ */
+struct msg_stats_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_GET_MSG_STATS */
+	uint8_t command_code;
+
+	/** @brief The message code to report on */
+	uint8_t msg_code;
+
+	/** @brief The page of statistics to return */
+	uint8_t page;
+
+	/** @brief Set to 1 to clear all statistics after reading */
+	uint8_t reset: 1;
+};
+
+/** @brief Bulk mailbox operations */
+enum bulk_mailbox_op {
+	/** @brief Return the mailbox address in data[1] and its size in data[2] */
+	BULK_MAILBOX_OP_INFO = 0,
+	/** @brief Return the CRC-32 of a mailbox region in data[1] */
+	BULK_MAILBOX_OP_CHECKSUM = 1,
+};
+
+/** @brief Host request for bulk mailbox operations
+ * @details Messages of this type are processed by @ref bulk_mailbox_handler.
+ *
+ * Messages that opt into bulk payloads describe them with an offset and length into the
+ * mailbox and a CRC-32 (IEEE) of the payload, see @ref bulk_mailbox_rqst::xfer.
+ */
+struct bulk_mailbox_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_BULK_MAILBOX */
+	uint8_t command_code;
+
+	/** @brief The @ref bulk_mailbox_op to perform */
+	uint8_t op;
+
+	/** @brief Two bytes of padding */
+	uint8_t pad[2];
+
+	/** @brief The mailbox region, for @ref BULK_MAILBOX_OP_CHECKSUM */
+	struct {
+		/** @brief Byte offset of the payload from the start of the mailbox */
+		uint32_t offset;
+
+		/** @brief Payload length in bytes */
+		uint32_t length;
+	} xfer;
+};
+
+/** @brief Host request to set or read the telemetry tier update periods
+ * @details Messages of this type are processed by @ref telemetry_periods_handler.
+ *
+ * The response returns the fast, medium and slow tier periods in milliseconds in data[1],
+ * data[2] and data[3].
+ */
+struct telemetry_periods_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_TELEMETRY_PERIODS */
+	uint8_t command_code;
+
+	/** @brief The tier to update: 0 for fast, 1 for medium and 2 for slow */
+	uint8_t tier;
+
+	/** @brief Two bytes of padding */
+	uint8_t pad[2];
+
+	/** @brief The new period of the tier in milliseconds, or 0 to only read the periods */
+	uint32_t period_ms;
+};
+
+/** @brief Telemetry watch operations */
+enum telemetry_watch_op {
+	/** @brief Arm watch @ref telemetry_watch_rqst::watch_id */
+	TELEMETRY_WATCH_OP_SET = 0,
+	/** @brief Disarm watch @ref telemetry_watch_rqst::watch_id */
+	TELEMETRY_WATCH_OP_CLEAR = 1,
+	/** @brief Send an MSI with @ref telemetry_watch_rqst::vector_id when events are queued */
+	TELEMETRY_WATCH_OP_SET_MSI = 2,
+	/** @brief Stop sending MSIs for telemetry events */
+	TELEMETRY_WATCH_OP_CLEAR_MSI = 3,
+};
+
+/** @brief Trigger when the value falls below the threshold rather than rises above it */
+#define TELEMETRY_WATCH_FLAG_FALLING 0x1
+/** @brief Compare the tag value and threshold as signed integers */
+#define TELEMETRY_WATCH_FLAG_SIGNED  0x2
+
+/** @brief Host request to manage telemetry threshold watches
+ * @details Messages of this type are processed by @ref telemetry_watch_handler.
+ *
+ * An armed watch queues an event when its tag crosses the threshold, and another when the tag
+ * returns past the threshold by at least the hysteresis.
+ */
+struct telemetry_watch_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_TELEMETRY_WATCH */
+	uint8_t command_code;
+
+	/** @brief The @ref telemetry_watch_op to perform */
+	uint8_t op;
+
+	/** @brief The watch to set or clear */
+	uint8_t watch_id;
+
+	/** @brief TELEMETRY_WATCH_FLAG_* bits for @ref TELEMETRY_WATCH_OP_SET */
+	uint8_t flags;
+
+	/** @brief The telemetry tag to watch */
+	uint16_t tag;
+
+	/** @brief The PCIE instance 0 or 1, for @ref TELEMETRY_WATCH_OP_SET_MSI */
+	uint8_t pcie_inst;
+
+	/** @brief One byte of padding */
+	uint8_t pad;
+
+	/** @brief The threshold, in the units of the tag */
+	uint32_t threshold;
+
+	/** @brief How far the tag must return past the threshold before the watch re-arms */
+	uint32_t hysteresis;
+
+	/** @brief MSI vector ID, for @ref TELEMETRY_WATCH_OP_SET_MSI */
+	uint32_t vector_id;
+};
+
 /** @brief A tenstorrent host request*/
 union request {
 	/** @brief The interpretation of the request as an array of uint32_t entries*/
@@ -400,6 +638,33 @@ union request {
 
 	/** @brief An ASIC state transition request */
 	struct asic_state_rqst asic_state;
+
+	/** @brief A message queue statistics request */
+	struct msg_stats_rqst msg_stats;
+
+	/** @brief A bulk mailbox request */
+	struct bulk_mailbox_rqst bulk_mailbox;
+
+	/** @brief A telemetry tier period request */
+	struct telemetry_periods_rqst telemetry_periods;
+
+	/** @brief A telemetry watch request */
+	struct telemetry_watch_rqst telemetry_watch;
+
+	/** @brief A VF curve read request */
+	struct get_vf_curve_rqst get_vf_curve;
+
+	/** @brief An adaptive voltage margin request */
+	struct adaptive_margin_rqst adaptive_margin;
+
+	/** @brief An AICLK limiter statistics request */
+	struct aiclk_limiters_rqst aiclk_limiters;
+
+	/** @brief A DVFS flight recorder request */
+	struct dvfs_recorder_rqst dvfs_recorder;
+
+	/** @brief A message queue scheduling request */
+	struct msgqueue_sched_rqst msgqueue_sched;
 };
 
 /** @} */
@@ -416,11 +681,24 @@ struct msgqueue_handler {
 };
 
 #define REGISTER_MESSAGE(msg, func)                                                                \
+	BUILD_ASSERT((msg) < CONFIG_TT_BH_ARC_NUM_MSG_CODES, "message code out of range");         \
 	const STRUCT_SECTION_ITERABLE(msgqueue_handler, registration_for_##msg) = {                \
 		.msg_type = msg,                                                                   \
 		.handler = func,                                                                   \
 	}
 
+/** @brief Identifies a response slot whose handler completes asynchronously
+ * @details Obtained from @ref msgqueue_defer_response and passed to
+ * @ref msgqueue_complete_deferred once the work is done.
+ */
+struct msgqueue_deferred_response {
+	/** @brief The message queue the request arrived on */
+	uint32_t msgqueue_id;
+
+	/** @brief The reserved response slot, as a double-wrapped queue pointer */
+	uint32_t response_ptr;
+};
+
 void process_message_queues(void);
 void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t handler);
 
@@ -430,6 +708,62 @@ int msgqueue_response_push(uint32_t msgqueue_id, const struct response *response
 int msgqueue_response_pop(uint32_t msgqueue_id, struct response *response);
 void init_msgqueue(void);
 
+/**
+ * @brief Defer the response of the message currently being handled
+ *
+ * Must be called from within a message handler. The request slot is released as usual, but the
+ * response slot stays reserved and is not visible to the host until
+ * @ref msgqueue_complete_deferred is called with @p token. Later responses on the same queue are
+ * held back until then so the host still sees responses in request order. The handler's return
+ * value and response contents are discarded.
+ *
+ * @param[out] token Identifies the reserved response slot
+ * @return 0 on success, -1 if not called from a handler or the response is already deferred
+ */
+int msgqueue_defer_response(struct msgqueue_deferred_response *token);
+
+/**
+ * @brief Post the response of a previously deferred message
+ *
+ * May be called from any thread once the deferred work has finished.
+ *
+ * @param token The token returned by @ref msgqueue_defer_response
+ * @param response The response to return to the host
+ * @param exit_code Status ORed into the first response word, as for a handler return value
+ * @return 0 on success, -1 if @p token does not name an outstanding deferred response
+ */
+int msgqueue_complete_deferred(const struct msgqueue_deferred_response *token,
+			       const struct response *response, uint8_t exit_code);
+
+/**
+ * @brief Set the scheduling priority of a message queue
+ *
+ * Queues with lower priority values are serviced first. Queues with equal priority share
+ * service round-robin, each running up to its budget of messages per pass.
+ *
+ * @param msgqueue_id The message queue to configure
+ * @param priority The new priority, 0 being the most urgent
+ * @return 0 on success, -1 if @p msgqueue_id is invalid
+ */
+int msgqueue_set_priority(uint32_t msgqueue_id, uint8_t priority);
+
+/**
+ * @brief Get the scheduling priority of a message queue
+ *
+ * @param msgqueue_id The message queue to query
+ * @return The queue priority, or -1 if @p msgqueue_id is invalid
+ */
+int msgqueue_get_priority(uint32_t msgqueue_id);
+
+/**
+ * @brief Set the number of messages a queue may run before higher priority queues are rechecked
+ *
+ * @param msgqueue_id The message queue to configure
+ * @param budget Messages per pass, must be at least 1
+ * @return 0 on success, -1 if @p msgqueue_id or @p budget is invalid
+ */
+int msgqueue_set_budget(uint32_t msgqueue_id, uint8_t budget);
+
 #ifdef __cplusplus
 }
 #endif
@@ -134,6 +134,24 @@ enum tt_smc_msg {
 	TT_SMC_MSG_CONFIRM_FLASHED_SPI = 0xC4,
 	/** @brief Toggle red blinky on the board */
 	TT_SMC_MSG_BLINKY = 0xC5,
+	/** @brief Read per message code service time and queueing delay statistics */
+	TT_SMC_MSG_GET_MSG_STATS = 0xC6,
+	/** @brief Query the bulk mailbox location or checksum a region of it */
+	TT_SMC_MSG_BULK_MAILBOX = 0xC7,
+	/** @brief Set or read the telemetry tier update periods */
+	TT_SMC_MSG_TELEMETRY_PERIODS = 0xC8,
+	/** @brief Set or clear a telemetry threshold watch, or route telemetry events to an MSI */
+	TT_SMC_MSG_TELEMETRY_WATCH = 0xC9,
+	/** @brief Read the active VF curve and its margins */
+	TT_SMC_MSG_GET_VF_CURVE = 0xCA,
+	/** @brief Read, enable or disable the adaptive voltage margin, or read its history */
+	TT_SMC_MSG_ADAPTIVE_MARGIN = 0xCB,
+	/** @brief Read which arbiters limited AICLK, and for how long */
+	TT_SMC_MSG_AICLK_LIMITERS = 0xCC,
+	/** @brief Read, freeze or rearm the DVFS flight recorder */
+	TT_SMC_MSG_DVFS_RECORDER = 0xCD,
+	/** @brief Set or read the scheduling priority and budget of a message queue */
+	TT_SMC_MSG_MSGQUEUE_SCHED = 0xCE,
 };
 
 /** @} */
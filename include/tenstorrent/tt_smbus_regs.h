@@ -48,6 +48,10 @@ enum CMFWSMBusReg {
 
 	/* RO, 2 bytes. Read data to verify the SMC got this ping request */
 	CMFW_SMBUS_PING_V2 = 0x2A,
+	/* RW, 3 to 10 bytes in, up to 252 bytes out. Select a range or bitmap of telemetry tags
+	 * and read all of their values from the same update. See `CMFWSMBusTelemBlockMode`.
+	 */
+	CMFW_SMBUS_TELEMETRY_BLOCK_READ = 0x2B,
 	/* RO, 8 bits. Issue a test read from CMFW scratch register */
 	CMFW_SMBUS_TEST_READ = 0xD8,
 	/* WO, 8 bits. Write to CMFW scratch register */
@@ -65,6 +69,16 @@ enum CMFWSMBusReg {
 	CMFW_SMBUS_MSG_MAX,
 };
 
+/* Selection modes for CMFW_SMBUS_TELEMETRY_BLOCK_READ. The block written is the mode byte,
+ * then the first tag, then either a tag count (range) or up to 8 bitmap bytes where bit n of
+ * byte m selects tag first + 8 * m + n (bitmap). The block read back is the 32 bit little
+ * endian value of each selected tag, in tag order.
+ */
+enum CMFWSMBusTelemBlockMode {
+	CMFW_SMBUS_TELEM_BLOCK_RANGE = 0,
+	CMFW_SMBUS_TELEM_BLOCK_BITMAP = 1,
+};
+
 /* Request IDs that the CMFW can issue within the */
 
 #endif /* TT_SMBUS_MSGS_H_ */
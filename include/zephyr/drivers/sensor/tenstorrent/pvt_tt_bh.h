@@ -8,6 +8,7 @@
 #define PVT_TT_BH_H
 
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
 
 enum pvt_tt_bh_attribute {
 	SENSOR_ATTR_PVT_TT_BH_NUM_PD = SENSOR_ATTR_PRIV_START,
@@ -24,8 +25,35 @@ enum pvt_tt_bh_channel {
 	SENSOR_CHAN_PVT_TT_BH_VM,
 	SENSOR_CHAN_PVT_TT_BH_TS,
 	SENSOR_CHAN_PVT_TT_BH_TS_AVG,
+	/* Hottest temperature sensor. The channel index is ignored. */
+	SENSOR_CHAN_PVT_TT_BH_TS_MAX,
+	/*
+	 * One sweep through every temperature sensor. Reading it fills
+	 * PVT_TT_BH_TS_SWEEP_ENTRIES(num_ts) entries: TS_MAX, TS_AVG and each
+	 * TS channel, all from the same sweep, which decode as those channels.
+	 */
+	SENSOR_CHAN_PVT_TT_BH_TS_SWEEP,
 };
 
+#define PVT_TT_BH_TS_SWEEP_ENTRIES(num_ts) ((num_ts) + 2)
+
+/*
+ * Raised when the hottest temperature sensor reaches the alarm temperature,
+ * on SENSOR_CHAN_PVT_TT_BH_TS_MAX. An alarm is raised again only after the
+ * hottest sensor has cooled PVT_TT_BH_ALARM_HYSTERESIS below it. Requires
+ * CONFIG_PVT_TT_BH_SCAN, which checks the alarms on every scan.
+ */
+enum pvt_tt_bh_trigger {
+	SENSOR_TRIG_PVT_TT_BH_ALARM_A = SENSOR_TRIG_PRIV_START,
+	SENSOR_TRIG_PVT_TT_BH_ALARM_B,
+};
+
+/* Alarm temperatures in degrees C */
+#define PVT_TT_BH_ALARM_A_TEMP     83
+/* BH prod spec 7.3 gives Tj,shutdown=110C, tmons are +-1C calibrated */
+#define PVT_TT_BH_ALARM_B_TEMP     109
+#define PVT_TT_BH_ALARM_HYSTERESIS 5
+
 typedef enum {
 	ReadOk = 0,
 	SampleFault = 1,
@@ -65,7 +93,33 @@ struct pvt_tt_bh_config {
 	int16_t *therm_cali_delta;
 };
 
+/* Latest conversion of one sensor, kept when CONFIG_PVT_TT_BH_SCAN is enabled */
+struct pvt_tt_bh_sample {
+	int64_t timestamp;   /* k_uptime_ticks() when it was read, 0 if never */
+	uint16_t raw;        /* calibrated, for temperature sensors */
+	uint8_t delay_chain; /* process detectors only */
+};
+
+struct pvt_tt_bh_alarm {
+	uint16_t raise; /* calibrated TS raw data the alarm is raised at */
+	uint16_t clear; /* and the data it clears below */
+	bool raised;
+	sensor_trigger_handler_t handler;
+	const struct sensor_trigger *trigger;
+};
+
 struct pvt_tt_bh_data {
+#ifdef CONFIG_PVT_TT_BH_SCAN
+	const struct device *dev;
+	struct k_work_delayable scan_work;
+	/* Serializes register access between the scan and reads */
+	struct k_mutex reg_lock;
+	/* The cache is filled by the scan and by reads, and read from any thread */
+	struct k_spinlock lock;
+	struct pvt_tt_bh_sample *ts;
+	struct pvt_tt_bh_sample *pd;
+	struct pvt_tt_bh_alarm alarm[2]; /* SENSOR_TRIG_PVT_TT_BH_ALARM_A, _B */
+#endif
 };
 
 /*
@@ -116,6 +170,27 @@ int pvt_tt_bh_get_decoder(const struct device *dev, const struct sensor_decoder_
 
 void pvt_tt_bh_submit(const struct device *sensor, struct rtio_iodev_sqe *sqe);
 
+int pvt_tt_bh_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+			  sensor_trigger_handler_t handler);
+
 void pvt_tt_bh_delay_chain_set(uint32_t new_delay_chain_);
 
+/*
+ * Select the delay chain for process detector reads until
+ * pvt_tt_bh_delay_chain_unlock(), which other threads wait for before
+ * changing it. Returns the delay chain that was selected before.
+ */
+uint32_t pvt_tt_bh_delay_chain_lock(uint32_t delay_chain);
+
+/*
+ * Leave delay_chain selected and let other threads change it again.
+ */
+void pvt_tt_bh_delay_chain_unlock(uint32_t delay_chain);
+
+/*
+ * Start collecting completed conversions into the cache, see
+ * CONFIG_PVT_TT_BH_SCAN.
+ */
+void pvt_tt_bh_scan_start(const struct device *dev);
+
 #endif /* PVT_TT_BH_H */
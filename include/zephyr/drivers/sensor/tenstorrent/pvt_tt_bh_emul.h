@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PVT_TT_BH_EMUL_H
+#define PVT_TT_BH_EMUL_H
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
+
+/*
+ * Call the handler set for alarm, as the PVT scan does when the hottest
+ * temperature sensor reaches the alarm temperature. Returns -ENOENT if no
+ * handler is set.
+ */
+int pvt_tt_bh_emul_raise_alarm(const struct device *dev, enum pvt_tt_bh_trigger alarm);
+
+#endif
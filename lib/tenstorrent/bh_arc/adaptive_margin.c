@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <float.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "adaptive_margin.h"
+#include "aiclk_ppm.h"
+#include "vf_curve.h"
+#include "voltage.h"
+
+/* Slack samples at the static margin before the first trim */
+#define LEARN_SAMPLES    16
+/* Periods to wait after a trim was backed off before trimming again */
+#define HOLD_PERIODS     10
+/* Read the aging delay chain once every this many periods */
+#define AGING_PERIODS    60
+/* Aging is only compared between readings at the same VCORE */
+#define AGING_VOLTAGE_MV 2
+#define HISTORY_ENTRIES  16
+/* Consecutive failed sensor reads before falling back */
+#define FAULT_PERIODS    3
+/* Slack references are learned per AICLK band of this width */
+#define OP_POINT_MHZ     50
+#define OP_POINTS        (((uint32_t)AICLK_FMAX_MAX - (uint32_t)AICLK_FMIN_MIN) / OP_POINT_MHZ + 1)
+
+#define GUARDBAND   (CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_GUARDBAND / 1000.0F)
+#define STEP_MV     CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV
+#define MAX_TRIM_MV CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_MAX_TRIM_MV
+
+/* Kept in retained RAM, so the history, the aging reference and a fallback survive a reset */
+struct adaptive_margin_record {
+	uint32_t starts;
+	uint32_t history_count;
+	uint8_t fallback; /* enum adaptive_margin_event that caused a fallback, 0 if none */
+	uint8_t pad[3];
+	uint32_t aging_ref_mv;
+	float aging_ref_mhz;
+	struct adaptive_margin_history_entry history[HISTORY_ENTRIES];
+};
+
+static struct adaptive_margin_record record;
+
+/* Slack reference at one operating point, learned at the static margin */
+struct slack_ref {
+	float slack;
+	uint32_t learn_count;
+};
+
+static enum adaptive_margin_state state = ADAPTIVE_MARGIN_DISABLED;
+static uint8_t trim_mv;
+static float static_freq_margin;
+static float static_voltage_margin;
+static float slack;
+static struct slack_ref slack_refs[OP_POINTS];
+static struct slack_ref *last_ref;
+static uint32_t hold_count;
+static uint32_t fault_count;
+static uint16_t aging_permille;
+
+#if DT_NODE_EXISTS(DT_NODELABEL(adaptive_margin_retention)) && defined(CONFIG_RETENTION)
+#include <zephyr/retention/retention.h>
+
+static const struct device *const retention_dev =
+	DEVICE_DT_GET(DT_NODELABEL(adaptive_margin_retention));
+
+/* The retention area also holds its prefix and checksum */
+BUILD_ASSERT(sizeof(struct adaptive_margin_record) + 8 <=
+	     DT_REG_SIZE(DT_NODELABEL(adaptive_margin_retention)));
+
+static void load_record(void)
+{
+	if (device_is_ready(retention_dev) && retention_is_valid(retention_dev) == 1) {
+		retention_read(retention_dev, 0, (uint8_t *)&record, sizeof(record));
+	}
+}
+
+static void save_record(void)
+{
+	if (device_is_ready(retention_dev)) {
+		retention_write(retention_dev, 0, (const uint8_t *)&record, sizeof(record));
+	}
+}
+#else
+static void load_record(void)
+{
+}
+
+static void save_record(void)
+{
+}
+#endif
+
+static uint32_t to_permille(float value)
+{
+	return (uint32_t)CLAMP(value * 1000.0F, 0.0F, (float)UINT32_MAX);
+}
+
+static void add_history(enum adaptive_margin_event event)
+{
+	struct adaptive_margin_history_entry *entry =
+		&record.history[record.history_count % HISTORY_ENTRIES];
+
+	entry->uptime_s = k_uptime_get() / MSEC_PER_SEC;
+	entry->event = event;
+	entry->trim_mv = trim_mv;
+	entry->slack_permille = MIN(to_permille(slack), UINT16_MAX);
+	record.history_count++;
+	save_record();
+}
+
+static void apply_trim(uint8_t new_trim_mv)
+{
+	trim_mv = new_trim_mv;
+	/* Publishes new VF tables, which the next DVFS tick picks up along with the AICLK limit
+	 * at vdd_max that follows from them
+	 */
+	SetVFCurveMargins(static_freq_margin, static_voltage_margin - trim_mv);
+}
+
+static void set_trim(uint8_t new_trim_mv, enum adaptive_margin_event event)
+{
+	if (new_trim_mv != trim_mv) {
+		apply_trim(new_trim_mv);
+		add_history(event);
+	}
+}
+
+static void fall_back(enum adaptive_margin_event reason)
+{
+	state = ADAPTIVE_MARGIN_FALLBACK;
+	record.fallback = reason;
+	apply_trim(0);
+	add_history(reason);
+}
+
+static void start(enum adaptive_margin_event event)
+{
+	state = ADAPTIVE_MARGIN_LEARNING;
+	record.fallback = 0;
+	memset(slack_refs, 0, sizeof(slack_refs));
+	last_ref = NULL;
+	hold_count = 0;
+	fault_count = 0;
+	add_history(event);
+}
+
+static void stop(void)
+{
+	state = ADAPTIVE_MARGIN_DISABLED;
+	apply_trim(0);
+	add_history(ADAPTIVE_MARGIN_EVENT_DISABLED);
+}
+
+static bool aging_ok(const struct adaptive_margin_sample *sample)
+{
+	if (sample->aging_pd_mhz <= 0.0F) {
+		return true;
+	}
+
+	if (record.aging_ref_mhz <= 0.0F) {
+		record.aging_ref_mhz = sample->aging_pd_mhz;
+		record.aging_ref_mv = sample->vcore_mv;
+		save_record();
+		return true;
+	}
+
+	/* Delay chain speed depends on voltage, so only compare like with like */
+	if (abs((int32_t)sample->vcore_mv - (int32_t)record.aging_ref_mv) > AGING_VOLTAGE_MV) {
+		return true;
+	}
+
+	aging_permille =
+		to_permille(MAX(1.0F - sample->aging_pd_mhz / record.aging_ref_mhz, 0.0F));
+
+	return aging_permille <= CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_AGING_LIMIT;
+}
+
+static uint32_t op_point(uint32_t aiclk_mhz)
+{
+	uint32_t band = (uint32_t)MAX(aiclk_mhz - AICLK_FMIN_MIN, 0.0F) / OP_POINT_MHZ;
+
+	return MIN(band, OP_POINTS - 1);
+}
+
+/**
+ * @brief Run one step of the adaptive margin control loop
+ *
+ * @param sample Sensor readings and the operating point they were taken at
+ */
+void AdaptiveMarginUpdate(const struct adaptive_margin_sample *sample)
+{
+	if (state == ADAPTIVE_MARGIN_DISABLED || state == ADAPTIVE_MARGIN_FALLBACK) {
+		return;
+	}
+
+	/* A single failed read is retried next period */
+	if (!sample->valid) {
+		if (++fault_count >= FAULT_PERIODS) {
+			fall_back(ADAPTIVE_MARGIN_EVENT_SENSOR_FAULT);
+		}
+		return;
+	}
+	fault_count = 0;
+
+	if (sample->vm_mv + CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_DROOP_LIMIT_MV < sample->vcore_mv) {
+		fall_back(ADAPTIVE_MARGIN_EVENT_VOLTAGE_DROOP);
+		return;
+	}
+
+	if (!aging_ok(sample)) {
+		fall_back(ADAPTIVE_MARGIN_EVENT_AGING);
+		return;
+	}
+
+	/* At a voltage floor or another requestor's voltage, slack says nothing about the curve */
+	if (!sample->aiclk_limited || sample->aiclk_mhz == 0) {
+		return;
+	}
+
+	/* Slack per MHz changes with the operating point, so each has its own reference */
+	struct slack_ref *ref = &slack_refs[op_point(sample->aiclk_mhz)];
+
+	slack = sample->pd_mhz / sample->aiclk_mhz;
+	last_ref = ref;
+
+	if (trim_mv == 0) {
+		ref->slack = ref->learn_count == 0 ? slack : MIN(ref->slack, slack);
+		ref->learn_count = MIN(ref->learn_count + 1, LEARN_SAMPLES);
+	}
+
+	if (ref->learn_count < LEARN_SAMPLES) {
+		/* Return to the static margin to learn the reference of a new operating point */
+		state = ADAPTIVE_MARGIN_LEARNING;
+		set_trim(MAX(trim_mv - 2 * STEP_MV, 0), ADAPTIVE_MARGIN_EVENT_TRIM_UP);
+		return;
+	}
+	state = ADAPTIVE_MARGIN_TRACKING;
+
+	if (slack < ref->slack * (1.0F - 2.0F * GUARDBAND)) {
+		fall_back(ADAPTIVE_MARGIN_EVENT_SLACK_LOST);
+	} else if (slack < ref->slack * (1.0F - GUARDBAND)) {
+		set_trim(MAX(trim_mv - 2 * STEP_MV, 0), ADAPTIVE_MARGIN_EVENT_TRIM_UP);
+		hold_count = HOLD_PERIODS;
+	} else if (hold_count > 0) {
+		hold_count--;
+	} else if (trim_mv < MAX_TRIM_MV) {
+		set_trim(MIN(trim_mv + STEP_MV, MAX_TRIM_MV), ADAPTIVE_MARGIN_EVENT_TRIM_DOWN);
+	}
+}
+
+void GetAdaptiveMarginStatus(struct adaptive_margin_status *status)
+{
+	status->state = state;
+	status->trim_mv = trim_mv;
+	status->aging_permille = aging_permille;
+	status->slack_permille = to_permille(slack);
+	status->ref_slack_permille = last_ref == NULL || last_ref->learn_count < LEARN_SAMPLES
+					     ? 0
+					     : to_permille(last_ref->slack);
+	status->history_count = record.history_count;
+	status->starts = record.starts;
+}
+
+/**
+ * @brief Read a history entry
+ *
+ * @param index Entry number, counted from the first entry ever recorded
+ * @param entry Filled with the entry
+ * @return 0 on success, -ENOENT if the entry was not recorded or has been overwritten
+ */
+int GetAdaptiveMarginHistory(uint32_t index, struct adaptive_margin_history_entry *entry)
+{
+	if (index >= record.history_count || record.history_count - index > HISTORY_ENTRIES) {
+		return -ENOENT;
+	}
+
+	*entry = record.history[index % HISTORY_ENTRIES];
+
+	return 0;
+}
+
+#ifdef CONFIG_DT_HAS_TENSTORRENT_BH_PVT_ENABLED
+static const struct device *const pvt = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pvt));
+
+SENSOR_DT_READ_IODEV(am_pd_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_PD, 0},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 1}, {SENSOR_CHAN_PVT_TT_BH_PD, 2},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 3}, {SENSOR_CHAN_PVT_TT_BH_PD, 4},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 5}, {SENSOR_CHAN_PVT_TT_BH_PD, 6},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 7}, {SENSOR_CHAN_PVT_TT_BH_PD, 8},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 9}, {SENSOR_CHAN_PVT_TT_BH_PD, 10},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 11}, {SENSOR_CHAN_PVT_TT_BH_PD, 12},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 13}, {SENSOR_CHAN_PVT_TT_BH_PD, 14},
+		     {SENSOR_CHAN_PVT_TT_BH_PD, 15});
+
+SENSOR_DT_READ_IODEV(am_vm_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_VM, 0},
+		     {SENSOR_CHAN_PVT_TT_BH_VM, 1}, {SENSOR_CHAN_PVT_TT_BH_VM, 2},
+		     {SENSOR_CHAN_PVT_TT_BH_VM, 3}, {SENSOR_CHAN_PVT_TT_BH_VM, 4},
+		     {SENSOR_CHAN_PVT_TT_BH_VM, 5}, {SENSOR_CHAN_PVT_TT_BH_VM, 6},
+		     {SENSOR_CHAN_PVT_TT_BH_VM, 7});
+
+RTIO_DEFINE(am_ctx, 1, 1);
+
+static struct pvt_tt_bh_rtio_data am_pd_buf[DT_PROP(DT_NODELABEL(pvt), num_pd)];
+static struct pvt_tt_bh_rtio_data am_vm_buf[DT_PROP(DT_NODELABEL(pvt), num_vm)];
+
+static void adaptive_margin_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(adaptive_margin_work, adaptive_margin_work_handler);
+
+/* Sensor reads wait for conversions, so they run on their own queue below the system workqueue */
+static K_THREAD_STACK_DEFINE(adaptive_margin_stack, CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STACK_SIZE);
+static struct k_work_q adaptive_margin_wq;
+
+static void start_work_queue(void)
+{
+	static const struct k_work_queue_config cfg = {.name = "adaptive_margin"};
+
+	k_work_queue_init(&adaptive_margin_wq);
+	k_work_queue_start(&adaptive_margin_wq, adaptive_margin_stack,
+			   K_THREAD_STACK_SIZEOF(adaptive_margin_stack),
+			   CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_PRIORITY, &cfg);
+}
+
+static void schedule(void)
+{
+	k_work_reschedule_for_queue(&adaptive_margin_wq, &adaptive_margin_work,
+				    K_MSEC(CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_PERIOD_MS));
+}
+
+/* Reads all channels of one PVT type and returns the lowest decoded value */
+static int read_min(struct rtio_iodev *iodev, struct pvt_tt_bh_rtio_data *buf, size_t num,
+		    enum pvt_tt_bh_channel chan, float *min)
+{
+	const struct sensor_decoder_api *decoder;
+	struct sensor_value value;
+	int ret;
+
+	ret = sensor_get_decoder(pvt, &decoder);
+	if (ret == 0) {
+		ret = sensor_read(iodev, &am_ctx, (uint8_t *)buf, num * sizeof(*buf));
+	}
+	if (ret != 0) {
+		return ret;
+	}
+
+	*min = FLT_MAX;
+	for (size_t i = 0; i < num; i++) {
+		ret = decoder->decode((uint8_t *)buf, (struct sensor_chan_spec){chan, i}, NULL, 1,
+				      &value);
+		if (ret < 0) {
+			return ret;
+		}
+		*min = MIN(*min, sensor_value_to_float(&value));
+	}
+
+	return 0;
+}
+
+static void read_operating_point(struct adaptive_margin_sample *sample)
+{
+	uint32_t aiclk_voltage = voltage_arbiter.req_voltage[VoltageReqAiclk];
+
+	sample->aiclk_mhz = GetAiclkCurr();
+	sample->vcore_mv = voltage_arbiter.curr_voltage;
+	/* While AICLK ramps, VCORE is set for where the ramp started */
+	sample->aiclk_limited = sample->aiclk_mhz == GetAiclkTarg() &&
+				voltage_arbiter.forced_voltage == 0 &&
+				sample->vcore_mv == aiclk_voltage &&
+				aiclk_voltage > voltage_arbiter.vdd_min;
+}
+
+static void adaptive_margin_work_handler(struct k_work *work)
+{
+	static uint32_t periods;
+	struct adaptive_margin_sample sample = {0};
+	struct adaptive_margin_sample after;
+	float vm_v = 0.0F;
+	uint32_t prev_chain;
+	int ret;
+
+	ARG_UNUSED(work);
+
+	read_operating_point(&sample);
+
+	/* Borrow the delay chains, and leave the host's selection as it was */
+	prev_chain = pvt_tt_bh_delay_chain_lock(CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_DELAY_CHAIN);
+	ret = read_min(&am_pd_iodev, am_pd_buf, ARRAY_SIZE(am_pd_buf), SENSOR_CHAN_PVT_TT_BH_PD,
+		       &sample.pd_mhz);
+
+	if (ret == 0 && periods++ % AGING_PERIODS == 0) {
+		pvt_tt_bh_delay_chain_set(CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_AGING_DELAY_CHAIN);
+		ret = read_min(&am_pd_iodev, am_pd_buf, ARRAY_SIZE(am_pd_buf),
+			       SENSOR_CHAN_PVT_TT_BH_PD, &sample.aging_pd_mhz);
+	}
+	pvt_tt_bh_delay_chain_unlock(prev_chain);
+
+	if (ret == 0) {
+		ret = read_min(&am_vm_iodev, am_vm_buf, ARRAY_SIZE(am_vm_buf),
+			       SENSOR_CHAN_PVT_TT_BH_VM, &vm_v);
+	}
+	sample.vm_mv = vm_v * 1000.0F;
+	sample.valid = ret == 0;
+
+	/* DVFS moved the operating point while the sensors were read, so try again next period */
+	read_operating_point(&after);
+	if (after.aiclk_mhz == sample.aiclk_mhz && after.vcore_mv == sample.vcore_mv) {
+		AdaptiveMarginUpdate(&sample);
+	}
+
+	if (state != ADAPTIVE_MARGIN_DISABLED && state != ADAPTIVE_MARGIN_FALLBACK) {
+		schedule();
+	}
+}
+#else
+static void start_work_queue(void)
+{
+}
+
+static void schedule(void)
+{
+}
+#endif
+
+/**
+ * @brief Start adapting the voltage margin
+ *
+ * Must be called after InitVFCurve(), whose margins become the static margins. A fallback
+ * recorded before a reset keeps the static margin until the host re-enables adaptation.
+ */
+void InitAdaptiveMargin(void)
+{
+	GetVFCurveMargins(&static_freq_margin, &static_voltage_margin);
+	trim_mv = 0;
+	start_work_queue();
+
+	load_record();
+	record.starts++;
+
+	if (record.fallback != 0) {
+		state = ADAPTIVE_MARGIN_FALLBACK;
+		save_record();
+		return;
+	}
+
+	start(ADAPTIVE_MARGIN_EVENT_START);
+	schedule();
+}
+
+enum adaptive_margin_op {
+	ADAPTIVE_MARGIN_OP_STATUS = 0,
+	ADAPTIVE_MARGIN_OP_ENABLE = 1,
+	ADAPTIVE_MARGIN_OP_DISABLE = 2,
+	ADAPTIVE_MARGIN_OP_HISTORY = 3,
+};
+
+static uint8_t adaptive_margin_handler(const union request *request, struct response *response)
+{
+	const struct adaptive_margin_rqst *rqst = &request->adaptive_margin;
+	struct adaptive_margin_status status;
+	struct adaptive_margin_history_entry entry;
+
+	switch (rqst->op) {
+	case ADAPTIVE_MARGIN_OP_STATUS:
+		break;
+	case ADAPTIVE_MARGIN_OP_ENABLE:
+		if (state == ADAPTIVE_MARGIN_DISABLED || state == ADAPTIVE_MARGIN_FALLBACK) {
+			start(ADAPTIVE_MARGIN_EVENT_ENABLED);
+			schedule();
+		}
+		break;
+	case ADAPTIVE_MARGIN_OP_DISABLE:
+		if (state != ADAPTIVE_MARGIN_DISABLED) {
+			stop();
+		}
+		break;
+	case ADAPTIVE_MARGIN_OP_HISTORY:
+		if (GetAdaptiveMarginHistory(rqst->index, &entry) != 0) {
+			return ENOENT;
+		}
+		response->data[1] = entry.uptime_s;
+		response->data[2] = entry.event | (entry.trim_mv << 8) |
+				    ((uint32_t)entry.slack_permille << 16);
+		return 0;
+	default:
+		return EINVAL;
+	}
+
+	GetAdaptiveMarginStatus(&status);
+	response->data[1] = status.state | (status.trim_mv << 8) |
+			    ((uint32_t)status.aging_permille << 16);
+	response->data[2] = status.slack_permille;
+	response->data[3] = status.ref_slack_permille;
+	response->data[4] = status.history_count;
+	response->data[5] = status.starts;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_ADAPTIVE_MARGIN, adaptive_margin_handler);
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ADAPTIVE_MARGIN_H
+#define ADAPTIVE_MARGIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The adaptive margin trims the VF curve voltage margin while the process detectors show that the
+ * silicon keeps its timing slack. Slack is the frequency of the slowest process detector per MHz
+ * of AICLK. Its reference is the lowest slack seen at the static margin, learned separately for
+ * each AICLK band, and the margin is trimmed while slack stays within a guardband of it. Sensor anomalies restore the static margin until
+ * the host re-enables adaptation with TT_SMC_MSG_ADAPTIVE_MARGIN.
+ */
+
+enum adaptive_margin_state {
+	ADAPTIVE_MARGIN_DISABLED = 0,
+	ADAPTIVE_MARGIN_LEARNING = 1, /* at the static margin, measuring the reference slack */
+	ADAPTIVE_MARGIN_TRACKING = 2,
+	ADAPTIVE_MARGIN_FALLBACK = 3, /* an anomaly restored the static margin */
+};
+
+enum adaptive_margin_event {
+	ADAPTIVE_MARGIN_EVENT_START = 0,
+	ADAPTIVE_MARGIN_EVENT_TRIM_DOWN = 1,
+	ADAPTIVE_MARGIN_EVENT_TRIM_UP = 2,
+	ADAPTIVE_MARGIN_EVENT_ENABLED = 3,
+	ADAPTIVE_MARGIN_EVENT_DISABLED = 4,
+	/* Fallback reasons */
+	ADAPTIVE_MARGIN_EVENT_SENSOR_FAULT = 5,
+	ADAPTIVE_MARGIN_EVENT_VOLTAGE_DROOP = 6,
+	ADAPTIVE_MARGIN_EVENT_SLACK_LOST = 7,
+	ADAPTIVE_MARGIN_EVENT_AGING = 8,
+};
+
+struct adaptive_margin_sample {
+	bool valid;         /* every sensor read succeeded */
+	bool aiclk_limited; /* VCORE is set by the AICLK voltage request */
+	uint32_t aiclk_mhz; /* AICLK while the sensors were read */
+	uint32_t vcore_mv;  /* VCORE requested from the regulator */
+	float pd_mhz;       /* slowest process detector on the tracking delay chain */
+	float aging_pd_mhz; /* slowest process detector on the aging delay chain, 0 if not read */
+	float vm_mv;        /* lowest voltage monitor reading */
+};
+
+struct adaptive_margin_history_entry {
+	uint32_t uptime_s;
+	uint8_t event;           /* enum adaptive_margin_event */
+	uint8_t trim_mv;         /* voltage margin trim after the event */
+	uint16_t slack_permille; /* slack when the event happened */
+};
+
+struct adaptive_margin_status {
+	uint8_t state;               /* enum adaptive_margin_state */
+	uint8_t trim_mv;             /* subtracted from the static voltage margin */
+	uint16_t aging_permille;     /* aging delay chain slowdown since it was first measured */
+	uint32_t slack_permille;     /* latest slack */
+	uint32_t ref_slack_permille; /* reference slack, 0 until measured */
+	uint32_t history_count;      /* history entries ever recorded, across resets */
+	uint32_t starts;             /* times adaptation was started, across resets */
+};
+
+void InitAdaptiveMargin(void);
+void AdaptiveMarginUpdate(const struct adaptive_margin_sample *sample);
+void GetAdaptiveMarginStatus(struct adaptive_margin_status *status);
+int GetAdaptiveMarginHistory(uint32_t index, struct adaptive_margin_history_entry *entry);
+
+#endif
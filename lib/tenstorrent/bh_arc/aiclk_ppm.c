@@ -6,16 +6,19 @@
 
 #include "aiclk_ppm.h"
 #include "dvfs.h"
+#include "regulator.h"
 #include "voltage.h"
 #include "vf_curve.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <tenstorrent/bh_power.h>
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/msgqueue.h>
 #include <tenstorrent/sys_init_defines.h>
 #include <zephyr/init.h>
+#include <zephyr/kernel.h>
 #include <zephyr/drivers/misc/bh_fwtable.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/device.h>
@@ -25,12 +28,6 @@
 
 static const struct device *const pll_dev_0 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pll0));
 
-/* Bounds checks for FMAX and FMIN (in MHz) */
-#define AICLK_FMAX_MAX 1400.0F
-#define AICLK_FMAX_MIN 800.0F
-#define AICLK_FMIN_MAX 800.0F
-#define AICLK_FMIN_MIN 200.0F
-
 /* aiclk control mode */
 typedef enum {
 	CLOCK_MODE_UNCONTROLLED = 1,
@@ -46,6 +43,7 @@ typedef struct {
 typedef struct {
 	uint32_t curr_freq;   /* in MHz */
 	uint32_t targ_freq;   /* in MHz */
+	uint32_t ramp_freq;   /* in MHz, where the ramp in flight ends, curr_freq when idle */
 	uint32_t boot_freq;   /* in MHz */
 	uint32_t fmax;        /* in MHz */
 	uint32_t fmin;        /* in MHz */
@@ -86,23 +84,55 @@ void EnableArbMin(AiclkArbMin arb_min, bool enable)
 	aiclk_ppm.arbiter_min[arb_min].enabled = enable;
 }
 
+static struct aiclk_limiter_stats limiter_stats[AICLK_LIMITER_COUNT];
+static uint32_t aiclk_limiter = AICLK_LIMITER_ARB_MIN(kAiclkArbMinFmin);
+/* Protects limiter_stats and aiclk_limiter, which are read by message handlers */
+static struct k_spinlock limiter_lock;
+
+/* demand is what the min arbiters asked for. Only a max arbiter takes frequency away from it,
+ * so a min arbiter, a forced frequency or a sweep removes nothing.
+ */
+static void record_limiter(uint32_t limiter, uint32_t demand)
+{
+	struct aiclk_limiter_stats *stats = &limiter_stats[limiter];
+
+	K_SPINLOCK(&limiter_lock) {
+		aiclk_limiter = limiter;
+		stats->ticks++;
+		if (limiter < kAiclkArbMaxCount && aiclk_ppm.targ_freq < demand) {
+			stats->removed_mhz += demand - aiclk_ppm.targ_freq;
+		}
+		stats->last_ms = k_uptime_get();
+	}
+}
+
 void CalculateTargAiclk(void)
 {
 	/* Calculate the target AICLK frequency */
 	/* Start by calculating the highest arbiter_min */
 	/* Then limit to the lowest arbiter_max */
 	/* Finally make sure that the target frequency is at least Fmin */
+	/* The arbiter that set the target last is the limiter */
 	uint32_t targ_freq = aiclk_ppm.fmin;
+	uint32_t limiter = AICLK_LIMITER_ARB_MIN(kAiclkArbMinFmin);
+	uint32_t demand;
 
 	for (AiclkArbMin i = 0; i < kAiclkArbMinCount; i++) {
-		if (aiclk_ppm.arbiter_min[i].enabled) {
-			targ_freq = MAX(targ_freq, aiclk_ppm.arbiter_min[i].value);
+		const AiclkArb *arb = &aiclk_ppm.arbiter_min[i];
+
+		if (arb->enabled && arb->value > targ_freq) {
+			targ_freq = arb->value;
+			limiter = AICLK_LIMITER_ARB_MIN(i);
 		}
 	}
+	demand = targ_freq;
 
 	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
-		if (aiclk_ppm.arbiter_max[i].enabled) {
-			targ_freq = MIN(targ_freq, aiclk_ppm.arbiter_max[i].value);
+		const AiclkArb *arb = &aiclk_ppm.arbiter_max[i];
+
+		if (arb->enabled && arb->value < targ_freq) {
+			targ_freq = arb->value;
+			limiter = i;
 		}
 	}
 
@@ -114,62 +144,177 @@ void CalculateTargAiclk(void)
 	if (aiclk_ppm.sweep_en == 1) {
 		aiclk_ppm.targ_freq = rand() % (aiclk_ppm.sweep_high - aiclk_ppm.sweep_low + 1) +
 				      aiclk_ppm.sweep_low;
+		limiter = AICLK_LIMITER_SWEEP;
 	}
 
 	/* Apply forced frequency at the end, regardless of any limits */
 	if (aiclk_ppm.forced_freq != 0) {
 		aiclk_ppm.targ_freq = aiclk_ppm.forced_freq;
+		limiter = AICLK_LIMITER_FORCED;
+	}
+
+	record_limiter(limiter, demand);
+}
+
+uint32_t GetAiclkLimiter(void)
+{
+	return aiclk_limiter;
+}
+
+void GetAiclkLimiterStats(uint32_t limiter, struct aiclk_limiter_stats *stats)
+{
+	K_SPINLOCK(&limiter_lock) {
+		*stats = limiter_stats[limiter];
+	}
+}
+
+void ResetAiclkLimiterStats(void)
+{
+	K_SPINLOCK(&limiter_lock) {
+		memset(limiter_stats, 0, sizeof(limiter_stats));
 	}
 }
 
+/* AICLK moves towards ramp_freq by at most this much every ramp period. Without a slew rate, a
+ * ramp only waits for VCORE to settle.
+ */
+#define AICLK_RAMP_STEP                                                                            \
+	(CONFIG_TT_BH_ARC_AICLK_SLEW_RATE == 0                                                     \
+		 ? UINT32_MAX                                                                      \
+		 : MAX(CONFIG_TT_BH_ARC_AICLK_SLEW_RATE * CONFIG_TT_BH_ARC_AICLK_RAMP_PERIOD_US /  \
+			       1000,                                                               \
+		       1))
+#define AICLK_RAMP_PERIOD K_USEC(CONFIG_TT_BH_ARC_AICLK_RAMP_PERIOD_US)
+
+/* Protects curr_freq and ramp_freq, which ramp steps move */
+static K_MUTEX_DEFINE(ramp_mutex);
+
+static void set_aiclk(uint32_t freq)
+{
+	clock_control_set_rate(pll_dev_0, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
+			       (clock_control_subsys_rate_t)freq);
+}
+
+/* The clock driver is not called from the timer ISR, the DVFS thread takes the step */
+static void aiclk_ramp_handler(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	DVFSRampStep();
+}
+static K_TIMER_DEFINE(aiclk_ramp_timer, aiclk_ramp_handler, NULL);
+
+/**
+ * @brief Move AICLK one step towards the target of the ramp in flight
+ *
+ * Runs on the DVFS thread once every ramp period.
+ *
+ * @return true if this step ended the ramp
+ */
+bool AiclkRampStep(void)
+{
+	uint32_t curr;
+	uint32_t dest;
+	bool done = false;
+
+	k_mutex_lock(&ramp_mutex, K_FOREVER);
+
+	curr = aiclk_ppm.curr_freq;
+	dest = aiclk_ppm.ramp_freq;
+
+	/* A step left over from a ramp that has already ended, or one up that must wait for the
+	 * VCORE write before it
+	 */
+	if (curr != dest && (dest < curr || vcore_settled())) {
+		if (dest > curr) {
+			curr += MIN(dest - curr, AICLK_RAMP_STEP);
+		} else {
+			curr -= MIN(curr - dest, AICLK_RAMP_STEP);
+		}
+
+		set_aiclk(curr);
+		aiclk_ppm.curr_freq = curr;
+
+		done = curr == dest;
+		if (done) {
+			k_timer_stop(&aiclk_ramp_timer);
+		}
+	}
+
+	k_mutex_unlock(&ramp_mutex);
+
+	return done;
+}
+
+/* Moves AICLK to freq at the configured slew rate without waiting for it to get there. A ramp
+ * in flight is retargeted, so AICLK never overshoots the newest target.
+ */
+static void ramp_aiclk(uint32_t freq)
+{
+	bool idle;
+
+	k_mutex_lock(&ramp_mutex, K_FOREVER);
+
+	idle = aiclk_ppm.ramp_freq == aiclk_ppm.curr_freq;
+	aiclk_ppm.ramp_freq = freq;
+
+	if (CONFIG_TT_BH_ARC_AICLK_SLEW_RATE == 0 &&
+	    (freq < aiclk_ppm.curr_freq || vcore_settled())) {
+		k_timer_stop(&aiclk_ramp_timer);
+		set_aiclk(freq);
+		aiclk_ppm.curr_freq = freq;
+	} else if (idle && freq != aiclk_ppm.curr_freq) {
+		k_timer_start(&aiclk_ramp_timer, K_NO_WAIT, AICLK_RAMP_PERIOD);
+	}
+
+	k_mutex_unlock(&ramp_mutex);
+}
+
 void DecreaseAiclk(void)
 {
-	if (aiclk_ppm.targ_freq < aiclk_ppm.curr_freq) {
-		clock_control_set_rate(pll_dev_0,
-				       (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
-				       (clock_control_subsys_rate_t)aiclk_ppm.targ_freq);
-		aiclk_ppm.curr_freq = aiclk_ppm.targ_freq;
+	if (aiclk_ppm.targ_freq < aiclk_ppm.ramp_freq) {
+		ramp_aiclk(aiclk_ppm.targ_freq);
 	}
 }
 
 void IncreaseAiclk(void)
 {
-	if (aiclk_ppm.targ_freq > aiclk_ppm.curr_freq) {
-		clock_control_set_rate(pll_dev_0,
-				       (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
-				       (clock_control_subsys_rate_t)aiclk_ppm.targ_freq);
-		aiclk_ppm.curr_freq = aiclk_ppm.targ_freq;
+	if (aiclk_ppm.targ_freq > aiclk_ppm.ramp_freq) {
+		ramp_aiclk(aiclk_ppm.targ_freq);
 	}
 }
 
+/* The voltage for the AICLK a ramp in flight is still at, as well as for the target */
+uint32_t GetAiclkVoltage(void)
+{
+	return MAX(VFCurveLookup(aiclk_ppm.targ_freq), VFCurveLookup(aiclk_ppm.curr_freq));
+}
+
 float GetThrottlerArbMax(AiclkArbMax arb_max)
 {
 	return aiclk_ppm.arbiter_max[arb_max].value;
 }
 
-/* TODO: Write a Zephyr unit test for this function */
-uint32_t GetMaxAiclkForVoltage(uint32_t voltage)
+/* Disabled arbiters read as 0 */
+void GetAiclkArbiters(uint16_t arb_max[kAiclkArbMaxCount], uint16_t arb_min[kAiclkArbMinCount])
 {
-	/* Assume monotonically increasing relationship between frequency and voltage */
-	/* and conduct binary search. */
-	/* Note this function doesn't work if you would need lower than fmin to achieve the voltage
-	 */
-
-	/* starting high_freq at fmax + 1 solves the case where the Max AICLK is fmax */
-	uint32_t high_freq = aiclk_ppm.fmax + 1;
-	uint32_t low_freq = aiclk_ppm.fmin;
+	for (int i = 0; i < kAiclkArbMaxCount; i++) {
+		const AiclkArb *arb = &aiclk_ppm.arbiter_max[i];
 
-	while (low_freq < high_freq) {
-		uint32_t mid_freq = (low_freq + high_freq) / 2;
+		arb_max[i] = arb->enabled ? (uint16_t)arb->value : 0;
+	}
+	for (int i = 0; i < kAiclkArbMinCount; i++) {
+		const AiclkArb *arb = &aiclk_ppm.arbiter_min[i];
 
-		if (VFCurve(mid_freq) > voltage) {
-			high_freq = mid_freq;
-		} else {
-			low_freq = mid_freq + 1;
-		}
+		arb_min[i] = arb->enabled ? (uint16_t)arb->value : 0;
 	}
+}
 
-	return low_freq - 1;
+uint32_t GetMaxAiclkForVoltage(uint32_t voltage)
+{
+	/* Note this function doesn't work if you would need lower than fmin to achieve the voltage
+	 */
+	return MAX(VFCurveMaxFreq(voltage), aiclk_ppm.fmin - 1);
 }
 
 void InitArbMaxVoltage(void)
@@ -190,6 +335,7 @@ static int InitAiclkPPM(void)
 
 	aiclk_ppm.curr_freq = aiclk_ppm.boot_freq;
 	aiclk_ppm.targ_freq = aiclk_ppm.curr_freq;
+	aiclk_ppm.ramp_freq = aiclk_ppm.curr_freq;
 
 	if (IS_ENABLED(CONFIG_ARC)) {
 		aiclk_ppm.fmax =
@@ -216,6 +362,9 @@ static int InitAiclkPPM(void)
 		aiclk_ppm.arbiter_min[i].enabled = true;
 	}
 
+	/* Tables for the default margins, until InitVFCurve() applies the fwtable ones */
+	UpdateVFTables();
+
 	return 0;
 }
 SYS_INIT_APP(InitAiclkPPM);
@@ -227,17 +376,16 @@ uint8_t ForceAiclk(uint32_t freq)
 	}
 
 	if (dvfs_enabled) {
+		/* Applied by the DVFS thread, so it never runs alongside a DVFS tick */
 		aiclk_ppm.forced_freq = freq;
-		DVFSChange();
+		DVFSTickNow();
 	} else {
 		/* restore to boot frequency */
 		if (freq == 0) {
 			freq = aiclk_ppm.boot_freq;
 		}
 
-		clock_control_set_rate(pll_dev_0,
-				       (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
-				       (clock_control_subsys_rate_t)freq);
+		ramp_aiclk(freq);
 	}
 	return 0;
 }
@@ -247,6 +395,11 @@ uint32_t GetAiclkTarg(void)
 	return aiclk_ppm.targ_freq;
 }
 
+uint32_t GetAiclkCurr(void)
+{
+	return aiclk_ppm.curr_freq;
+}
+
 uint32_t GetAiclkFmin(void)
 {
 	return aiclk_ppm.fmin;
@@ -318,9 +471,34 @@ static uint8_t SweepAiclkHandler(const union request *request, struct response *
 	return 0;
 }
 
+static uint8_t aiclk_limiters_handler(const union request *request, struct response *response)
+{
+	const struct aiclk_limiters_rqst *rqst = &request->aiclk_limiters;
+	struct aiclk_limiter_stats stats;
+
+	if (rqst->limiter >= AICLK_LIMITER_COUNT) {
+		return EINVAL;
+	}
+
+	GetAiclkLimiterStats(rqst->limiter, &stats);
+	response->data[1] = GetAiclkLimiter() | (AICLK_LIMITER_COUNT << 8);
+	response->data[2] = stats.ticks;
+	response->data[3] = (uint32_t)stats.removed_mhz;
+	response->data[4] = (uint32_t)(stats.removed_mhz >> 32);
+	response->data[5] = (uint32_t)stats.last_ms;
+	response->data[6] = (uint32_t)(stats.last_ms >> 32);
+
+	if (rqst->reset) {
+		ResetAiclkLimiterStats();
+	}
+
+	return 0;
+}
+
 REGISTER_MESSAGE(TT_SMC_MSG_AICLK_GO_BUSY, aiclk_busy_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_AICLK_GO_LONG_IDLE, aiclk_busy_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_FORCE_AICLK, ForceAiclkHandler);
 REGISTER_MESSAGE(TT_SMC_MSG_GET_AICLK, get_aiclk_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_AISWEEP_START, SweepAiclkHandler);
 REGISTER_MESSAGE(TT_SMC_MSG_AISWEEP_STOP, SweepAiclkHandler);
+REGISTER_MESSAGE(TT_SMC_MSG_AICLK_LIMITERS, aiclk_limiters_handler);
@@ -9,6 +9,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Bounds checks for FMAX and FMIN (in MHz) */
+#define AICLK_FMAX_MAX 1400.0F
+#define AICLK_FMAX_MIN 800.0F
+#define AICLK_FMIN_MAX 800.0F
+#define AICLK_FMIN_MIN 200.0F
+
 typedef enum {
 	kAiclkArbMaxFmax,
 	kAiclkArbMaxTDP,
@@ -29,6 +35,21 @@ typedef enum {
 	kAiclkArbMinCount,
 } AiclkArbMin;
 
+/* What set the AICLK target in CalculateTargAiclk(). The max arbiters come first, so a limiter
+ * below kAiclkArbMaxCount is the AiclkArbMax that throttled AICLK. The Fmin arbiter is the
+ * limiter when nothing asks for more than Fmin, such as while idle.
+ */
+#define AICLK_LIMITER_ARB_MIN(arb_min) (kAiclkArbMaxCount + (arb_min))
+#define AICLK_LIMITER_FORCED           (kAiclkArbMaxCount + kAiclkArbMinCount)
+#define AICLK_LIMITER_SWEEP            (AICLK_LIMITER_FORCED + 1)
+#define AICLK_LIMITER_COUNT            (AICLK_LIMITER_SWEEP + 1)
+
+struct aiclk_limiter_stats {
+	uint32_t ticks;       /* target calculations in which this limiter set AICLK */
+	uint64_t removed_mhz; /* sum of the min arbiter demand minus the target, for max arbiters */
+	int64_t last_ms;      /* uptime of the latest of them, 0 if none */
+};
+
 void aiclk_update_busy(void);
 void SetAiclkArbMax(AiclkArbMax arb_max, float freq);
 void SetAiclkArbMin(AiclkArbMin arb_min, float freq);
@@ -37,12 +58,19 @@ void EnableArbMin(AiclkArbMin arb_min, bool enable);
 void CalculateTargAiclk(void);
 void DecreaseAiclk(void);
 void IncreaseAiclk(void);
+bool AiclkRampStep(void);
 void InitArbMaxVoltage(void);
 float GetThrottlerArbMax(AiclkArbMax arb_max);
+void GetAiclkArbiters(uint16_t arb_max[kAiclkArbMaxCount], uint16_t arb_min[kAiclkArbMinCount]);
 uint8_t ForceAiclk(uint32_t freq);
 uint32_t GetAiclkTarg(void);
+uint32_t GetAiclkCurr(void);
+uint32_t GetAiclkVoltage(void);
 uint32_t GetMaxAiclkForVoltage(uint32_t voltage);
 uint32_t GetAiclkFmin(void);
 uint32_t GetAiclkFmax(void);
+uint32_t GetAiclkLimiter(void);
+void GetAiclkLimiterStats(uint32_t limiter, struct aiclk_limiter_stats *stats);
+void ResetAiclkLimiterStats(void);
 
 #endif
@@ -7,8 +7,11 @@
 #include "avs.h"
 #include "regulator.h"
 
+#include <errno.h>
+
 #include <tenstorrent/sys_init_defines.h>
 #include <zephyr/init.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
@@ -53,14 +56,14 @@ static const struct device *const pll_dev_1 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL
 
 /* command code, command group macros */
 /* 0: defined by AVS spec, 1: vendor specific  */
-#define AVS_CMD_VOLTAGE                0x0, 0
-#define AVS_CMD_VOUT_TRANS_RATE        0x1, 0
-#define AVS_CMD_CURRENT_READ           0x2, 0
-#define AVS_CMD_TEMP_READ              0x3, 0
-#define AVS_CMD_FORCE_RESET            0x4, 0
-#define AVS_CMD_POWER_MODE             0x5, 0
-#define AVS_CMD_STATUS                 0xe, 0
-#define AVS_CMD_VERSION_READ           0xf, 0
+#define AVS_CMD_VOLTAGE                AVSCmdVoltage, 0
+#define AVS_CMD_VOUT_TRANS_RATE        AVSCmdVoutTransRate, 0
+#define AVS_CMD_CURRENT_READ           AVSCmdCurrentRead, 0
+#define AVS_CMD_TEMP_READ              AVSCmdTempRead, 0
+#define AVS_CMD_FORCE_RESET            AVSCmdForceReset, 0
+#define AVS_CMD_POWER_MODE             AVSCmdPowerMode, 0
+#define AVS_CMD_STATUS                 AVSCmdStatus, 0
+#define AVS_CMD_VERSION_READ           AVSCmdVersionRead, 0
 #define AVS_CMD_SYS_INPUT_CURRENT_READ 0x0, 1
 
 typedef struct {
@@ -87,59 +90,94 @@ typedef enum {
 	AVSRead = 3,
 } AVSReadWriteType;
 
-static void WaitCmdFifoNotFull(void)
+static uint8_t CmdFifoVacantSlots(void)
 {
-	uint32_t cmd_fifo_vacant_slots = 0;
+	return FIELD_GET(GET_AVS_FIELD_MASK(FIFOS_STATUS, CMD_FIFO_VACANT_SLOTS),
+			 ReadReg(APB2AVSBUS_AVS_FIFOS_STATUS_REG_ADDR));
+}
 
-	do {
-		cmd_fifo_vacant_slots = ReadReg(APB2AVSBUS_AVS_FIFOS_STATUS_REG_ADDR) &
-					GET_AVS_FIELD_MASK(FIFOS_STATUS, CMD_FIFO_VACANT_SLOTS);
-	} while (cmd_fifo_vacant_slots == 0);
+static bool RxFifoEmpty(void)
+{
+	return (ReadReg(APB2AVSBUS_AVS_FIFOS_STATUS_REG_ADDR) &
+		GET_AVS_FIELD_MASK(FIFOS_STATUS, READBACK_FIFO_OCCUPIED_SLOTS)) == 0;
 }
 
-static void WaitRxFifoNotEmpty(void)
+/* Commands sent by QueueCmds, oldest first. Every command, read or write, gets a response in the
+ * RX FIFO in the order the commands were sent, plus one more for each retry of a NACKed command.
+ */
+struct AVSPendingCmd {
+	AVSCallback cb;
+	void *user_data;
+	uint8_t num_tries;
+};
+
+static struct AVSPendingCmd pending_cmds[AVS_MAX_PENDING_CMDS];
+static uint8_t pending_head;
+static uint8_t pending_count;
+
+/* Keeps the pending commands in the order of the FIFOs */
+static struct k_spinlock avs_lock;
+
+static uint16_t ReadbackData(uint32_t readback_data, AVSStatus slave_ack)
 {
-	uint32_t readback_fifo_occupied_slots = 0;
+	if (slave_ack != AVSOk) {
+		return AVS_ERR_RB_DATA;
+	}
 
-	do {
-		readback_fifo_occupied_slots =
-			ReadReg(APB2AVSBUS_AVS_FIFOS_STATUS_REG_ADDR) &
-			GET_AVS_FIELD_MASK(FIFOS_STATUS, READBACK_FIFO_OCCUPIED_SLOTS);
-	} while (readback_fifo_occupied_slots == 0);
+	return (readback_data & GET_AVS_FIELD_MASK(READBACK, CMD_DATA)) >>
+	       GET_AVS_FIELD_SHIFT(READBACK, CMD_DATA);
 }
 
-/* Assume users do not program max_retries while reading from the RX FIFO. */
-/* TODO: log the debug status in CSM. */
-static AVSStatus ReadRxFifo(uint16_t *response)
+/* Collects the response to the oldest pending command and calls its callback. Returns false if
+ * no command is pending or its response has not arrived yet. Never waits, so it can run from the
+ * AVS interrupt as well as from a thread. Assumes max_retries is not reprogrammed while responses
+ * are read from the RX FIFO.
+ *
+ * TODO: log the debug status in CSM.
+ */
+static bool CompleteCmd(void)
 {
-	uint8_t max_retries = ReadReg(APB2AVSBUS_AVS_CFG_0_REG_ADDR);
-	uint32_t readback_data = 0;
-	uint8_t num_tries = 0;
+	struct AVSPendingCmd done = {0};
 	AVSStatus slave_ack = AVSOk;
+	uint16_t response = 0;
+	bool completed = false;
 
-	do {
-		WaitRxFifoNotEmpty();
-		readback_data = ReadReg(APB2AVSBUS_AVS_READBACK_REG_ADDR);
-		slave_ack = readback_data >> GET_AVS_FIELD_SHIFT(READBACK, SLAVE_ACK);
-		num_tries++;
-	} while (slave_ack != AVSOk && num_tries <= max_retries);
+	K_SPINLOCK(&avs_lock) {
+		struct AVSPendingCmd *cmd = &pending_cmds[pending_head];
+		uint8_t max_retries;
 
-	if (response != NULL) {
-		if (slave_ack != AVSOk) {
-			*response = AVS_ERR_RB_DATA;
-		} else {
-			*response = (readback_data & GET_AVS_FIELD_MASK(READBACK, CMD_DATA)) >>
-				    GET_AVS_FIELD_SHIFT(READBACK, CMD_DATA);
+		if (pending_count == 0) {
+			K_SPINLOCK_BREAK;
+		}
+
+		max_retries = ReadReg(APB2AVSBUS_AVS_CFG_0_REG_ADDR);
+		while (!completed && !RxFifoEmpty()) {
+			uint32_t readback_data = ReadReg(APB2AVSBUS_AVS_READBACK_REG_ADDR);
+
+			slave_ack = readback_data >> GET_AVS_FIELD_SHIFT(READBACK, SLAVE_ACK);
+			cmd->num_tries++;
+			if (slave_ack == AVSOk || cmd->num_tries > max_retries) {
+				response = ReadbackData(readback_data, slave_ack);
+				done = *cmd;
+				pending_head = (pending_head + 1) % AVS_MAX_PENDING_CMDS;
+				pending_count--;
+				completed = true;
+			}
 		}
 	}
 
-	return slave_ack;
+	/* Outside the lock, so a callback can queue the next command */
+	if (completed && done.cb != NULL) {
+		done.cb(slave_ack, response, done.user_data);
+	}
+
+	return completed;
 }
 
+/* The caller makes sure the command FIFO has a vacant slot */
 static void SendCmd(uint16_t cmd_data, uint8_t rail_sel, uint8_t cmd_code, uint8_t cmd_grp,
 		    AVSReadWriteType r_or_w)
 {
-	WaitCmdFifoNotFull();
 	uint32_t cmd_data_pos = cmd_data << GET_AVS_FIELD_SHIFT(CMD, CMD_DATA);
 	uint32_t rail_sel_pos = (rail_sel << GET_AVS_FIELD_SHIFT(CMD, RAIL_SEL)) &
 				GET_AVS_FIELD_MASK(CMD, RAIL_SEL);
@@ -153,6 +191,87 @@ static void SendCmd(uint16_t cmd_data, uint8_t rail_sel, uint8_t cmd_code, uint8
 		 cmd_data_pos | rail_sel_pos | cmd_code_pos | cmd_grp_pos | r_or_w_pos);
 }
 
+/* Sends all of cmds back to back, or none of them if they don't all fit in the queue and in the
+ * command FIFO. The FIFO is checked once up front rather than waited on, so interrupts are never
+ * masked while the controller works through earlier commands.
+ */
+static int QueueCmds(const AVSCmd *cmds, uint8_t num_cmds)
+{
+	int ret = 0;
+
+	K_SPINLOCK(&avs_lock) {
+		if (num_cmds > AVS_MAX_PENDING_CMDS - pending_count ||
+		    num_cmds > CmdFifoVacantSlots()) {
+			ret = -EBUSY;
+			K_SPINLOCK_BREAK;
+		}
+
+		for (uint8_t i = 0; i < num_cmds; i++) {
+			uint8_t slot = (pending_head + pending_count) % AVS_MAX_PENDING_CMDS;
+			struct AVSPendingCmd *cmd = &pending_cmds[slot];
+
+			cmd->cb = cmds[i].cb;
+			cmd->user_data = cmds[i].user_data;
+			cmd->num_tries = 0;
+			pending_count++;
+
+			SendCmd(cmds[i].write ? cmds[i].data : AVS_RD_CMD_DATA, cmds[i].rail_sel,
+				cmds[i].cmd_code, cmds[i].cmd_grp,
+				cmds[i].write ? AVSCommitWrite : AVSRead);
+		}
+	}
+
+	return ret;
+}
+
+void AVSFutureDone(AVSStatus status, uint16_t response, void *user_data)
+{
+	AVSFuture *future = user_data;
+
+	future->status = status;
+	future->response = response;
+	future->done = true;
+}
+
+/* Waits for the command behind future, completing any commands queued before it */
+AVSStatus AVSFutureWait(AVSFuture *future, uint16_t *response)
+{
+	while (!future->done) {
+		/* Each command takes the regulator microseconds, let other threads run meanwhile */
+		if (!CompleteCmd() && !k_is_in_isr()) {
+			k_yield();
+		}
+	}
+
+	if (response != NULL) {
+		*response = future->response;
+	}
+
+	return future->status;
+}
+
+static AVSStatus RunCmd(uint16_t cmd_data, uint8_t rail_sel, uint8_t cmd_code, uint8_t cmd_grp,
+			AVSReadWriteType r_or_w, uint16_t *response)
+{
+	AVSFuture future = {0};
+	AVSCmd cmd = {
+		.cmd_code = cmd_code,
+		.cmd_grp = cmd_grp,
+		.rail_sel = rail_sel,
+		.write = r_or_w != AVSRead,
+		.data = cmd_data,
+		.cb = AVSFutureDone,
+		.user_data = &future,
+	};
+
+	/* Make room by completing queued commands when the queue or the command FIFO is full */
+	while (QueueCmds(&cmd, 1) != 0) {
+		CompleteCmd();
+	}
+
+	return AVSFutureWait(&future, response);
+}
+
 /* Program CFG_0, CFG_1 registers and interrupt settings. */
 /* Use default max_retries, resync_interval, clk_divide_value, and clk_divider_duty_cycle_numerator
  */
@@ -190,25 +309,22 @@ void AVSInit(void)
 
 AVSStatus AVSReadVoltage(uint8_t rail_sel, uint16_t *voltage_in_mV)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOLTAGE, AVSRead);
-	return ReadRxFifo(voltage_in_mV);
+	return RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOLTAGE, AVSRead, voltage_in_mV);
 }
 
 AVSStatus AVSWriteVoltage(uint16_t voltage_in_mV, uint8_t rail_sel)
 {
-	SendCmd(voltage_in_mV, rail_sel, AVS_CMD_VOLTAGE, AVSCommitWrite);
-	AVSStatus status = ReadRxFifo(NULL);
+	AVSStatus status = RunCmd(voltage_in_mV, rail_sel, AVS_CMD_VOLTAGE, AVSCommitWrite, NULL);
 
-	/* 150us to cover voltage switch from 0.65V to 0.95V with 50us of margin */
-	WaitUs(150);
+	WaitUs(AVS_VOLTAGE_SETTLE_US);
 	return status;
 }
 
 AVSStatus AVSReadVoutTransRate(uint8_t rail_sel, uint8_t *rise_rate, uint8_t *fall_rate)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSRead);
 	uint16_t trans_rate;
-	AVSStatus status = ReadRxFifo(&trans_rate);
+	AVSStatus status = RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSRead,
+				  &trans_rate);
 	*rise_rate = trans_rate >> 8;
 	*fall_rate = trans_rate & 0xff;
 	return status;
@@ -218,59 +334,53 @@ AVSStatus AVSWriteVoutTransRate(uint8_t rise_rate, uint8_t fall_rate, uint8_t ra
 {
 	uint16_t trans_rate = (rise_rate << 8) | fall_rate;
 
-	SendCmd(trans_rate, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return RunCmd(trans_rate, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSCommitWrite, NULL);
 }
 
 /* Returns current in A */
 AVSStatus AVSReadCurrent(uint8_t rail_sel, float *current_in_A)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_CURRENT_READ, AVSRead);
 	uint16_t current_in_10mA;
-	AVSStatus status = ReadRxFifo(&current_in_10mA);
-	*current_in_A = current_in_10mA * 0.01f;
+	AVSStatus status = RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_CURRENT_READ, AVSRead,
+				  &current_in_10mA);
+	*current_in_A = current_in_10mA * AVS_CURRENT_LSB_A;
 	return status;
 }
 
 AVSStatus AVSReadTemp(uint8_t rail_sel, float *temp_in_C)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_TEMP_READ, AVSRead);
 	uint16_t temp; /* 1LSB = 0.1degC  */
-	AVSStatus status = ReadRxFifo(&temp);
-	*temp_in_C = temp * 0.1;
+	AVSStatus status = RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_TEMP_READ, AVSRead, &temp);
+	*temp_in_C = temp * AVS_TEMP_LSB_C;
 	return status;
 }
 
 AVSStatus AVSForceVoltageReset(uint8_t rail_sel)
 {
-	SendCmd(AVS_FORCE_RESET_DATA, rail_sel, AVS_CMD_FORCE_RESET, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return RunCmd(AVS_FORCE_RESET_DATA, rail_sel, AVS_CMD_FORCE_RESET, AVSCommitWrite, NULL);
 }
 
 /* This command is not supported by MAX20816, but will be ACKed. */
 AVSStatus AVSReadPowerMode(uint8_t rail_sel, AVSPwrMode *power_mode)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_POWER_MODE, AVSRead);
-	return ReadRxFifo((uint16_t *)power_mode);
+	return RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_POWER_MODE, AVSRead,
+		      (uint16_t *)power_mode);
 }
 
 /* This command is not supported by MAX20816, but will be ACKed. */
 AVSStatus AVSWritePowerMode(AVSPwrMode power_mode, uint8_t rail_sel)
 {
-	SendCmd(power_mode, rail_sel, AVS_CMD_POWER_MODE, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return RunCmd(power_mode, rail_sel, AVS_CMD_POWER_MODE, AVSCommitWrite, NULL);
 }
 
 AVSStatus AVSReadStatus(uint8_t rail_sel, uint16_t *status)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_STATUS, AVSRead);
-	return ReadRxFifo(status);
+	return RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_STATUS, AVSRead, status);
 }
 
 AVSStatus AVSWriteStatus(uint16_t status, uint8_t rail_sel)
 {
-	SendCmd(status, rail_sel, AVS_CMD_STATUS, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return RunCmd(status, rail_sel, AVS_CMD_STATUS, AVSCommitWrite, NULL);
 }
 
 /* For AVSBus version read, the rail_sel is broadcast. */
@@ -278,16 +388,15 @@ AVSStatus AVSWriteStatus(uint16_t status, uint8_t rail_sel)
 /* Any other PMBus versions are not supported by the AVS controller. */
 AVSStatus AVSReadVersion(uint16_t *version)
 {
-	SendCmd(AVS_RD_CMD_DATA, AVS_RAIL_SEL_BROADCAST, AVS_CMD_VERSION_READ, AVSRead);
-	return ReadRxFifo(version);
+	return RunCmd(AVS_RD_CMD_DATA, AVS_RAIL_SEL_BROADCAST, AVS_CMD_VERSION_READ, AVSRead,
+		      version);
 }
 
 AVSStatus AVSReadSystemInputCurrent(uint16_t *response)
 {
 	uint8_t rail_sel = 0x0; /* Rail A and Rail B return the same data. */
 
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_SYS_INPUT_CURRENT_READ, AVSRead);
-	return ReadRxFifo(response);
+	return RunCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_SYS_INPUT_CURRENT_READ, AVSRead, response);
 	/* TODO: need to figure the formula to calculate the system input current */
 	/* System Input Current (read only) returns the ADC output of voltage at IINSEN pin. */
 	/* The raw ADC data is decoded to determine the VIINSEN voltage: */
@@ -301,6 +410,59 @@ AVSStatus AVSReadSystemInputCurrent(uint16_t *response)
 	 */
 }
 
+/* Queues all of cmds, back to back and in order, or none of them. Returns -EBUSY when fewer
+ * than num_cmds of the AVS_MAX_PENDING_CMDS queue entries, or of the command FIFO slots, are
+ * free.
+ */
+int AVSSubmit(const AVSCmd *cmds, uint8_t num_cmds)
+{
+	return QueueCmds(cmds, num_cmds);
+}
+
+/* Voltage in mV */
+int AVSReadVoltageAsync(uint8_t rail_sel, AVSCallback cb, void *user_data)
+{
+	AVSCmd cmd = {.cmd_code = AVSCmdVoltage, .rail_sel = rail_sel, .cb = cb,
+		      .user_data = user_data};
+
+	return QueueCmds(&cmd, 1);
+}
+
+/* The callback runs once the regulator has taken the write. The rail has settled
+ * AVS_VOLTAGE_SETTLE_US after that.
+ */
+int AVSWriteVoltageAsync(uint16_t voltage_in_mV, uint8_t rail_sel, AVSCallback cb,
+			 void *user_data)
+{
+	AVSCmd cmd = {.cmd_code = AVSCmdVoltage, .rail_sel = rail_sel, .write = true,
+		      .data = voltage_in_mV, .cb = cb, .user_data = user_data};
+
+	return QueueCmds(&cmd, 1);
+}
+
+/* Current in units of AVS_CURRENT_LSB_A */
+int AVSReadCurrentAsync(uint8_t rail_sel, AVSCallback cb, void *user_data)
+{
+	AVSCmd cmd = {.cmd_code = AVSCmdCurrentRead, .rail_sel = rail_sel, .cb = cb,
+		      .user_data = user_data};
+
+	return QueueCmds(&cmd, 1);
+}
+
+int AVSPoll(void)
+{
+	int count;
+
+	while (CompleteCmd()) {
+	}
+
+	K_SPINLOCK(&avs_lock) {
+		count = pending_count;
+	}
+
+	return count;
+}
+
 static int avs_init(void)
 {
 	if (IS_ENABLED(CONFIG_TT_SMC_RECOVERY) || !IS_ENABLED(CONFIG_ARC)) {
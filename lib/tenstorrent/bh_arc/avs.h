@@ -6,6 +6,7 @@
 #ifndef AVS_H
 #define AVS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef enum {
@@ -23,6 +24,51 @@ typedef enum {
 #define AVS_VCORE_RAIL  0
 #define AVS_VCOREM_RAIL 1
 
+typedef enum {
+	AVSCmdVoltage = 0x0,
+	AVSCmdVoutTransRate = 0x1,
+	AVSCmdCurrentRead = 0x2,
+	AVSCmdTempRead = 0x3,
+	AVSCmdForceReset = 0x4,
+	AVSCmdPowerMode = 0x5,
+	AVSCmdStatus = 0xe,
+	AVSCmdVersionRead = 0xf,
+} AVSCmdCode;
+
+#define AVS_CURRENT_LSB_A    0.01f
+#define AVS_TEMP_LSB_C       0.1f
+#define AVS_MAX_PENDING_CMDS 8
+
+/* Time for a voltage write to settle once the regulator has taken it: 0.65V to 0.95V with 50us
+ * of margin
+ */
+#define AVS_VOLTAGE_SETTLE_US 150
+
+/* Called with the raw response once a queued command completes. The response is 0xffff on error
+ * and is not meaningful for writes. Callbacks run on whichever context collects the response, so
+ * they must not block.
+ */
+typedef void (*AVSCallback)(AVSStatus status, uint16_t response, void *user_data);
+
+typedef struct {
+	uint8_t cmd_code; /* AVSCmdCode */
+	uint8_t cmd_grp;  /* 0: defined by the AVS spec, 1: vendor specific */
+	uint8_t rail_sel;
+	bool write;
+	uint16_t data; /* value to write, ignored by reads */
+	AVSCallback cb;
+	void *user_data;
+} AVSCmd;
+
+/* Pass AVSFutureDone as the callback of a queued command, with a future as its user_data, to
+ * wait for the command later with AVSFutureWait or check done without waiting.
+ */
+typedef struct {
+	volatile bool done;
+	AVSStatus status;
+	uint16_t response;
+} AVSFuture;
+
 AVSStatus AVSReadVoltage(uint8_t rail_sel, uint16_t *voltage_in_mV);
 AVSStatus AVSWriteVoltage(uint16_t voltage_in_mV, uint8_t rail_sel);
 AVSStatus AVSReadVoutTransRate(uint8_t rail_sel, uint8_t *rise_rate, uint8_t *fall_rate);
@@ -36,4 +82,21 @@ AVSStatus AVSReadStatus(uint8_t rail_sel, uint16_t *status);
 AVSStatus AVSWriteStatus(uint16_t status, uint8_t rail_sel);
 AVSStatus AVSReadVersion(uint16_t *version);
 AVSStatus AVSReadSystemInputCurrent(uint16_t *response);
+
+/* Queued commands return without waiting for the regulator. A submission is sent back to back,
+ * e.g. a voltage write followed by current and temperature reads, and a voltage write returns
+ * before the rail has settled. Responses are collected, and the callbacks called, by AVSPoll,
+ * AVSFutureWait or before a synchronous command reads its own response. These return -EBUSY,
+ * without sending anything, when the AVS_MAX_PENDING_CMDS queue or the controller's command FIFO
+ * has no room for the submission.
+ */
+int AVSSubmit(const AVSCmd *cmds, uint8_t num_cmds);
+int AVSReadVoltageAsync(uint8_t rail_sel, AVSCallback cb, void *user_data);
+int AVSWriteVoltageAsync(uint16_t voltage_in_mV, uint8_t rail_sel, AVSCallback cb,
+			 void *user_data);
+int AVSReadCurrentAsync(uint8_t rail_sel, AVSCallback cb, void *user_data);
+void AVSFutureDone(AVSStatus status, uint16_t response, void *user_data);
+AVSStatus AVSFutureWait(AVSFuture *future, uint16_t *response);
+/* Returns the number of queued commands that are still waiting for a response */
+int AVSPoll(void);
 #endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "bulk_mailbox.h"
+#include "reg.h"
+#include "status_reg.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE),
+	     "bulk mailbox size is reported as log2");
+
+static uint8_t bulk_mailbox[CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE] __aligned(4);
+
+uint8_t *bulk_mailbox_region(uint32_t offset, uint32_t length)
+{
+	if (offset > sizeof(bulk_mailbox) || length > sizeof(bulk_mailbox) - offset) {
+		return NULL;
+	}
+
+	return &bulk_mailbox[offset];
+}
+
+uint32_t bulk_mailbox_checksum(const uint8_t *data, uint32_t length)
+{
+	return crc32_ieee(data, length);
+}
+
+int bulk_mailbox_get(uint32_t offset, uint32_t length, uint32_t checksum, uint8_t **data)
+{
+	uint8_t *region = bulk_mailbox_region(offset, length);
+
+	if (region == NULL) {
+		return -EINVAL;
+	}
+
+	if (bulk_mailbox_checksum(region, length) != checksum) {
+		return -EBADMSG;
+	}
+
+	*data = region;
+	return 0;
+}
+
+void bulk_mailbox_publish(void)
+{
+	/* Same encoding as SPI_BUFFER_INFO_REG_ADDR: log2(size) in the top byte, CSM offset below */
+	WriteReg(BULK_MAILBOX_INFO_REG_ADDR,
+		 ((uint32_t)LOG2(sizeof(bulk_mailbox)) << 24) | ((uint32_t)bulk_mailbox & 0xFFFFFF));
+}
+
+static uint8_t bulk_mailbox_handler(const union request *request, struct response *response)
+{
+	const struct bulk_mailbox_rqst *rqst = &request->bulk_mailbox;
+
+	switch (rqst->op) {
+	case BULK_MAILBOX_OP_INFO:
+		response->data[1] = (uint32_t)bulk_mailbox;
+		response->data[2] = sizeof(bulk_mailbox);
+		return 0;
+	case BULK_MAILBOX_OP_CHECKSUM: {
+		uint8_t *region = bulk_mailbox_region(rqst->xfer.offset, rqst->xfer.length);
+
+		if (region == NULL) {
+			return EINVAL;
+		}
+		response->data[1] = bulk_mailbox_checksum(region, rqst->xfer.length);
+		return 0;
+	}
+	default:
+		return EINVAL;
+	}
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_BULK_MAILBOX, bulk_mailbox_handler);
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BULK_MAILBOX_H
+#define BULK_MAILBOX_H
+
+#include <stdint.h>
+
+/* The bulk mailbox is a host visible CSM buffer for message payloads that do not fit in the
+ * eight request and response words. A message that opts in passes an offset and length into the
+ * mailbox and, for host to ARC payloads, a CRC-32 (IEEE) of the payload. ARC to host payloads
+ * return their CRC-32 in the response.
+ */
+
+/* Returns the mailbox region [offset, offset + length), or NULL if it is out of bounds. */
+uint8_t *bulk_mailbox_region(uint32_t offset, uint32_t length);
+
+/* CRC-32 (IEEE) of a payload */
+uint32_t bulk_mailbox_checksum(const uint8_t *data, uint32_t length);
+
+/* Look up a host supplied payload and check its CRC-32.
+ * Returns 0 and sets *data on success, -EINVAL if out of bounds or -EBADMSG on a checksum
+ * mismatch.
+ */
+int bulk_mailbox_get(uint32_t offset, uint32_t length, uint32_t checksum, uint8_t **data);
+
+/* Publish the mailbox address and size in BULK_MAILBOX_INFO_REG_ADDR */
+void bulk_mailbox_publish(void);
+
+#endif
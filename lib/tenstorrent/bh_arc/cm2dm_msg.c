@@ -19,6 +19,7 @@
 #include <zephyr/sys/crc.h>
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/msgqueue.h>
+#include <tenstorrent/tt_smbus_regs.h>
 
 #include "cm2dm_msg.h"
 #include "asic_state.h"
@@ -375,6 +376,79 @@ int32_t SMBusTelemDataHandler(uint8_t *data, uint8_t *size)
 	return 0;
 }
 
+/* One 32 bit value per tag, within both the SMBus block limit and the target buffers */
+#define TELEM_BLOCK_MAX_TAGS (MIN(CONFIG_SMBUS_MAX_MSG_SIZE, UINT8_MAX) / sizeof(uint32_t))
+#define TELEM_BLOCK_MAX_BITMAP 8
+
+static uint16_t telem_block_tags[TELEM_BLOCK_MAX_TAGS];
+static uint32_t telem_block_values[TELEM_BLOCK_MAX_TAGS];
+static uint8_t telem_block_count;
+
+int32_t SMBusTelemBlockSelectHandler(const uint8_t *data, uint8_t size)
+{
+	uint8_t count = 0;
+
+	telem_block_count = 0;
+
+	if (size < 3) {
+		return -1;
+	}
+
+	switch (data[0]) {
+	case CMFW_SMBUS_TELEM_BLOCK_RANGE:
+		if (size != 3 || data[2] == 0 || data[2] > TELEM_BLOCK_MAX_TAGS) {
+			return -1;
+		}
+		for (; count < data[2]; count++) {
+			telem_block_tags[count] = data[1] + count;
+		}
+		break;
+	case CMFW_SMBUS_TELEM_BLOCK_BITMAP:
+		if (size > 2 + TELEM_BLOCK_MAX_BITMAP) {
+			return -1;
+		}
+		for (uint16_t bit = 0; bit < (size - 2) * 8; bit++) {
+			if (!(data[2 + bit / 8] & BIT(bit % 8))) {
+				continue;
+			}
+			if (count == TELEM_BLOCK_MAX_TAGS) {
+				return -1;
+			}
+			telem_block_tags[count++] = data[1] + bit;
+		}
+		if (count == 0) {
+			return -1;
+		}
+		break;
+	default:
+		return -1;
+	}
+
+	/* Reject the whole selection rather than return values the host cannot tell apart */
+	if (!GetTelemetryTagValid(telem_block_tags[count - 1])) {
+		return -1;
+	}
+
+	telem_block_count = count;
+	return 0;
+}
+
+int32_t SMBusTelemBlockDataHandler(uint8_t *data, uint8_t *size)
+{
+	if (telem_block_count == 0) {
+		return -1;
+	}
+
+	GetTelemetryTags(telem_block_tags, telem_block_values, telem_block_count);
+	for (uint8_t i = 0; i < telem_block_count; i++) {
+		sys_put_le32(telem_block_values[i], &data[i * sizeof(uint32_t)]);
+	}
+
+	*size = telem_block_count * sizeof(uint32_t);
+	telem_block_count = 0;
+	return 0;
+}
+
 int32_t Dm2CmSendThermTripCountHandler(const uint8_t *data, uint8_t size)
 {
 	if (size != 2) {
@@ -31,6 +31,8 @@ uint16_t GetInputPower(void);
 int32_t Dm2CmSendFanRPMHandler(const uint8_t *data, uint8_t size);
 int32_t SMBusTelemRegHandler(const uint8_t *data, uint8_t size);
 int32_t SMBusTelemDataHandler(uint8_t *data, uint8_t *size);
+int32_t SMBusTelemBlockSelectHandler(const uint8_t *data, uint8_t size);
+int32_t SMBusTelemBlockDataHandler(uint8_t *data, uint8_t *size);
 int32_t Dm2CmSendThermTripCountHandler(const uint8_t *data, uint8_t size);
 int32_t Dm2CmWriteTelemetry(const uint8_t *data, uint8_t size);
 int32_t Dm2CmReadControlData(uint8_t *data, uint8_t *size);
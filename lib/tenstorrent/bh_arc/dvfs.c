@@ -5,59 +5,229 @@
  */
 
 #include <zephyr/kernel.h>
+#include "adaptive_margin.h"
+#include "dvfs.h"
+#include "dvfs_recorder.h"
 #include "vf_curve.h"
 #include "throttler.h"
 #include "aiclk_ppm.h"
+#include "telemetry_internal.h"
+#include "cm2dm_msg.h"
+#include "timer.h"
 #include "voltage.h"
 
 bool dvfs_enabled;
 
+#define DVFS_PERIOD_REFCLK ((uint64_t)CONFIG_TT_BH_ARC_DVFS_PERIOD_US * WAIT_1US)
+
+static struct dvfs_stats dvfs_stats = {.period_us = CONFIG_TT_BH_ARC_DVFS_PERIOD_US};
+/* Refclk timestamp at which the next periodic tick is scheduled. Ticks are due every
+ * DVFS_PERIOD_REFCLK from here until the timer is restarted.
+ */
+static uint64_t dvfs_due;
+/* Protects dvfs_stats and dvfs_due */
+static struct k_spinlock dvfs_stats_lock;
+
+static void UpdateAiclkVoltage(void)
+{
+	VoltageArbRequest(VoltageReqAiclk, GetAiclkVoltage());
+	CalculateTargVoltage();
+	VoltageChange();
+}
+
+static void record_dvfs_decisions(void)
+{
+	struct dvfs_record rec = {
+		.timestamp_us = TimerTimestamp() / WAIT_1US,
+		.input_power = GetInputPower(),
+		.targ_freq = GetAiclkTarg(),
+		.curr_freq = GetAiclkCurr(),
+		.voltage = voltage_arbiter.targ_voltage,
+		.limiter = GetAiclkLimiter(),
+	};
+	TelemetryInternalData telemetry_internal_data;
+
+	/* The sample the throttlers acted on, not whatever telemetry has read since */
+	GetThrottlerTelemetry(&telemetry_internal_data);
+	rec.vcore_power = telemetry_internal_data.vcore_power;
+	rec.vcore_current = telemetry_internal_data.vcore_current;
+	rec.asic_temperature = telemetry_internal_data.asic_temperature;
+
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		rec.throttler_output[i] = GetThrottlerOutput(i);
+	}
+	GetAiclkArbiters(rec.arb_max, rec.arb_min);
+
+	DVFSRecorderAdd(&rec);
+}
+
+/* Runs on the DVFS thread. It is not reentrant, so other threads that need a change applied at
+ * once ask for a tick with DVFSTickNow() rather than calling it.
+ */
 void DVFSChange(void)
 {
+	/* The highest AICLK reachable at vdd_max moves with the VF tables. Taking it here keeps it
+	 * in step with the tables this tick looks up, however they were republished since.
+	 */
+	InitArbMaxVoltage();
 	CalculateThrottlers();
 	CalculateTargAiclk();
 
-	uint32_t targ_freq = GetAiclkTarg();
-	uint32_t aiclk_voltage = VFCurve(targ_freq);
+	/* AICLK ramps asynchronously. Retargeting a ramp in flight first means AICLK only falls
+	 * from here on, so the voltage chosen for it afterwards stays sufficient.
+	 */
+	DecreaseAiclk();
+	UpdateAiclkVoltage();
+	IncreaseAiclk();
 
-	VoltageArbRequest(VoltageReqAiclk, aiclk_voltage);
+	if (IS_ENABLED(CONFIG_TT_BH_ARC_DVFS_RECORDER)) {
+		record_dvfs_decisions();
+	}
+}
 
-	CalculateTargVoltage();
+/* Wakes the DVFS thread, for a tick or an AICLK ramp step */
+static K_SEM_DEFINE(dvfs_sem, 0, 1);
+static atomic_t dvfs_tick_pending;
+/* An off-schedule tick from DVFSTickNow(), kept out of the tick statistics */
+static atomic_t dvfs_tick_now;
+static atomic_t dvfs_ramp_step;
 
-	DecreaseAiclk();
-	VoltageChange();
-	IncreaseAiclk();
+static void dvfs_timer_handler(struct k_timer *timer)
+{
+	atomic_set(&dvfs_tick_pending, 1);
+	k_sem_give(&dvfs_sem);
 }
+static K_TIMER_DEFINE(dvfs_timer, dvfs_timer_handler, NULL);
 
-static void dvfs_work_handler(struct k_work *work)
+/**
+ * @brief Move an AICLK ramp in flight one step on the DVFS thread
+ *
+ * May be called from ISR. When the step ends the ramp, VCORE is lowered to what the new AICLK
+ * needs without waiting for the next tick.
+ */
+void DVFSRampStep(void)
 {
-	DVFSChange();
+	atomic_set(&dvfs_ramp_step, 1);
+	k_sem_give(&dvfs_sem);
 }
-static K_WORK_DEFINE(dvfs_worker, dvfs_work_handler);
 
-static void dvfs_timer_handler(struct k_timer *timer)
+/**
+ * @brief Run a DVFS tick now rather than at the next timer expiry
+ *
+ * May be called from ISR. Does nothing unless DVFS is enabled. The periodic ticks carry on as
+ * before, and this tick is not counted in the DVFS statistics.
+ */
+void DVFSTickNow(void)
 {
-	k_work_submit(&dvfs_worker);
+	if (!dvfs_enabled) {
+		return;
+	}
+
+	atomic_set(&dvfs_tick_now, 1);
+	k_sem_give(&dvfs_sem);
 }
-static K_TIMER_DEFINE(dvfs_timer, dvfs_timer_handler, NULL);
+
+/* A tick serves the latest scheduled time at or before its start. Scheduled times it passed over
+ * without running are missed, and its lateness is measured from the time it serves, so a stall
+ * is counted once however many periods it lasts.
+ */
+static void record_dvfs_tick(uint64_t start, uint64_t end)
+{
+	k_spinlock_key_t key = k_spin_lock(&dvfs_stats_lock);
+	uint32_t late_us = 0;
+	uint32_t exec_us = (end - start) / WAIT_1US;
+
+	/* Well before the schedule, this is a tick left over from before the timer was
+	 * restarted and it does not serve any scheduled time.
+	 */
+	if (start + DVFS_PERIOD_REFCLK / 2 >= dvfs_due) {
+		uint64_t elapsed = start > dvfs_due ? start - dvfs_due : 0;
+		uint64_t skipped = elapsed / DVFS_PERIOD_REFCLK;
+
+		late_us = (elapsed - skipped * DVFS_PERIOD_REFCLK) / WAIT_1US;
+		dvfs_stats.missed += skipped;
+		dvfs_due += (skipped + 1) * DVFS_PERIOD_REFCLK;
+	}
+
+	dvfs_stats.ticks++;
+	dvfs_stats.exec_last_us = exec_us;
+	dvfs_stats.exec_max_us = MAX(dvfs_stats.exec_max_us, exec_us);
+	dvfs_stats.exec_total_us += exec_us;
+	dvfs_stats.late_last_us = late_us;
+	dvfs_stats.late_max_us = MAX(dvfs_stats.late_max_us, late_us);
+	dvfs_stats.late_total_us += late_us;
+
+	k_spin_unlock(&dvfs_stats_lock, key);
+}
+
+static void dvfs_thread_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_sem_take(&dvfs_sem, K_FOREVER);
+
+		bool ramp_done = atomic_clear(&dvfs_ramp_step) && AiclkRampStep() && dvfs_enabled;
+		/* A periodic tick due at the same time serves both */
+		bool tick_now = atomic_clear(&dvfs_tick_now);
+
+		if (atomic_clear(&dvfs_tick_pending)) {
+			uint64_t start = TimerTimestamp();
+
+			DVFSChange();
+			record_dvfs_tick(start, TimerTimestamp());
+		} else if (tick_now) {
+			DVFSChange();
+		} else if (ramp_done) {
+			UpdateAiclkVoltage();
+		}
+	}
+}
+
+K_THREAD_DEFINE(dvfs_thread, CONFIG_TT_BH_ARC_DVFS_THREAD_STACK_SIZE, dvfs_thread_entry, NULL,
+		NULL, NULL, CONFIG_TT_BH_ARC_DVFS_THREAD_PRIORITY, 0, 0);
 
 void InitDVFS(void)
 {
-	InitVFCurve();
+	/* The VF curve is checked against the voltage limits */
 	InitVoltagePPM();
+	InitVFCurve();
 	InitArbMaxVoltage();
 	InitThrottlers();
 	dvfs_enabled = true;
+
+	if (IS_ENABLED(CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN)) {
+		InitAdaptiveMargin();
+	}
 }
 
-#define DVFS_MSEC 1
+#define DVFS_PERIOD K_USEC(CONFIG_TT_BH_ARC_DVFS_PERIOD_US)
+
+/* Restart the tick schedule, with the first tick after delay */
+static void start_dvfs_timer(k_timeout_t delay)
+{
+	k_spinlock_key_t key = k_spin_lock(&dvfs_stats_lock);
+
+	dvfs_due = TimerTimestamp() + k_ticks_to_us_floor64(delay.ticks) * WAIT_1US;
+	k_timer_start(&dvfs_timer, delay, DVFS_PERIOD);
+
+	k_spin_unlock(&dvfs_stats_lock, key);
+}
 
 void StartDVFSTimer(void)
 {
-	k_timer_start(&dvfs_timer, K_MSEC(DVFS_MSEC), K_MSEC(DVFS_MSEC));
+	start_dvfs_timer(DVFS_PERIOD);
 }
 
-#define DVFS_TICKS (CONFIG_SYS_CLOCK_TICKS_PER_SEC * DVFS_MSEC / MSEC_PER_SEC)
+void StopDVFSTimer(void)
+{
+	k_timer_stop(&dvfs_timer);
+}
+
+#define DVFS_TICKS                                                                                 \
+	((int64_t)CONFIG_SYS_CLOCK_TICKS_PER_SEC * CONFIG_TT_BH_ARC_DVFS_PERIOD_US / USEC_PER_SEC)
 
 /* If DVFS is already scheduled "close enough" to the board power message, then don't try to adjust
  * it. There may be some jitter in the message arrival and we don't want to suddenly go from being
@@ -65,7 +235,7 @@ void StartDVFSTimer(void)
  */
 #define DVFS_ADJUSTMENT_THRESHOLD (DVFS_TICKS * 10 / 100) /* 10% of DVFS interval */
 
-/* DVFS's PID controllers assume they are run on a 1ms interval. Changing the interval implicitly
+/* DVFS's PID controllers assume they are run on a fixed interval. Changing the interval implicitly
  * changes their behaviour. 1% should be small enough to not cause trouble.
  */
 #define DVFS_ADJUSTMENT_STEP (DVFS_TICKS * 1 / 100) /* 1% of DVFS interval */
@@ -80,9 +250,25 @@ void AdjustDVFSTimer(void)
 		k_ticks_t dvfs_remaining = k_timer_remaining_ticks(&dvfs_timer);
 
 		if (dvfs_remaining > DVFS_ADJUSTMENT_THRESHOLD) {
-			k_timeout_t delay = K_TICKS(dvfs_remaining - DVFS_ADJUSTMENT_STEP);
-
-			k_timer_start(&dvfs_timer, delay, K_MSEC(DVFS_MSEC));
+			start_dvfs_timer(K_TICKS(dvfs_remaining - DVFS_ADJUSTMENT_STEP));
 		}
 	}
 }
+
+void GetDVFSStats(struct dvfs_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&dvfs_stats_lock);
+
+	*stats = dvfs_stats;
+
+	k_spin_unlock(&dvfs_stats_lock, key);
+}
+
+void ResetDVFSStats(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&dvfs_stats_lock);
+
+	dvfs_stats = (struct dvfs_stats){.period_us = CONFIG_TT_BH_ARC_DVFS_PERIOD_US};
+
+	k_spin_unlock(&dvfs_stats_lock, key);
+}
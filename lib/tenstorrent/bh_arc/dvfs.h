@@ -7,12 +7,30 @@
 #define DVFS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 extern bool dvfs_enabled;
 
+struct dvfs_stats {
+	uint32_t period_us;
+	uint32_t ticks;
+	uint32_t missed; /* scheduled ticks that never ran because an earlier one was late */
+	uint32_t exec_last_us;
+	uint32_t exec_max_us;
+	uint64_t exec_total_us;
+	uint32_t late_last_us; /* from the scheduled time to the start of the tick */
+	uint32_t late_max_us;
+	uint64_t late_total_us;
+};
+
 void InitDVFS(void);
 void StartDVFSTimer(void);
+void StopDVFSTimer(void);
 void AdjustDVFSTimer(void);
 void DVFSChange(void);
+void DVFSRampStep(void);
+void DVFSTickNow(void);
+void GetDVFSStats(struct dvfs_stats *stats);
+void ResetDVFSStats(void);
 
 #endif
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "bulk_mailbox.h"
+#include "cat.h"
+#include "dvfs_recorder.h"
+
+#define ENTRIES      CONFIG_TT_BH_ARC_DVFS_RECORDER_ENTRIES
+#define POST_TRIGGER CONFIG_TT_BH_ARC_DVFS_RECORDER_POST_TRIGGER
+
+BUILD_ASSERT(POST_TRIGGER < ENTRIES, "the triggering tick must survive the ticks after it");
+
+static struct dvfs_record records[ENTRIES];
+static struct dvfs_recorder_status recorder;
+
+/* Ticks are added by the DVFS thread while the host reads and triggers from message handlers */
+static struct k_spinlock recorder_lock;
+
+static void trigger(enum dvfs_recorder_trigger reason)
+{
+	if (recorder.state == DVFS_RECORDER_RECORDING) {
+		recorder.state = DVFS_RECORDER_TRIGGERED;
+		recorder.trigger = reason;
+		recorder.trigger_tick = recorder.count;
+	}
+
+	/* The host asks for what has been recorded so far */
+	if (reason == DVFS_RECORDER_TRIGGER_HOST) {
+		recorder.state = DVFS_RECORDER_FROZEN;
+	}
+}
+
+/**
+ * @brief Record a DVFS tick
+ *
+ * Ignored while the recorder is frozen. A tick with the ASIC temperature within
+ * CONFIG_TT_BH_ARC_DVFS_RECORDER_THERMAL_MARGIN of thermal shutdown triggers the recorder, as
+ * the shutdown itself resets the chip before anything could be read.
+ */
+void DVFSRecorderAdd(const struct dvfs_record *rec)
+{
+	K_SPINLOCK(&recorder_lock) {
+		if (recorder.state == DVFS_RECORDER_FROZEN) {
+			K_SPINLOCK_BREAK;
+		}
+
+		if (rec->asic_temperature >=
+		    T_J_SHUTDOWN - CONFIG_TT_BH_ARC_DVFS_RECORDER_THERMAL_MARGIN) {
+			trigger(DVFS_RECORDER_TRIGGER_THERMAL);
+		}
+
+		records[recorder.count % ENTRIES] = *rec;
+		recorder.count++;
+
+		if (recorder.state == DVFS_RECORDER_TRIGGERED &&
+		    recorder.count > recorder.trigger_tick + POST_TRIGGER) {
+			recorder.state = DVFS_RECORDER_FROZEN;
+		}
+	}
+}
+
+/**
+ * @brief Trigger the recorder
+ *
+ * Only the first trigger after the recorder was armed is reported. The recorder freezes once the
+ * tick being calculated and CONFIG_TT_BH_ARC_DVFS_RECORDER_POST_TRIGGER more are recorded. A
+ * host trigger freezes it at once.
+ */
+void DVFSRecorderTrigger(enum dvfs_recorder_trigger reason)
+{
+	K_SPINLOCK(&recorder_lock) {
+		trigger(reason);
+	}
+}
+
+/* Discard the recording and record from scratch until the next trigger */
+void DVFSRecorderArm(void)
+{
+	K_SPINLOCK(&recorder_lock) {
+		recorder = (struct dvfs_recorder_status){0};
+	}
+}
+
+void GetDVFSRecorderStatus(struct dvfs_recorder_status *status)
+{
+	K_SPINLOCK(&recorder_lock) {
+		*status = recorder;
+	}
+}
+
+/**
+ * @brief Read a recorded tick
+ *
+ * @param index Tick to read, counted from the first tick since the recorder was armed
+ * @param rec Filled with the tick
+ * @return 0 on success, -ENOENT if the tick was not recorded or has been overwritten
+ */
+int GetDVFSRecord(uint32_t index, struct dvfs_record *rec)
+{
+	int ret = -ENOENT;
+
+	K_SPINLOCK(&recorder_lock) {
+		if (index < recorder.count && recorder.count - index <= ENTRIES) {
+			*rec = records[index % ENTRIES];
+			ret = 0;
+		}
+	}
+
+	return ret;
+}
+
+enum dvfs_recorder_op {
+	DVFS_RECORDER_OP_STATUS = 0,
+	DVFS_RECORDER_OP_READ = 1,
+	DVFS_RECORDER_OP_FREEZE = 2,
+	DVFS_RECORDER_OP_ARM = 3,
+};
+
+static uint8_t read_records(const struct dvfs_recorder_rqst *rqst, struct response *response)
+{
+	uint32_t length = rqst->num_records * sizeof(struct dvfs_record);
+	uint8_t *buf = bulk_mailbox_region(rqst->offset, length);
+	struct dvfs_record rec;
+
+	if (buf == NULL) {
+		return EINVAL;
+	}
+
+	for (uint32_t i = 0; i < rqst->num_records; i++) {
+		if (GetDVFSRecord(rqst->first + i, &rec) != 0) {
+			return ENOENT;
+		}
+		memcpy(buf + i * sizeof(rec), &rec, sizeof(rec));
+	}
+
+	response->data[1] = bulk_mailbox_checksum(buf, length);
+
+	return 0;
+}
+
+static uint8_t dvfs_recorder_handler(const union request *request, struct response *response)
+{
+	const struct dvfs_recorder_rqst *rqst = &request->dvfs_recorder;
+	struct dvfs_recorder_status status;
+
+	switch (rqst->op) {
+	case DVFS_RECORDER_OP_STATUS:
+		break;
+	case DVFS_RECORDER_OP_READ:
+		return read_records(rqst, response);
+	case DVFS_RECORDER_OP_FREEZE:
+		DVFSRecorderTrigger(DVFS_RECORDER_TRIGGER_HOST);
+		break;
+	case DVFS_RECORDER_OP_ARM:
+		DVFSRecorderArm();
+		break;
+	default:
+		return EINVAL;
+	}
+
+	GetDVFSRecorderStatus(&status);
+	response->data[1] = status.state | (status.trigger << 8) |
+			    ((uint32_t)sizeof(struct dvfs_record) << 16);
+	response->data[2] = status.count;
+	response->data[3] = status.trigger_tick;
+	response->data[4] = ENTRIES;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_DVFS_RECORDER, dvfs_recorder_handler);
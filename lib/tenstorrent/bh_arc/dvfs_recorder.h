@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DVFS_RECORDER_H
+#define DVFS_RECORDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "aiclk_ppm.h"
+#include "throttler.h"
+
+/* The DVFS recorder keeps the inputs and decisions of the latest DVFS ticks in a ring. A trigger
+ * lets it record a few more ticks, so the response to the trigger is kept too, then freezes it
+ * until the host has read it and rearms it with TT_SMC_MSG_DVFS_RECORDER.
+ */
+
+enum dvfs_recorder_state {
+	DVFS_RECORDER_RECORDING = 0,
+	DVFS_RECORDER_TRIGGERED = 1, /* recording the ticks after the trigger */
+	DVFS_RECORDER_FROZEN = 2,
+};
+
+enum dvfs_recorder_trigger {
+	DVFS_RECORDER_TRIGGER_NONE = 0,
+	DVFS_RECORDER_TRIGGER_DOPPLER_T2 = 1,
+	DVFS_RECORDER_TRIGGER_DOPPLER_T3 = 2,
+	DVFS_RECORDER_TRIGGER_THERMAL = 3, /* ASIC temperature close to thermal shutdown */
+	DVFS_RECORDER_TRIGGER_HOST = 4,
+	DVFS_RECORDER_TRIGGER_THM_ALARM = 5, /* PVT temperature alarm, see TT_BH_ARC_THM_ALARM */
+};
+
+/* One DVFS tick. The layout is what the host reads, so fields are only ever added at the end. */
+struct dvfs_record {
+	uint32_t timestamp_us; /* refclk time of the tick */
+	float vcore_power;     /* W */
+	float vcore_current;   /* A */
+	float asic_temperature;
+	float throttler_output[kThrottlerCount];
+	uint16_t input_power;                /* W */
+	uint16_t arb_max[kAiclkArbMaxCount]; /* MHz, 0 if disabled */
+	uint16_t arb_min[kAiclkArbMinCount]; /* MHz, 0 if disabled */
+	uint16_t targ_freq;                  /* MHz */
+	uint16_t curr_freq;                  /* MHz, where the AICLK ramp has got to */
+	uint16_t voltage;                    /* mV, VCORE target */
+	uint8_t limiter;                     /* AICLK_LIMITER_* that set targ_freq */
+	uint8_t pad;
+};
+
+struct dvfs_recorder_status {
+	uint8_t state;         /* enum dvfs_recorder_state */
+	uint8_t trigger;       /* enum dvfs_recorder_trigger */
+	uint32_t count;        /* ticks recorded since the recorder was last armed */
+	uint32_t trigger_tick; /* count when the trigger happened */
+};
+
+void DVFSRecorderAdd(const struct dvfs_record *rec);
+void DVFSRecorderTrigger(enum dvfs_recorder_trigger trigger);
+void DVFSRecorderArm(void);
+void GetDVFSRecorderStatus(struct dvfs_recorder_status *status);
+int GetDVFSRecord(uint32_t index, struct dvfs_record *rec);
+
+#endif
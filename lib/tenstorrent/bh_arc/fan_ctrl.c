@@ -44,6 +44,14 @@ static float alpha = CONFIG_TT_BH_ARC_FAN_CTRL_ALPHA / 100.0f;
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
+#if defined(CONFIG_TT_BH_ARC_FAN_CTRL_ASIC_TEMP_MAX)
+#define FAN_ASIC_TEMP ASIC_TEMP_MAX
+#elif defined(CONFIG_TT_BH_ARC_FAN_CTRL_ASIC_TEMP_WEIGHTED_MAX)
+#define FAN_ASIC_TEMP ASIC_TEMP_WEIGHTED_MAX
+#else
+#define FAN_ASIC_TEMP ASIC_TEMP_MEAN
+#endif
+
 STATIC uint32_t fan_curve(float max_asic_temp, float max_gddr_temp)
 {
 	/* P150 fan curve: could be a part of device tree once added to the driver model */
@@ -81,8 +89,8 @@ static void update_fan_speed(void)
 	 * up-to-date.
 	 */
 	ReadTelemetryInternal(1, &telemetry_internal_data);
-	max_asic_temp =
-		alpha * telemetry_internal_data.asic_temperature + (1 - alpha) * max_asic_temp;
+	max_asic_temp = alpha * GetAsicTemperature(&telemetry_internal_data, FAN_ASIC_TEMP) +
+			(1 - alpha) * max_asic_temp;
 
 	if (IS_ENABLED(CONFIG_TT_BH_ARC_FAN_CTRL_GDDR_TEMP)) {
 		max_gddr_temp = alpha * GetMaxGDDRTemp() + (1 - alpha) * max_gddr_temp;
@@ -130,7 +138,7 @@ void init_fan_ctrl(void)
 	TelemetryInternalData telemetry_internal_data;
 
 	ReadTelemetryInternal(1, &telemetry_internal_data);
-	max_asic_temp = telemetry_internal_data.asic_temperature;
+	max_asic_temp = GetAsicTemperature(&telemetry_internal_data, FAN_ASIC_TEMP);
 
 	/* start a periodic timer that expires once every fan_ctrl_update_interval */
 	k_timer_start(&fan_ctrl_update_timer, K_MSEC(fan_ctrl_update_interval),
@@ -108,10 +108,15 @@ int read_gddr_telemetry_table(uint8_t gddr_inst, gddr_telemetry_table_t *gddr_te
 	if (dma_arc_hs_transfer(arc_dma_dev, 0,
 				(const void *)(mrisc_l1 + GDDR_TELEMETRY_TABLE_ADDR),
 				gddr_telemetry, sizeof(*gddr_telemetry), K_MSEC(500)) < 0) {
-		/* If DMA failed, can read 32b at a time via NOC2AXI */
+		/* If DMA failed, read 32b at a time via NOC2AXI. Map the window once for the
+		 * whole table rather than once per word, in case it was reused while waiting on
+		 * the DMA.
+		 */
+		SetupMriscL1Tlb(gddr_inst);
 		for (int i = 0; i < sizeof(*gddr_telemetry) / 4; i++) {
 			((uint32_t *)gddr_telemetry)[i] =
-				MriscL1Read32(gddr_inst, GDDR_TELEMETRY_TABLE_ADDR + i * 4);
+				NOC2AXIRead32(0, MRISC_SETUP_TLB,
+					      MRISC_L1_ADDR + GDDR_TELEMETRY_TABLE_ADDR + i * 4);
 		}
 	}
 	/* Check that version matches expectation. */
@@ -18,6 +18,9 @@
 #include "status_reg.h"
 #include "reg.h"
 #include "irqnum.h"
+#include "msgqueue_stats.h"
+#include "bulk_mailbox.h"
+#include "timer.h"
 
 #define MSGHANDLER_COMPAT_MASK 0x1
 
@@ -91,6 +94,52 @@ struct message_queue {
 /* All the message queues in the system. */
 static struct message_queue message_queues[NUM_MSG_QUEUES];
 
+/* ARC-private response bookkeeping. Response slots are reserved in request order and published
+ * to the host in that order, so a deferred response holds back later ones on the same queue.
+ */
+struct message_queue_responses {
+	/* Next response slot to hand out. Runs ahead of header.response_queue_wptr. */
+	uint32_t reserve_wptr;
+	/* Slots reserved but not yet written. */
+	bool pending[MSG_QUEUE_SIZE];
+	/* Responses written since the write pointer was last published. */
+	uint32_t unpublished;
+};
+
+static struct message_queue_responses message_queue_responses[NUM_MSG_QUEUES];
+static struct k_spinlock message_queue_response_lock;
+
+/* The message currently being run by a handler, so that the handler can defer its response. */
+static struct {
+	bool active;
+	bool deferred;
+	uint32_t msgqueue_id;
+	uint32_t response_ptr;
+} current_message;
+
+/* Refclk timestamp of the first doorbell since messages were last processed, 0 if none. */
+static uint64_t doorbell_timestamp;
+
+/* Doorbells received since messages were last processed. */
+static uint32_t pending_doorbells;
+
+/* Arrival time used for the queueing delay of messages in the current processing run. */
+static uint64_t message_arrival_timestamp;
+
+/* Scheduling parameters for each message queue. Lower priority values are serviced first. */
+struct message_queue_sched {
+	uint8_t priority;
+	uint8_t budget;
+};
+
+static struct message_queue_sched message_queue_sched[NUM_MSG_QUEUES] = {
+	{CONFIG_TT_BH_ARC_MSGQUEUE_0_PRIORITY, CONFIG_TT_BH_ARC_MSGQUEUE_BUDGET},
+	{CONFIG_TT_BH_ARC_MSGQUEUE_1_PRIORITY, CONFIG_TT_BH_ARC_MSGQUEUE_BUDGET},
+	{CONFIG_TT_BH_ARC_MSGQUEUE_2_PRIORITY, CONFIG_TT_BH_ARC_MSGQUEUE_BUDGET},
+	{CONFIG_TT_BH_ARC_MSGQUEUE_3_PRIORITY, CONFIG_TT_BH_ARC_MSGQUEUE_BUDGET},
+};
+BUILD_ASSERT(NUM_MSG_QUEUES == 4, "message_queue_sched initializer assumes 4 queues");
+
 /* All message handlers */
 static void *message_handlers[CONFIG_TT_BH_ARC_NUM_MSG_CODES];
 
@@ -161,10 +210,76 @@ int msgqueue_request_pop(uint32_t msgqueue_id, union request *request)
 	return 0;
 }
 
-int msgqueue_response_push(uint32_t msgqueue_id, const struct response *response)
+static uint32_t reserve_response(uint32_t msgqueue_id)
+{
+	struct message_queue_responses *responses = &message_queue_responses[msgqueue_id];
+	k_spinlock_key_t key = k_spin_lock(&message_queue_response_lock);
+	uint32_t ptr = responses->reserve_wptr;
+
+	responses->pending[ptr % MSG_QUEUE_SIZE] = true;
+	responses->reserve_wptr = (ptr + 1) % MSG_QUEUE_POINTER_WRAP;
+
+	k_spin_unlock(&message_queue_response_lock, key);
+
+	return ptr;
+}
+
+/* Advance the host-visible write pointer over every completed slot. Caller holds the lock. */
+static void publish_responses(struct message_queue *queue,
+			      struct message_queue_responses *responses)
+{
+	uint32_t wptr = queue->header.response_queue_wptr;
+
+	while (wptr != responses->reserve_wptr && !responses->pending[wptr % MSG_QUEUE_SIZE]) {
+		wptr = (wptr + 1) % MSG_QUEUE_POINTER_WRAP;
+	}
+
+	/* A single uncached pointer write covers every response completed so far. */
+	if (wptr != queue->header.response_queue_wptr) {
+		atomic_thread_fence(memory_order_release);
+		queue->header.response_queue_wptr = wptr;
+		msgqueue_stats_record_publish();
+	}
+	responses->unpublished = 0;
+}
+
+/* Write a response into its reserved slot. With publish false, the host-visible write pointer is
+ * left for a later publish_responses() so that a burst of responses costs one pointer update.
+ */
+static void commit_response(uint32_t msgqueue_id, uint32_t ptr, const struct response *response,
+			    bool publish)
 {
 	struct message_queue *queue = &message_queues[msgqueue_id];
+	struct message_queue_responses *responses = &message_queue_responses[msgqueue_id];
+	k_spinlock_key_t key = k_spin_lock(&message_queue_response_lock);
+
+	*response_entry(queue, ptr) = *response;
+	responses->pending[ptr % MSG_QUEUE_SIZE] = false;
+	responses->unpublished++;
+	if (publish || responses->unpublished >= CONFIG_TT_BH_ARC_MSGQUEUE_PUBLISH_BATCH) {
+		publish_responses(queue, responses);
+	}
+
+	k_spin_unlock(&message_queue_response_lock, key);
+}
 
+/* Publish whatever a budget slice left unpublished, so that a queue's responses never wait on
+ * work in other queues.
+ */
+static void flush_responses(uint32_t msgqueue_id)
+{
+	k_spinlock_key_t key = k_spin_lock(&message_queue_response_lock);
+
+	if (message_queue_responses[msgqueue_id].unpublished > 0) {
+		publish_responses(&message_queues[msgqueue_id],
+				  &message_queue_responses[msgqueue_id]);
+	}
+
+	k_spin_unlock(&message_queue_response_lock, key);
+}
+
+int msgqueue_response_push(uint32_t msgqueue_id, const struct response *response)
+{
 	if (msgqueue_id >= NUM_MSG_QUEUES) {
 		return -1;
 	}
@@ -173,10 +288,7 @@ int msgqueue_response_push(uint32_t msgqueue_id, const struct response *response
 		return -1;
 	}
 
-	*response_entry(queue, queue->header.response_queue_wptr) = *response;
-	atomic_thread_fence(memory_order_acquire);
-	queue->header.response_queue_wptr += 1;
-	queue->header.response_queue_wptr %= MSG_QUEUE_POINTER_WRAP;
+	commit_response(msgqueue_id, reserve_response(msgqueue_id), response, true);
 
 	return 0;
 }
@@ -215,7 +327,8 @@ static bool start_next_message(struct message_queue *queue, uint32_t *request_rp
 
 	/* Don't accept a request unless there's a response queue slot. */
 	/* We must not block and we don't want to hold onto the response. */
-	uint32_t response_wptr = queue->header.response_queue_wptr;
+	/* Slots held by deferred responses count as used. */
+	uint32_t response_wptr = message_queue_responses[queue - message_queues].reserve_wptr;
 	uint32_t response_rptr = queue->header.response_queue_rptr;
 
 	if ((response_wptr - response_rptr) % MSG_QUEUE_POINTER_WRAP == MSG_QUEUE_SIZE) {
@@ -307,25 +420,99 @@ static void process_queued_message(struct message_queue *queue, const union requ
 	}
 }
 
-/* Run all the outstanding messages in a single queue. */
-static void process_message_queue(struct message_queue *queue)
+/* Run up to budget outstanding messages in a single queue. Returns the number of messages run. */
+static uint32_t process_message_queue(struct message_queue *queue, uint32_t budget)
 {
-
 	uint32_t request_rptr;
 	uint32_t response_wptr;
+	uint32_t processed = 0;
+
+	uint32_t msgqueue_id = queue - message_queues;
 
-	while (start_next_message(queue, &request_rptr, &response_wptr)) {
+	while (processed < budget && start_next_message(queue, &request_rptr, &response_wptr)) {
 		union request request = (union request){0};
 		struct response response = (struct response){0};
 
-		msgqueue_request_pop(queue - message_queues, &request);
+		msgqueue_request_pop(msgqueue_id, &request);
+
+		current_message.msgqueue_id = msgqueue_id;
+		current_message.response_ptr = reserve_response(msgqueue_id);
+		current_message.deferred = false;
+		current_message.active = true;
+
+		uint64_t start = TimerTimestamp();
+
 		process_queued_message(queue, &request, &response);
-		msgqueue_response_push(queue - message_queues, &response);
+		msgqueue_stats_record(request.command_code, message_arrival_timestamp, start,
+				      TimerTimestamp());
+
+		current_message.active = false;
+		if (!current_message.deferred) {
+			/* Publish straight away once the queue is drained so that an isolated
+			 * request is not held back waiting for a batch to fill.
+			 */
+			bool drained = queue->header.request_queue_wptr ==
+				       queue->header.request_queue_rptr;
+
+			commit_response(msgqueue_id, current_message.response_ptr, &response,
+					drained);
+		}
 
 		advance_serial(queue, &request);
+		processed++;
+	}
+
+	if (processed > 0) {
+		flush_responses(msgqueue_id);
+	}
+
+	return processed;
+}
+
+/* Order queue indices by priority. Equal priorities keep their index order. */
+static void sort_queues_by_priority(uint8_t order[NUM_MSG_QUEUES])
+{
+	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
+		uint8_t id = i;
+		uint8_t priority = message_queue_sched[id].priority;
+		unsigned int j = i;
+
+		while (j > 0 && message_queue_sched[order[j - 1]].priority > priority) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = id;
 	}
 }
 
+/* Service the highest priority level that has pending messages, giving each queue at that level
+ * up to its budget. Returns the number of messages run, 0 once every queue is idle.
+ */
+static uint32_t process_message_queues_pass(const uint8_t order[NUM_MSG_QUEUES])
+{
+	unsigned int i = 0;
+
+	while (i < NUM_MSG_QUEUES) {
+		uint8_t priority = message_queue_sched[order[i]].priority;
+		uint32_t processed = 0;
+
+		for (; i < NUM_MSG_QUEUES && message_queue_sched[order[i]].priority == priority;
+		     i++) {
+			uint8_t id = order[i];
+			uint32_t budget = message_queue_sched[id].budget;
+
+			SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARG_MSG_QUEUE_START + id);
+			processed += process_message_queue(&message_queues[id], budget);
+		}
+
+		if (processed > 0) {
+			return processed;
+		}
+	}
+
+	return 0;
+}
+
 void clear_msg_irq(void)
 {
 #ifdef CONFIG_BOARD_TT_BLACKHOLE
@@ -339,14 +526,136 @@ void clear_msg_irq(void)
 /* Run all messages in all queues. */
 void process_message_queues(void)
 {
+	uint8_t order[NUM_MSG_QUEUES];
+	uint32_t processed = 0;
+	uint32_t pass_processed;
+	unsigned int key = irq_lock();
+	uint32_t doorbells = pending_doorbells;
+
+	message_arrival_timestamp = doorbell_timestamp != 0 ? doorbell_timestamp : TimerTimestamp();
+	doorbell_timestamp = 0;
+	pending_doorbells = 0;
+	irq_unlock(key);
+
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARC_MSG_HANDLE_START);
-	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
-		SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARG_MSG_QUEUE_START + i);
-		process_message_queue(&message_queues[i]);
-	}
+	/* After every budget slice, restart from the highest priority queue so that latency
+	 * sensitive queues wait for at most one slice of lower priority work.
+	 */
+	do {
+		sort_queues_by_priority(order);
+		pass_processed = process_message_queues_pass(order);
+		processed += pass_processed;
+	} while (pass_processed > 0);
+	msgqueue_stats_record_wakeup(doorbells, processed);
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARC_MSG_HANDLE_DONE);
 }
 
+int msgqueue_defer_response(struct msgqueue_deferred_response *token)
+{
+	if (token == NULL || !current_message.active || current_message.deferred) {
+		return -1;
+	}
+
+	current_message.deferred = true;
+	token->msgqueue_id = current_message.msgqueue_id;
+	token->response_ptr = current_message.response_ptr;
+
+	return 0;
+}
+
+int msgqueue_complete_deferred(const struct msgqueue_deferred_response *token,
+			       const struct response *response, uint8_t exit_code)
+{
+	if (token == NULL || response == NULL || token->msgqueue_id >= NUM_MSG_QUEUES ||
+	    token->response_ptr >= MSG_QUEUE_POINTER_WRAP) {
+		return -1;
+	}
+
+	struct message_queue *queue = &message_queues[token->msgqueue_id];
+	struct message_queue_responses *responses = &message_queue_responses[token->msgqueue_id];
+	k_spinlock_key_t key = k_spin_lock(&message_queue_response_lock);
+
+	/* The token must name a reserved, still unpublished slot. */
+	uint32_t outstanding = (responses->reserve_wptr - queue->header.response_queue_wptr) %
+			       MSG_QUEUE_POINTER_WRAP;
+	uint32_t offset = (token->response_ptr - queue->header.response_queue_wptr) %
+			  MSG_QUEUE_POINTER_WRAP;
+
+	if (offset >= outstanding || !responses->pending[token->response_ptr % MSG_QUEUE_SIZE]) {
+		k_spin_unlock(&message_queue_response_lock, key);
+		return -1;
+	}
+
+	struct response *entry = response_entry(queue, token->response_ptr);
+
+	*entry = *response;
+	entry->data[0] |= exit_code;
+	responses->pending[token->response_ptr % MSG_QUEUE_SIZE] = false;
+	responses->unpublished++;
+	publish_responses(queue, responses);
+
+	k_spin_unlock(&message_queue_response_lock, key);
+
+	return 0;
+}
+
+int msgqueue_set_priority(uint32_t msgqueue_id, uint8_t priority)
+{
+	if (msgqueue_id >= NUM_MSG_QUEUES) {
+		return -1;
+	}
+
+	message_queue_sched[msgqueue_id].priority = priority;
+	return 0;
+}
+
+int msgqueue_get_priority(uint32_t msgqueue_id)
+{
+	if (msgqueue_id >= NUM_MSG_QUEUES) {
+		return -1;
+	}
+
+	return message_queue_sched[msgqueue_id].priority;
+}
+
+int msgqueue_set_budget(uint32_t msgqueue_id, uint8_t budget)
+{
+	if (msgqueue_id >= NUM_MSG_QUEUES || budget == 0) {
+		return -1;
+	}
+
+	message_queue_sched[msgqueue_id].budget = budget;
+	return 0;
+}
+
+/** @brief Handles the message queue scheduling request
+ * @param[in] request The request, of type @ref msgqueue_sched_rqst, with command code
+ *	@ref TT_SMC_MSG_MSGQUEUE_SCHED
+ * @param[out] response The priority and budget of the queue in data[1] and data[2]
+ * @return 0 on success, 1 if the queue does not exist
+ */
+static uint8_t msgqueue_sched_handler(const union request *request, struct response *response)
+{
+	const struct msgqueue_sched_rqst *rqst = &request->msgqueue_sched;
+
+	if (rqst->msgqueue_id >= NUM_MSG_QUEUES) {
+		return 1;
+	}
+
+	/* The queues are re-sorted after every slice, so the change applies from the next one. */
+	if (rqst->budget != 0) {
+		msgqueue_set_priority(rqst->msgqueue_id, rqst->priority);
+		msgqueue_set_budget(rqst->msgqueue_id, rqst->budget);
+	}
+
+	response->data[1] = message_queue_sched[rqst->msgqueue_id].priority;
+	response->data[2] = message_queue_sched[rqst->msgqueue_id].budget;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_MSGQUEUE_SCHED, msgqueue_sched_handler);
+
 void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t handler)
 {
 	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
@@ -362,9 +671,11 @@ static void prepare_msg_queue(void)
 	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
 		memset(&message_queues[i].header, 0, sizeof(message_queues[i].header));
 	}
+	memset(message_queue_responses, 0, sizeof(message_queue_responses));
 
 	/* populate address of message queue info */
 	WriteReg(STATUS_MSG_Q_INFO_REG_ADDR, (uint32_t)message_queue_info);
+	bulk_mailbox_publish();
 }
 
 #ifndef MSG_QUEUE_TEST
@@ -380,18 +691,91 @@ SYS_INIT_APP(register_interrupt_handlers);
 #endif
 
 #ifdef CONFIG_BOARD_TT_BLACKHOLE
-static void msgqueue_work_handler(struct k_work *work)
+static K_SEM_DEFINE(msgqueue_sem, 0, 1);
+
+/* Set while the message queue thread is between waking up and going back to sleep. Doorbells in
+ * that window do not need to wake it, it rechecks pending_doorbells before sleeping.
+ */
+static bool msgqueue_busy;
+
+/* Refclk timestamp at which the message queue thread last went idle. */
+static uint64_t msgqueue_idle_timestamp;
+
+static void msgqueue_coalesce_expiry(struct k_timer *timer)
+{
+	msgqueue_stats_record_timer_wakeup();
+	k_sem_give(&msgqueue_sem);
+}
+
+static K_TIMER_DEFINE(msgqueue_coalesce_timer, msgqueue_coalesce_expiry, NULL);
+
+/* Called from doorbell ISRs */
+static void msgqueue_wake(void)
 {
-	process_message_queues();
+	uint64_t now = TimerTimestamp();
+	uint64_t coalesce = (uint64_t)CONFIG_TT_BH_ARC_MSGQUEUE_COALESCE_US * WAIT_1US;
+
+	if (doorbell_timestamp == 0) {
+		doorbell_timestamp = now;
+	}
+	pending_doorbells++;
+
+	if (msgqueue_busy) {
+		return;
+	}
+
+	/* An isolated doorbell, or enough of a burst, is serviced immediately. A doorbell that
+	 * follows closely behind the previous run waits briefly for the rest of the burst.
+	 */
+	if (coalesce == 0 || now - msgqueue_idle_timestamp >= coalesce ||
+	    pending_doorbells >= CONFIG_TT_BH_ARC_MSGQUEUE_COALESCE_COUNT) {
+		k_timer_stop(&msgqueue_coalesce_timer);
+		k_sem_give(&msgqueue_sem);
+	} else if (k_timer_remaining_ticks(&msgqueue_coalesce_timer) == 0) {
+		k_timer_start(&msgqueue_coalesce_timer,
+			      K_USEC(CONFIG_TT_BH_ARC_MSGQUEUE_COALESCE_US), K_NO_WAIT);
+	}
+}
+
+static void msgqueue_thread_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		bool again;
+
+		k_sem_take(&msgqueue_sem, K_FOREVER);
+
+		do {
+			unsigned int key = irq_lock();
+
+			msgqueue_busy = true;
+			irq_unlock(key);
+
+			process_message_queues();
+
+			key = irq_lock();
+			again = pending_doorbells > 0;
+			if (!again) {
+				msgqueue_busy = false;
+				msgqueue_idle_timestamp = TimerTimestamp();
+			}
+			irq_unlock(key);
+		} while (again);
+	}
 }
 
-static K_WORK_DEFINE(msgqueue_work, msgqueue_work_handler);
+K_THREAD_DEFINE(msgqueue_thread, CONFIG_TT_BH_ARC_MSGQUEUE_THREAD_STACK_SIZE,
+		msgqueue_thread_entry, NULL, NULL, NULL, CONFIG_TT_BH_ARC_MSGQUEUE_THREAD_PRIORITY,
+		0, 0);
 
 static void msgqueue_interrupt_handler(void *arg)
 {
 	(void)(arg);
 	clear_msg_irq();
-	k_work_submit(&msgqueue_work);
+	msgqueue_wake();
 }
 
 static bool msi_catcher_nonempty(void)
@@ -428,7 +812,7 @@ static void msgqueue_msi_interrupt_handler(void *arg)
 	}
 
 	if (msi_for_msgqueue) {
-		k_work_submit(&msgqueue_work);
+		msgqueue_wake();
 	}
 }
 
@@ -437,7 +821,7 @@ static void msgqueue_msi_overflow_handler(void *arg)
 	(void)(arg);
 
 	msi_catcher_flush();
-	k_work_submit(&msgqueue_work);
+	msgqueue_wake();
 }
 #endif
 
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "msgqueue_stats.h"
+#include "timer.h"
+
+#define MSG_STATS_PAGE_SUMMARY     0
+#define MSG_STATS_BUCKETS_PER_PAGE (RESPONSE_MSG_LEN - 1)
+#define MSG_STATS_PAGES_PER_HIST                                                                   \
+	DIV_ROUND_UP(MSGQUEUE_STATS_NUM_BUCKETS, MSG_STATS_BUCKETS_PER_PAGE)
+#define MSG_STATS_PAGE_WAKEUP      (2 * MSG_STATS_PAGES_PER_HIST + 1)
+#define MSG_STATS_PAGE_WAKEUP_HIST (MSG_STATS_PAGE_WAKEUP + 1)
+
+BUILD_ASSERT(MSGQUEUE_WAKEUP_NUM_BUCKETS <= MSG_STATS_BUCKETS_PER_PAGE);
+
+/* Stats slots are handed out on first use, since only a few message codes are ever used. */
+static struct msgqueue_stats stats[CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS];
+/* Slot index + 1 for each message code, 0 if none assigned. */
+static uint8_t stats_slot[CONFIG_TT_BH_ARC_NUM_MSG_CODES];
+static uint32_t slots_used;
+static uint32_t untracked;
+static struct msgqueue_wakeup_stats wakeup_stats;
+/* Recording runs on the message queue thread and in the coalescing timer ISR, while a reset can
+ * come from the shell thread. Readers take no lock and may see a partly updated slot.
+ */
+static struct k_spinlock stats_lock;
+
+BUILD_ASSERT(CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS < UINT8_MAX);
+
+static uint32_t refclk_to_ns(uint64_t cycles)
+{
+	uint64_t ns = cycles * NS_PER_REFCLK;
+
+	return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+static uint32_t bucket_of(uint32_t ns)
+{
+	uint32_t us = ns / 1000;
+
+	if (us == 0) {
+		return 0;
+	}
+
+	return MIN(32 - __builtin_clz(us), MSGQUEUE_STATS_NUM_BUCKETS - 1);
+}
+
+static struct msgqueue_stats *stats_for_code(uint32_t msg_code, bool allocate)
+{
+	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
+		return NULL;
+	}
+
+	if (stats_slot[msg_code] == 0) {
+		if (!allocate || slots_used == ARRAY_SIZE(stats)) {
+			return NULL;
+		}
+
+		struct msgqueue_stats *s = &stats[slots_used++];
+
+		memset(s, 0, sizeof(*s));
+		s->service_min_ns = UINT32_MAX;
+		stats_slot[msg_code] = slots_used;
+	}
+
+	return &stats[stats_slot[msg_code] - 1];
+}
+
+void msgqueue_stats_record(uint32_t msg_code, uint64_t arrival, uint64_t start, uint64_t end)
+{
+	uint32_t service_ns = refclk_to_ns(end - start);
+	uint32_t queue_ns = start > arrival ? refclk_to_ns(start - arrival) : 0;
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+	struct msgqueue_stats *s = stats_for_code(msg_code, true);
+
+	if (s == NULL) {
+		untracked++;
+		k_spin_unlock(&stats_lock, key);
+		return;
+	}
+
+	s->count++;
+	s->service_min_ns = MIN(s->service_min_ns, service_ns);
+	s->service_max_ns = MAX(s->service_max_ns, service_ns);
+	s->service_total_ns += service_ns;
+	s->queue_max_ns = MAX(s->queue_max_ns, queue_ns);
+	s->queue_total_ns += queue_ns;
+	s->service_hist[bucket_of(service_ns)]++;
+	s->queue_hist[bucket_of(queue_ns)]++;
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+const struct msgqueue_stats *msgqueue_stats_get(uint32_t msg_code)
+{
+	return stats_for_code(msg_code, false);
+}
+
+uint32_t msgqueue_stats_untracked(void)
+{
+	return untracked;
+}
+
+void msgqueue_stats_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	memset(stats_slot, 0, sizeof(stats_slot));
+	slots_used = 0;
+	untracked = 0;
+	memset(&wakeup_stats, 0, sizeof(wakeup_stats));
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+void msgqueue_stats_record_wakeup(uint32_t doorbells, uint32_t messages)
+{
+	uint32_t bucket = messages == 0 ? 0 : 32 - __builtin_clz(messages);
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	wakeup_stats.wakeups++;
+	wakeup_stats.doorbells += doorbells;
+	wakeup_stats.messages += messages;
+	wakeup_stats.max_messages = MAX(wakeup_stats.max_messages, messages);
+	wakeup_stats.hist[MIN(bucket, MSGQUEUE_WAKEUP_NUM_BUCKETS - 1)]++;
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+void msgqueue_stats_record_timer_wakeup(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	wakeup_stats.timer_wakeups++;
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+void msgqueue_stats_record_publish(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	wakeup_stats.publishes++;
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+const struct msgqueue_wakeup_stats *msgqueue_stats_get_wakeup(void)
+{
+	return &wakeup_stats;
+}
+
+/* Page 0 is the summary, the following pages hold the service time histogram and then the
+ * queueing delay histogram, RESPONSE_MSG_LEN - 1 buckets at a time. The last two pages are the
+ * wakeup counters and the messages per wakeup histogram, which do not depend on the message code.
+ */
+static uint8_t get_msg_stats_handler(const union request *request, struct response *response)
+{
+	const struct msg_stats_rqst *rqst = &request->msg_stats;
+	const struct msgqueue_stats *s = msgqueue_stats_get(rqst->msg_code);
+	uint32_t page = rqst->page;
+
+	if (page > MSG_STATS_PAGE_WAKEUP_HIST) {
+		return 1;
+	}
+
+	if (page == MSG_STATS_PAGE_WAKEUP) {
+		response->data[1] = wakeup_stats.wakeups;
+		response->data[2] = wakeup_stats.timer_wakeups;
+		response->data[3] = wakeup_stats.doorbells;
+		response->data[4] = wakeup_stats.messages;
+		response->data[5] = wakeup_stats.max_messages;
+		response->data[6] = wakeup_stats.publishes;
+	} else if (page == MSG_STATS_PAGE_WAKEUP_HIST) {
+		memcpy(&response->data[1], wakeup_stats.hist, sizeof(wakeup_stats.hist));
+	} else if (s == NULL) {
+		/* Never seen, report all zeros */
+	} else if (page == MSG_STATS_PAGE_SUMMARY) {
+		response->data[1] = s->count;
+		response->data[2] = s->count == 0 ? 0 : s->service_min_ns;
+		response->data[3] = s->service_max_ns;
+		response->data[4] = msgqueue_stats_mean_ns(s->service_total_ns, s->count);
+		response->data[5] = s->queue_max_ns;
+		response->data[6] = msgqueue_stats_mean_ns(s->queue_total_ns, s->count);
+		response->data[7] = msgqueue_stats_untracked();
+	} else {
+		const uint32_t *hist =
+			page <= MSG_STATS_PAGES_PER_HIST ? s->service_hist : s->queue_hist;
+		uint32_t first =
+			((page - 1) % MSG_STATS_PAGES_PER_HIST) * MSG_STATS_BUCKETS_PER_PAGE;
+		uint32_t n = MIN(MSG_STATS_BUCKETS_PER_PAGE, MSGQUEUE_STATS_NUM_BUCKETS - first);
+
+		memcpy(&response->data[1], &hist[first], n * sizeof(hist[0]));
+	}
+
+	if (rqst->reset) {
+		msgqueue_stats_reset();
+	}
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_GET_MSG_STATS, get_msg_stats_handler);
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef MSGQUEUE_STATS_H
+#define MSGQUEUE_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bucket 0 holds durations under 1 us, bucket n holds [2^(n-1), 2^n) us and the last bucket
+ * holds everything longer.
+ */
+#define MSGQUEUE_STATS_NUM_BUCKETS 16
+
+struct msgqueue_stats {
+	uint32_t count;
+	uint32_t service_min_ns;
+	uint32_t service_max_ns;
+	uint64_t service_total_ns;
+	uint32_t queue_max_ns;
+	uint64_t queue_total_ns;
+	uint32_t service_hist[MSGQUEUE_STATS_NUM_BUCKETS];
+	uint32_t queue_hist[MSGQUEUE_STATS_NUM_BUCKETS];
+};
+
+/* Bucket 0 counts wakeups that found no messages, bucket n counts [2^(n-1), 2^n) messages and the
+ * last bucket everything above.
+ */
+#define MSGQUEUE_WAKEUP_NUM_BUCKETS 7
+
+struct msgqueue_wakeup_stats {
+	uint32_t wakeups;
+	/* Wakeups triggered by the coalescing timer rather than directly by a doorbell */
+	uint32_t timer_wakeups;
+	uint32_t doorbells;
+	uint32_t messages;
+	uint32_t max_messages;
+	/* Host-visible response write pointer updates */
+	uint32_t publishes;
+	uint32_t hist[MSGQUEUE_WAKEUP_NUM_BUCKETS];
+};
+
+#ifdef CONFIG_TT_BH_ARC_MSGQUEUE_STATS
+/* Timestamps are TimerTimestamp() refclk counts. */
+void msgqueue_stats_record(uint32_t msg_code, uint64_t arrival, uint64_t start, uint64_t end);
+/* Returns NULL if the message code has not been seen or had no free stats slot. */
+const struct msgqueue_stats *msgqueue_stats_get(uint32_t msg_code);
+/* Number of messages whose code could not be given a stats slot. */
+uint32_t msgqueue_stats_untracked(void);
+void msgqueue_stats_reset(void);
+void msgqueue_stats_record_wakeup(uint32_t doorbells, uint32_t messages);
+void msgqueue_stats_record_timer_wakeup(void);
+void msgqueue_stats_record_publish(void);
+const struct msgqueue_wakeup_stats *msgqueue_stats_get_wakeup(void);
+#else
+static inline void msgqueue_stats_record(uint32_t msg_code, uint64_t arrival, uint64_t start,
+					 uint64_t end)
+{
+}
+
+static inline const struct msgqueue_stats *msgqueue_stats_get(uint32_t msg_code)
+{
+	return NULL;
+}
+
+static inline uint32_t msgqueue_stats_untracked(void)
+{
+	return 0;
+}
+
+static inline void msgqueue_stats_reset(void)
+{
+}
+
+static inline void msgqueue_stats_record_wakeup(uint32_t doorbells, uint32_t messages)
+{
+}
+
+static inline void msgqueue_stats_record_timer_wakeup(void)
+{
+}
+
+static inline void msgqueue_stats_record_publish(void)
+{
+}
+
+static inline const struct msgqueue_wakeup_stats *msgqueue_stats_get_wakeup(void)
+{
+	return NULL;
+}
+#endif
+
+static inline uint32_t msgqueue_stats_mean_ns(uint64_t total_ns, uint32_t count)
+{
+	return count == 0 ? 0 : (uint32_t)(total_ns / count);
+}
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PCIE_MSI_H
+#define PCIE_MSI_H
+
+#include <stdint.h>
+
+void SendPcieMsi(uint8_t pcie_inst, uint32_t vector_id);
+
+#endif
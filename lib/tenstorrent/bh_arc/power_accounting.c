@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+
+#include "power_accounting.h"
+
+/* Samples in each window */
+static const uint32_t window_samples[POWER_WINDOW_COUNT] = {1, 10, 100, 1000, 10000};
+
+/* Weight of a new sample in each exponential average */
+static const float ema_alpha[POWER_WINDOW_COUNT] = {1.0f, 0.1f, 0.01f, 0.001f, 0.0001f};
+
+BUILD_ASSERT(POWER_WINDOW_SLOTS == 10, "window_samples and ema_alpha are powers of 10");
+BUILD_ASSERT(10000 / POWER_WINDOW_SLOTS <= UINT16_MAX, "partial_count must hold a sub-window");
+
+void PowerAccountInit(struct power_account *acct)
+{
+	memset(acct, 0, sizeof(*acct));
+}
+
+void PowerAccountUpdate(struct power_account *acct, float sample)
+{
+	acct->latest = sample;
+
+	for (enum power_window w = POWER_WINDOW_10MS; w < POWER_WINDOW_COUNT; w++) {
+		struct power_box *box = &acct->box[w - 1];
+
+		box->partial += sample;
+		if (++box->partial_count < window_samples[w - 1]) {
+			continue;
+		}
+
+		box->slot[box->oldest] = box->partial;
+		box->oldest = (box->oldest + 1) % POWER_WINDOW_SLOTS;
+		box->partial = 0;
+		box->partial_count = 0;
+
+		/* Summed afresh rather than kept as a running sum, which would drift in float */
+		box->slot_sum = 0;
+		for (int i = 0; i < POWER_WINDOW_SLOTS; i++) {
+			box->slot_sum += box->slot[i];
+		}
+	}
+
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		acct->ema[w] += (sample - acct->ema[w]) * ema_alpha[w];
+	}
+}
+
+/* Box average over the latest window_samples[window] samples */
+float PowerAccountAverage(const struct power_account *acct, enum power_window window)
+{
+	if (window == POWER_WINDOW_1MS) {
+		return acct->latest;
+	}
+
+	const struct power_box *box = &acct->box[window - 1];
+
+	/* Only the part of the oldest sub-window that is still in the window counts, taking it to
+	 * have been drawn evenly.
+	 */
+	float oldest = box->slot[box->oldest] * box->partial_count / window_samples[window - 1];
+
+	return (box->slot_sum - oldest + box->partial) / window_samples[window];
+}
+
+float PowerAccountEma(const struct power_account *acct, enum power_window window)
+{
+	return acct->ema[window];
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef POWER_ACCOUNTING_H
+#define POWER_ACCOUNTING_H
+
+#include <stdint.h>
+
+/* Power accounting averages a power reading, sampled once per DVFS update, over several time
+ * scales. Each window is made of POWER_WINDOW_SLOTS sub-windows as long as the next shorter
+ * window, so a sample costs the same however long the windows are. The box average slides one
+ * sub-window at a time and prorates the oldest sub-window in between. Alongside each box there is
+ * an exponential average with a time constant of the window length.
+ *
+ * Window names assume the default 1 ms DVFS update period. Everything starts at 0 W, so averages
+ * are low until a whole window has been sampled.
+ */
+
+enum power_window {
+	POWER_WINDOW_1MS,
+	POWER_WINDOW_10MS,
+	POWER_WINDOW_100MS,
+	POWER_WINDOW_1S,
+	POWER_WINDOW_10S,
+	POWER_WINDOW_COUNT,
+};
+
+#define POWER_WINDOW_SLOTS 10
+
+struct power_box {
+	float slot[POWER_WINDOW_SLOTS]; /* sums of the latest complete sub-windows */
+	float slot_sum;
+	float partial;          /* sum of the samples in the sub-window being filled */
+	uint16_t partial_count; /* samples in partial */
+	uint8_t oldest;         /* slot that the next complete sub-window replaces */
+};
+
+struct power_account {
+	float latest;
+	struct power_box box[POWER_WINDOW_COUNT - 1]; /* POWER_WINDOW_10MS and longer */
+	float ema[POWER_WINDOW_COUNT];
+};
+
+void PowerAccountInit(struct power_account *acct);
+void PowerAccountUpdate(struct power_account *acct, float sample);
+float PowerAccountAverage(const struct power_account *acct, enum power_window window);
+float PowerAccountEma(const struct power_account *acct, enum power_window window);
+
+#endif
@@ -87,10 +87,11 @@ static uint8_t read_pd_handler(const union request *request, struct response *re
 
 	uint32_t delay_chain = request->data[1];
 
-	pvt_tt_bh_delay_chain_set(delay_chain);
-
+	/* Hold the chain for the read, and leave it selected for later reads */
+	pvt_tt_bh_delay_chain_lock(delay_chain);
 	ret = sensor_get_decoder(pvt, &decoder);
 	ret = sensor_read(&pd_iodev, &pvt_ctx, (uint8_t *)pd_buf, sizeof(pd_buf));
+	pvt_tt_bh_delay_chain_unlock(delay_chain);
 
 	uint32_t id = request->data[2];
 
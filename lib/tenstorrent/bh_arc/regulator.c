@@ -159,15 +159,59 @@ static float i2c_get_max20816(uint32_t slave_addr)
 	return vout_cmd * 0.5f;
 }
 
+/* Over AVSBus, VCORE writes are queued rather than waited for. The rail has settled once the
+ * newest write is done and vcore_settle_time has passed.
+ */
+static atomic_t vcore_writes_pending;
+static uint64_t vcore_settle_time;
+static struct k_spinlock vcore_settle_lock;
+
+static void vcore_write_done(AVSStatus status, uint16_t response, void *user_data)
+{
+	ARG_UNUSED(status);
+	ARG_UNUSED(response);
+	ARG_UNUSED(user_data);
+
+	K_SPINLOCK(&vcore_settle_lock) {
+		vcore_settle_time = TimerTimestamp() + AVS_VOLTAGE_SETTLE_US * WAIT_1US;
+	}
+	atomic_dec(&vcore_writes_pending);
+}
+
 void set_vcore(uint32_t voltage_in_mv)
 {
 	if (vout_cmd_source == AVSVoutCommand) {
-		AVSWriteVoltage(voltage_in_mv, AVS_VCORE_RAIL);
+		atomic_inc(&vcore_writes_pending);
+		if (AVSWriteVoltageAsync(voltage_in_mv, AVS_VCORE_RAIL, vcore_write_done, NULL) !=
+		    0) {
+			/* The queue is full, fall back to waiting for the rail */
+			atomic_dec(&vcore_writes_pending);
+			AVSWriteVoltage(voltage_in_mv, AVS_VCORE_RAIL);
+		}
 	} else {
 		i2c_set_max20816(P0V8_VCORE_ADDR, voltage_in_mv);
 	}
 }
 
+/* Returns true once VCORE has reached the voltage of the last set_vcore(). Never waits. */
+bool vcore_settled(void)
+{
+	bool settled;
+
+	if (atomic_get(&vcore_writes_pending) != 0) {
+		AVSPoll();
+		if (atomic_get(&vcore_writes_pending) != 0) {
+			return false;
+		}
+	}
+
+	K_SPINLOCK(&vcore_settle_lock) {
+		settled = TimerTimestamp() >= vcore_settle_time;
+	}
+
+	return settled;
+}
+
 uint32_t get_vcore(void)
 {
 	return i2c_get_max20816(P0V8_VCORE_ADDR);
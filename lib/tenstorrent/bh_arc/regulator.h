@@ -6,6 +6,7 @@
 #ifndef REGULATOR_H
 #define REGULATOR_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <zephyr/drivers/misc/bh_fwtable.h>
 
@@ -33,6 +34,7 @@ typedef enum {
 uint32_t get_vcore(void);  /* returns voltage in mV. */
 uint32_t get_vcorem(void); /* returns voltage in mV. */
 void set_vcore(uint32_t voltage_in_mv);
+bool vcore_settled(void);
 void set_vcorem(uint32_t voltage_in_mv);
 void set_gddr_vddr(PcbType board_type, uint32_t voltage_in_mv);
 float GetVcoreCurrent(void);
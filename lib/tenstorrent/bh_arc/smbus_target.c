@@ -166,6 +166,12 @@ static const SmbusCmdDef smbus_telem_reg_cmd_def = {
 static const SmbusCmdDef smbus_telem_data_cmd_def = {
 	.pec = 1U, .trans_type = kSmbusTransBlockRead, .send_handler = &SMBusTelemDataHandler};
 
+static const SmbusCmdDef smbus_telem_block_read_cmd_def = {
+	.pec = 1U,
+	.trans_type = kSmbusTransBlockWriteBlockRead,
+	.rcv_handler = &SMBusTelemBlockSelectHandler,
+	.send_handler = &SMBusTelemBlockDataHandler};
+
 static const SmbusCmdDef smbus_therm_trip_count_cmd_def = {.pec = 1U,
 							   .trans_type = kSmbusTransWriteWord,
 							   .rcv_handler =
@@ -239,6 +245,8 @@ static int InitSmbusTarget(void)
 				  &smbus_power_instant_cmd_def);
 	smbus_target_register_cmd(smbus_target, 0x26, &smbus_telem_reg_cmd_def);
 	smbus_target_register_cmd(smbus_target, 0x27, &smbus_telem_data_cmd_def);
+	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_TELEMETRY_BLOCK_READ,
+				  &smbus_telem_block_read_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_THERM_TRIP_COUNT,
 				  &smbus_therm_trip_count_cmd_def);
 #endif
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "bulk_mailbox.h"
 #include "reg.h"
 #include "status_reg.h"
 #include "util.h"
@@ -26,6 +27,10 @@
 #define SPI_BUFFER_SIZE 4096
 #define BYTE_GET(v, b)  FIELD_GET(0xFFu << ((b) * 8), (v))
 
+/* buffer_mem_type values for EEPROM read and write requests */
+#define EEPROM_BUFFER_CSM          0 /* data[3] is an address in the SPI buffer */
+#define EEPROM_BUFFER_BULK_MAILBOX 1 /* data[3] is a bulk mailbox offset, data[4] the CRC-32 */
+
 #define SSI_RX_DLY_SR_DEPTH            64
 #define SPI_RX_SAMPLE_DELAY_TRAIN_ADDR 0x13FFC
 #define SPI_RX_SAMPLE_DELAY_TRAIN_DATA 0xA5A55A5A
@@ -168,6 +173,35 @@ static bool check_csm_region(uint32_t addr, uint32_t num_bytes)
 	       (addr + num_bytes) > ((uint32_t)spi_global_buffer + sizeof(spi_global_buffer));
 }
 
+/* Writes erase and reprogram whole sectors, so they finish on the system workqueue and answer
+ * the host through a deferred response instead of holding up the message queues.
+ */
+static struct {
+	struct msgqueue_deferred_response token;
+	uint32_t spi_address;
+	uint32_t num_bytes;
+	uint8_t *csm_addr;
+} eeprom_write;
+
+static void eeprom_write_work_handler(struct k_work *work)
+{
+	struct response response = {0};
+	int rc = SpiSmartWrite(eeprom_write.spi_address, eeprom_write.csm_addr,
+			       eeprom_write.num_bytes);
+
+	msgqueue_complete_deferred(&eeprom_write.token, &response, rc);
+}
+
+static K_WORK_DEFINE(eeprom_write_work, eeprom_write_work_handler);
+
+/* Wait for an in-flight deferred write, so flash accesses stay in request order. */
+static void eeprom_write_flush(void)
+{
+	struct k_work_sync sync;
+
+	k_work_flush(&eeprom_write_work, &sync);
+}
+
 static uint8_t read_eeprom_handler(const union request *request, struct response *response)
 {
 	uint8_t buffer_mem_type = BYTE_GET(request->data[0], 1);
@@ -179,17 +213,30 @@ static uint8_t read_eeprom_handler(const union request *request, struct response
 		/* Flash init failed */
 		return 1;
 	}
-	if (buffer_mem_type == 0) {
+	if (buffer_mem_type == EEPROM_BUFFER_CSM) {
 		/* Make sure that we are only interacting with our csm scratch buffer */
 		if (check_csm_region((uint32_t)csm_addr, num_bytes)) {
 			return 2;
 		}
+	} else if (buffer_mem_type == EEPROM_BUFFER_BULK_MAILBOX) {
+		csm_addr = bulk_mailbox_region(request->data[3], num_bytes);
+		if (csm_addr == NULL) {
+			return 2;
+		}
 	} else {
 		/* If we aren't reading from the csm; exit with error */
 		return 1;
 	}
 
-	return SpiBlockRead(spi_address, num_bytes, csm_addr);
+	eeprom_write_flush();
+
+	int rc = SpiBlockRead(spi_address, num_bytes, csm_addr);
+
+	if (rc == 0 && buffer_mem_type == EEPROM_BUFFER_BULK_MAILBOX) {
+		response->data[1] = bulk_mailbox_checksum(csm_addr, num_bytes);
+	}
+
+	return rc;
 }
 
 static uint8_t write_eeprom_handler(const union request *request, struct response *response)
@@ -208,17 +255,36 @@ static uint8_t write_eeprom_handler(const union request *request, struct respons
 		/* Flash init failed */
 		return 1;
 	}
-	if (buffer_mem_type == 0) {
+	if (buffer_mem_type == EEPROM_BUFFER_CSM) {
 		/* Make sure that we are only interacting with our csm scratch buffer */
 		if (check_csm_region((uint32_t)csm_addr, num_bytes)) {
 			return 2;
 		}
+	} else if (buffer_mem_type == EEPROM_BUFFER_BULK_MAILBOX) {
+		int rc = bulk_mailbox_get(request->data[3], num_bytes, request->data[4], &csm_addr);
+
+		if (rc == -EBADMSG) {
+			return 3;
+		} else if (rc != 0) {
+			return 2;
+		}
 	} else {
 		/* If we aren't reading from the csm; exit with error */
 		return 1;
 	}
 
-	return SpiSmartWrite(spi_address, csm_addr, num_bytes);
+	eeprom_write_flush();
+
+	eeprom_write.spi_address = spi_address;
+	eeprom_write.num_bytes = num_bytes;
+	eeprom_write.csm_addr = csm_addr;
+
+	if (msgqueue_defer_response(&eeprom_write.token) != 0) {
+		return SpiSmartWrite(spi_address, csm_addr, num_bytes);
+	}
+
+	k_work_submit(&eeprom_write_work);
+	return 0;
 }
 
 /* Challenge message issued from tt-flash to confirm a firmware update. */
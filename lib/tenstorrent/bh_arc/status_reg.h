@@ -56,6 +56,9 @@
 #define I2C0_TARGET_DEBUG_STATE_REG_ADDR     RESET_UNIT_SCRATCH_RAM_REG_ADDR(19)
 #define I2C0_TARGET_DEBUG_STATE_2_REG_ADDR   RESET_UNIT_SCRATCH_RAM_REG_ADDR(20)
 #define ARC_HANG_PC                          RESET_UNIT_SCRATCH_RAM_REG_ADDR(21)
+#define BULK_MAILBOX_INFO_REG_ADDR           RESET_UNIT_SCRATCH_RAM_REG_ADDR(22)
+#define TELEMETRY_HISTORY_REG_ADDR           RESET_UNIT_SCRATCH_RAM_REG_ADDR(23)
+#define TELEMETRY_EVENTS_REG_ADDR            RESET_UNIT_SCRATCH_RAM_REG_ADDR(24)
 
 #define STATUS_FW_VUART_REG_ADDR(n)          RESET_UNIT_SCRATCH_RAM_REG_ADDR(40 + (n))
 /* SCRATCH_RAM_40 - SCRATCH_RAM_41 reserved for virtual uarts */
@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "aiclk_ppm.h"
 #include "cat.h"
 #include "cm2dm_msg.h"
+#include "dvfs.h"
 #include "fan_ctrl.h"
 #include "functional_efuse.h"
 #include "harvesting.h"
@@ -13,16 +15,25 @@
 #include "regulator.h"
 #include "status_reg.h"
 #include "telemetry.h"
+#include "telemetry_events.h"
+#include "telemetry_history.h"
 #include "telemetry_internal.h"
+#include "throttler.h"
+#include "timer.h"
 #include "gddr.h"
 
+#include <errno.h>
 #include <float.h> /* for FLT_MAX */
 #include <math.h>  /* for floor */
 #include <stdint.h>
 #include <string.h>
 
+#include <tenstorrent/msgqueue.h>
 #include <tenstorrent/post_code.h>
+#include <tenstorrent/smc_msg.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/barrier.h>
 #include <zephyr/drivers/misc/bh_fwtable.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
@@ -162,22 +173,48 @@ static struct telemetry_table telemetry_table = {
 		[57] = {TAG_TDC_LIMIT_MAX, TELEM_OFFSET(TAG_TDC_LIMIT_MAX)},
 		[58] = {TAG_THM_LIMIT_THROTTLE, TELEM_OFFSET(TAG_THM_LIMIT_THROTTLE)},
 		[59] = {TAG_TDP_LIMIT_MAX, TELEM_OFFSET(TAG_TDP_LIMIT_MAX)},
+		[60] = {TAG_TELEM_SEQUENCE, TELEM_OFFSET(TAG_TELEM_SEQUENCE)},
+		[61] = {TAG_DVFS_TICKS, TELEM_OFFSET(TAG_DVFS_TICKS)},
+		[62] = {TAG_DVFS_EXEC_MAX, TELEM_OFFSET(TAG_DVFS_EXEC_MAX)},
+		[63] = {TAG_DVFS_LATE_MAX, TELEM_OFFSET(TAG_DVFS_LATE_MAX)},
+		[64] = {TAG_DVFS_MISSED, TELEM_OFFSET(TAG_DVFS_MISSED)},
+		[65] = {TAG_AICLK_LIMITER, TELEM_OFFSET(TAG_AICLK_LIMITER)},
+		[66] = {TAG_AICLK_THROTTLED_TICKS, TELEM_OFFSET(TAG_AICLK_THROTTLED_TICKS)},
+		[67] = {TAG_INPUT_POWER_AVG_100MS, TELEM_OFFSET(TAG_INPUT_POWER_AVG_100MS)},
+		[68] = {TAG_INPUT_POWER_AVG_1S, TELEM_OFFSET(TAG_INPUT_POWER_AVG_1S)},
+		[69] = {TAG_INPUT_POWER_AVG_10S, TELEM_OFFSET(TAG_INPUT_POWER_AVG_10S)},
+		[70] = {TAG_ASIC_TEMPERATURE_MAX, TELEM_OFFSET(TAG_ASIC_TEMPERATURE_MAX)},
 	},
 };
 
 /**
- * @brief Pointer to the telemetry data buffer.
+ * @brief Working copy of the telemetry data.
  *
- * This buffer contains dynamically updated telemetry values. The address of this buffer
- * is published in the @ref TELEMETRY_DATA_REG_ADDR register.
+ * Telemetry values are gathered here and then copied into telemetry_table.telemetry, whose
+ * address is published in the @ref TELEMETRY_DATA_REG_ADDR register. Each copy is bracketed by
+ * @ref TAG_TELEM_SEQUENCE so readers never mix values from two updates.
  */
-static uint32_t *telemetry = &telemetry_table.telemetry[0];
+static uint32_t telemetry[TAG_COUNT];
+
+/** @brief Serializes writers of the published telemetry data. */
+static struct k_spinlock telemetry_lock;
 
 /** @} */ /* end of telemetry_table group */
 
 static struct k_timer telem_update_timer;
 static struct k_work telem_update_worker;
-static int telem_update_interval = 100;
+static bool telem_timer_started;
+
+/* Telemetry tags are refreshed in tiers with their own periods. The update timer runs at the
+ * shortest period and each tier is refreshed every period / tick timer expiries.
+ */
+static struct telemetry_tier_stats tier_stats[TELEMETRY_TIER_COUNT] = {
+	[TELEMETRY_TIER_FAST] = {.period_ms = CONFIG_TT_BH_ARC_TELEMETRY_FAST_PERIOD},
+	[TELEMETRY_TIER_MEDIUM] = {.period_ms = CONFIG_TT_BH_ARC_TELEMETRY_MEDIUM_PERIOD},
+	[TELEMETRY_TIER_SLOW] = {.period_ms = CONFIG_TT_BH_ARC_TELEMETRY_SLOW_PERIOD},
+};
+static uint32_t tier_countdown[TELEMETRY_TIER_COUNT];
+static uint32_t telem_tick_ms = CONFIG_TT_BH_ARC_TELEMETRY_FAST_PERIOD;
 
 uint32_t ConvertFloatToTelemetry(float value)
 {
@@ -280,13 +317,13 @@ static void UpdateGddrTelemetry(void)
 	}
 }
 
-int GetMaxGDDRTemp(void)
+static int find_max_gddr_temp(const uint32_t *data)
 {
 	int max_gddr_temp = 0;
 
 	for (int i = 0; i < NUM_GDDR; i++) {
 		int shift_val = (i % 2) * 16;
-		int gddr_temp = telemetry[TAG_GDDR_0_1_TEMP + i / 2];
+		int gddr_temp = data[TAG_GDDR_0_1_TEMP + i / 2];
 
 		max_gddr_temp = MAX(max_gddr_temp, (gddr_temp >> shift_val) & 0xFF);
 		max_gddr_temp = MAX(max_gddr_temp, (gddr_temp >> (shift_val + 8)) & 0xFF);
@@ -295,6 +332,41 @@ int GetMaxGDDRTemp(void)
 	return max_gddr_temp;
 }
 
+int GetMaxGDDRTemp(void)
+{
+	return find_max_gddr_temp(telemetry_table.telemetry);
+}
+
+/* Caller must hold telemetry_lock. Brackets the writes with an odd sequence number, so a reader
+ * that sees the same even sequence number before and after its reads got a consistent view.
+ */
+static void publish_telemetry_begin(void)
+{
+	telemetry_table.telemetry[TAG_TELEM_SEQUENCE]++;
+	barrier_dmem_fence_full();
+}
+
+static void publish_telemetry_end(void)
+{
+	barrier_dmem_fence_full();
+	telemetry_table.telemetry[TAG_TELEM_SEQUENCE]++;
+}
+
+static void publish_telemetry(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	publish_telemetry_begin();
+	for (int i = 0; i < TAG_COUNT; i++) {
+		if (i != TAG_TELEM_SEQUENCE) {
+			telemetry_table.telemetry[i] = telemetry[i];
+		}
+	}
+	publish_telemetry_end();
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
 static void write_static_telemetry(uint32_t app_version)
 {
 	telemetry_table.version = TELEMETRY_VERSION; /* v0.1.0 - Only update when redefining the
@@ -321,9 +393,8 @@ static void write_static_telemetry(uint32_t app_version)
 	telemetry[TAG_ASIC_ID_HIGH] = READ_FUNCTIONAL_EFUSE(ASIC_ID_HIGH);
 	telemetry[TAG_ASIC_ID_LOW] = READ_FUNCTIONAL_EFUSE(ASIC_ID_LOW);
 	telemetry[TAG_HARVESTING_STATE] = 0x00000000;
-	telemetry[TAG_UPDATE_TELEM_SPEED] = telem_update_interval; /* Expected speed of
-								    * update in ms
-								    */
+	telemetry[TAG_UPDATE_TELEM_SPEED] =
+		tier_stats[TELEMETRY_TIER_FAST].period_ms; /* Expected speed of update in ms */
 
 	/* TODO: Gather FW versions from FW themselves */
 	telemetry[TAG_ETH_FW_VERSION] = 0x00000000;
@@ -363,12 +434,13 @@ static void write_static_telemetry(uint32_t app_version)
 	telemetry[TAG_ASIC_LOCATION] = tt_bh_fwtable_get_asic_location(fwtable_dev);
 }
 
-static void update_telemetry(void)
+/* Power, current, voltage, temperature, AICLK, DVFS timing and AICLK limiters */
+static void update_fast_telemetry(void)
 {
-	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_START);
 	TelemetryInternalData telemetry_internal_data;
 
-	ReadTelemetryInternal(telem_update_interval, &telemetry_internal_data);
+	ReadTelemetryInternal(tier_stats[TELEMETRY_TIER_FAST].period_ms,
+			      &telemetry_internal_data);
 
 	/* Get all dynamically updated values */
 	telemetry[TAG_VCORE] =
@@ -384,12 +456,51 @@ static void update_telemetry(void)
 		telemetry_internal_data.asic_temperature); /* ASIC temperature - reported in
 							    * signed int 16.16 format
 							    */
+	telemetry[TAG_ASIC_TEMPERATURE_MAX] =
+		ConvertFloatToTelemetry(telemetry_internal_data.asic_temperature_max);
 	telemetry[TAG_VREG_TEMPERATURE] = 0x000000;        /* VREG temperature - need I2C line */
 	telemetry[TAG_BOARD_TEMPERATURE] = 0x000000;       /* Board temperature - need I2C line */
+	telemetry[TAG_INPUT_POWER] = GetInputPower(); /* Input power - reported in W */
+
 	clock_control_get_rate(pll_dev_0, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
 			       &telemetry[TAG_AICLK]);
 	/* first 16 bits - MAX ASIC FREQ (Not Available yet), lower 16 bits - current AICLK */
 
+	struct dvfs_stats dvfs_stats;
+
+	GetDVFSStats(&dvfs_stats);
+	telemetry[TAG_DVFS_TICKS] = dvfs_stats.ticks;
+	telemetry[TAG_DVFS_EXEC_MAX] = dvfs_stats.exec_max_us;
+	telemetry[TAG_DVFS_LATE_MAX] = dvfs_stats.late_max_us;
+	telemetry[TAG_DVFS_MISSED] = dvfs_stats.missed;
+
+	struct aiclk_limiter_stats limiter_stats;
+	uint32_t throttled_ticks = 0;
+
+	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
+		GetAiclkLimiterStats(i, &limiter_stats);
+		throttled_ticks += limiter_stats.ticks;
+	}
+	telemetry[TAG_AICLK_LIMITER] = GetAiclkLimiter();
+	telemetry[TAG_AICLK_THROTTLED_TICKS] = throttled_ticks;
+
+	telemetry[TAG_INPUT_POWER_AVG_100MS] = GetBoardPowerAverage(POWER_WINDOW_100MS);
+	telemetry[TAG_INPUT_POWER_AVG_1S] = GetBoardPowerAverage(POWER_WINDOW_1S);
+	telemetry[TAG_INPUT_POWER_AVG_10S] = GetBoardPowerAverage(POWER_WINDOW_10S);
+}
+
+/* Fan and GDDR temperatures and error counts */
+static void update_medium_telemetry(void)
+{
+	telemetry[TAG_FAN_SPEED] = GetFanSpeed(); /* Target fan speed - reported in percentage */
+	telemetry[TAG_FAN_RPM] = GetFanRPM();     /* Actual fan RPM */
+	UpdateGddrTelemetry();
+	telemetry[TAG_MAX_GDDR_TEMP] = find_max_gddr_temp(telemetry);
+}
+
+/* Fixed clock rates and link status, which only change on explicit reconfiguration */
+static void update_slow_telemetry(void)
+{
 	clock_control_get_rate(
 		pll_dev_1, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AXICLK,
 		&telemetry[TAG_AXICLK]); /* first 16 bits - MAX AXI FREQ (Not Available yet),
@@ -425,20 +536,58 @@ static void update_telemetry(void)
 		0x00000000; /* ETH live status lower 16 bits: heartbeat status, upper 16 bits:
 			     * retrain_status - Not Available yet
 			     */
-	telemetry[TAG_FAN_SPEED] = GetFanSpeed(); /* Target fan speed - reported in percentage */
-	telemetry[TAG_FAN_RPM] = GetFanRPM();     /* Actual fan RPM */
-	UpdateGddrTelemetry();
-	telemetry[TAG_MAX_GDDR_TEMP] = GetMaxGDDRTemp();
-	telemetry[TAG_INPUT_POWER] = GetInputPower(); /* Input power - reported in W */
+}
+
+static void (*const tier_update[TELEMETRY_TIER_COUNT])(void) = {
+	[TELEMETRY_TIER_FAST] = update_fast_telemetry,
+	[TELEMETRY_TIER_MEDIUM] = update_medium_telemetry,
+	[TELEMETRY_TIER_SLOW] = update_slow_telemetry,
+};
+
+static bool tier_due(enum telemetry_tier tier)
+{
+	if (tier_countdown[tier] > 0) {
+		tier_countdown[tier]--;
+		return false;
+	}
+
+	tier_countdown[tier] =
+		MAX(DIV_ROUND_CLOSEST(tier_stats[tier].period_ms, telem_tick_ms), 1) - 1;
+	return true;
+}
+
+static void update_telemetry(bool all_tiers)
+{
+	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_START);
+
+	for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++) {
+		if (!tier_due(tier) && !all_tiers) {
+			continue;
+		}
+
+		uint64_t start = TimerTimestamp();
+
+		tier_update[tier]();
+
+		uint32_t elapsed_us = (TimerTimestamp() - start) / WAIT_1US;
+
+		tier_stats[tier].runs++;
+		tier_stats[tier].total_us += elapsed_us;
+		tier_stats[tier].max_us = MAX(tier_stats[tier].max_us, elapsed_us);
+	}
+
 	telemetry[TAG_TIMER_HEARTBEAT]++; /* Incremented every time the timer is called */
+	publish_telemetry();
+	telemetry_history_append(telemetry);
+	telemetry_events_check(telemetry);
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_END);
 }
 
 /* Handler functions for zephyr timer and worker objects */
 static void telemetry_work_handler(struct k_work *work)
 {
-	/* Repeat fetching of dynamic telemetry values */
-	update_telemetry();
+	/* Repeat fetching of the dynamic telemetry values that are due */
+	update_telemetry(false);
 }
 static void telemetry_timer_handler(struct k_timer *timer)
 {
@@ -454,15 +603,48 @@ static void telemetry_timer_handler(struct k_timer *timer)
 static K_WORK_DEFINE(telem_update_worker, telemetry_work_handler);
 static K_TIMER_DEFINE(telem_update_timer, telemetry_timer_handler, NULL);
 
+static void update_telem_tick(void)
+{
+	uint32_t tick_ms = UINT32_MAX;
+
+	for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++) {
+		tick_ms = MIN(tick_ms, tier_stats[tier].period_ms);
+	}
+
+	telem_tick_ms = tick_ms;
+}
+
+static void load_tier_periods(void)
+{
+	const FwTable *fw_table = tt_bh_fwtable_get_fw_table(fwtable_dev);
+	const uint32_t periods[TELEMETRY_TIER_COUNT] = {
+		[TELEMETRY_TIER_FAST] = fw_table->telemetry_periods.fast_ms,
+		[TELEMETRY_TIER_MEDIUM] = fw_table->telemetry_periods.medium_ms,
+		[TELEMETRY_TIER_SLOW] = fw_table->telemetry_periods.slow_ms,
+	};
+
+	/* A zero or out of range period keeps the Kconfig default */
+	for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++) {
+		if (IN_RANGE(periods[tier], TELEMETRY_PERIOD_MIN_MS, TELEMETRY_PERIOD_MAX_MS)) {
+			tier_stats[tier].period_ms = periods[tier];
+		}
+	}
+
+	update_telem_tick();
+}
+
 void init_telemetry(uint32_t app_version)
 {
+	load_tier_periods();
 	write_static_telemetry(app_version);
 	/* fill the dynamic values once before starting timed updates */
-	update_telemetry();
+	update_telemetry(true);
 
 	/* Publish the telemetry data pointer for readers in Scratch RAM */
-	WriteReg(TELEMETRY_DATA_REG_ADDR, (uint32_t)&telemetry[0]);
+	WriteReg(TELEMETRY_DATA_REG_ADDR, (uint32_t)&telemetry_table.telemetry[0]);
 	WriteReg(TELEMETRY_TABLE_REG_ADDR, (uint32_t)&telemetry_table);
+	telemetry_history_publish();
+	telemetry_events_publish();
 }
 
 void StartTelemetryTimer(void)
@@ -470,32 +652,58 @@ void StartTelemetryTimer(void)
 	/* Start the timer to update the dynamic telemetry values
 	 * Duration (time interval before the timer expires for the first time) and
 	 * Period (time interval between all timer expirations after the first one)
-	 * are both set to telem_update_interval
+	 * are both set to the shortest tier period
 	 */
-	k_timer_start(&telem_update_timer, K_MSEC(telem_update_interval),
-		      K_MSEC(telem_update_interval));
+	k_timer_start(&telem_update_timer, K_MSEC(telem_tick_ms), K_MSEC(telem_tick_ms));
+	telem_timer_started = true;
+}
+
+/* Updates the given tags in both the working copy and the published table as one update, without
+ * exposing values that update_telemetry is still gathering. May be called from ISRs.
+ */
+void UpdateTelemetryTags(const uint16_t *tags, const uint32_t *values, size_t count)
+{
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	publish_telemetry_begin();
+	for (size_t i = 0; i < count; i++) {
+		if (tags[i] < TAG_COUNT && tags[i] != TAG_TELEM_SEQUENCE) {
+			telemetry[tags[i]] = values[i];
+			telemetry_table.telemetry[tags[i]] = values[i];
+		}
+	}
+	publish_telemetry_end();
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+static void update_telemetry_tag(uint16_t tag, uint32_t value)
+{
+	UpdateTelemetryTags(&tag, &value, 1);
 }
 
 void UpdateDmFwVersion(uint32_t bl_version, uint32_t app_version)
 {
-	telemetry[TAG_DM_BL_FW_VERSION] = bl_version;
-	telemetry[TAG_DM_APP_FW_VERSION] = app_version;
+	const uint16_t tags[] = {TAG_DM_BL_FW_VERSION, TAG_DM_APP_FW_VERSION};
+	const uint32_t values[] = {bl_version, app_version};
+
+	UpdateTelemetryTags(tags, values, ARRAY_SIZE(tags));
 }
 
 void UpdateTelemetryNocTranslation(bool translation_enabled)
 {
 	/* Note that this may be called before init_telemetry. */
-	telemetry[TAG_NOC_TRANSLATION] = translation_enabled;
+	update_telemetry_tag(TAG_NOC_TRANSLATION, translation_enabled);
 }
 
 void UpdateTelemetryBoardPowerLimit(uint32_t power_limit)
 {
-	telemetry[TAG_BOARD_POWER_LIMIT] = power_limit;
+	update_telemetry_tag(TAG_BOARD_POWER_LIMIT, power_limit);
 }
 
 void UpdateTelemetryThermTripCount(uint16_t therm_trip_count)
 {
-	telemetry[TAG_THERM_TRIP_COUNT] = therm_trip_count;
+	update_telemetry_tag(TAG_THERM_TRIP_COUNT, therm_trip_count);
 }
 
 bool GetTelemetryTagValid(uint16_t tag)
@@ -508,5 +716,83 @@ uint32_t GetTelemetryTag(uint16_t tag)
 	if (tag >= TAG_COUNT) {
 		return -1;
 	}
-	return telemetry[tag];
+	return telemetry_table.telemetry[tag];
+}
+
+/* Reads several tags from the same published update. Unknown tags read as 0xFFFFFFFF, as with
+ * GetTelemetryTag.
+ */
+void GetTelemetryTags(const uint16_t *tags, uint32_t *values, size_t count)
+{
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	for (size_t i = 0; i < count; i++) {
+		values[i] = tags[i] < TAG_COUNT ? telemetry_table.telemetry[tags[i]] : UINT32_MAX;
+	}
+
+	k_spin_unlock(&telemetry_lock, key);
 }
+
+int SetTelemetryTierPeriod(enum telemetry_tier tier, uint32_t period_ms)
+{
+	if (tier >= TELEMETRY_TIER_COUNT ||
+	    !IN_RANGE(period_ms, TELEMETRY_PERIOD_MIN_MS, TELEMETRY_PERIOD_MAX_MS)) {
+		return -EINVAL;
+	}
+
+	uint32_t old_tick_ms = telem_tick_ms;
+
+	tier_stats[tier].period_ms = period_ms;
+	tier_countdown[tier] = 0;
+	update_telem_tick();
+
+	if (tier == TELEMETRY_TIER_FAST) {
+		update_telemetry_tag(TAG_UPDATE_TELEM_SPEED, period_ms);
+	}
+
+	if (telem_tick_ms != old_tick_ms) {
+		/* Tier countdowns are in ticks, so restart them all at the new tick */
+		memset(tier_countdown, 0, sizeof(tier_countdown));
+		if (telem_timer_started) {
+			k_timer_start(&telem_update_timer, K_MSEC(telem_tick_ms),
+				      K_MSEC(telem_tick_ms));
+		}
+	}
+
+	return 0;
+}
+
+uint32_t GetTelemetryTierPeriod(enum telemetry_tier tier)
+{
+	if (tier >= TELEMETRY_TIER_COUNT) {
+		return 0;
+	}
+
+	return tier_stats[tier].period_ms;
+}
+
+const struct telemetry_tier_stats *GetTelemetryTierStats(enum telemetry_tier tier)
+{
+	if (tier >= TELEMETRY_TIER_COUNT) {
+		return NULL;
+	}
+
+	return &tier_stats[tier];
+}
+
+static uint8_t telemetry_periods_handler(const union request *request, struct response *response)
+{
+	const struct telemetry_periods_rqst *rqst = &request->telemetry_periods;
+
+	if (rqst->period_ms != 0 && SetTelemetryTierPeriod(rqst->tier, rqst->period_ms) != 0) {
+		return EINVAL;
+	}
+
+	for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++) {
+		response->data[1 + tier] = tier_stats[tier].period_ms;
+	}
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_TELEMETRY_PERIODS, telemetry_periods_handler);
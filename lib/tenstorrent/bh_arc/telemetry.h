@@ -7,6 +7,7 @@
 #define TELEMETRY_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -62,7 +63,7 @@
 /** @brief Thermal shutdown limit in degrees Celsius. */
 #define TAG_THM_LIMIT_SHUTDOWN 10
 
-/** @brief ASIC temperature in signed 16.16 fixed-point format. */
+/** @brief Mean ASIC temperature in signed 16.16 fixed-point format. */
 #define TAG_ASIC_TEMPERATURE 11
 
 /** @brief Voltage regulator temperature in degrees Celsius. (Not implemented) */
@@ -224,16 +225,90 @@
 /** @brief Maximum TDP limit in watts. */
 #define TAG_TDP_LIMIT_MAX 64
 
+/**
+ * @brief Telemetry generation counter.
+ *
+ * Odd while the firmware is publishing an update and even once the data is stable. Readers
+ * that need several tags from the same update read this tag before and after reading their
+ * tags and retry if the two values differ or are odd.
+ */
+#define TAG_TELEM_SEQUENCE 65
+
+/** @brief Number of periodic DVFS updates run since boot. Off-schedule updates are not counted. */
+#define TAG_DVFS_TICKS 66
+
+/** @brief Longest periodic DVFS update in microseconds. */
+#define TAG_DVFS_EXEC_MAX 67
+
+/**
+ * @brief Longest delay in microseconds from the scheduled time of a periodic DVFS update to its
+ * start.
+ *
+ * Updates are scheduled every DVFS period. An update serves the latest scheduled time at or
+ * before its start, so the delay is always under one period and the scheduled times it passed
+ * over are counted in @ref TAG_DVFS_MISSED instead.
+ */
+#define TAG_DVFS_LATE_MAX 68
+
+/** @brief Scheduled DVFS updates that never ran because a later one was already due. */
+#define TAG_DVFS_MISSED 69
+
+/**
+ * @brief Arbiter that set the AICLK target in the latest DVFS update.
+ *
+ * Values below the number of max arbiters are the throttler that limited AICLK, followed by
+ * the min arbiters, a forced frequency and the AICLK sweep. See @ref TT_SMC_MSG_AICLK_LIMITERS.
+ */
+#define TAG_AICLK_LIMITER 70
+
+/** @brief DVFS updates in which a throttler held AICLK below what was requested. */
+#define TAG_AICLK_THROTTLED_TICKS 71
+
+/**
+ * @brief Board input power averaged over the latest 100 ms, in W.
+ *
+ * Averaged from @ref TAG_INPUT_POWER at every DVFS update, so it is 0 while DVFS is disabled.
+ */
+#define TAG_INPUT_POWER_AVG_100MS 72
+
+/** @brief Board input power averaged over the latest 1 s, in W. Drives the Doppler throttler. */
+#define TAG_INPUT_POWER_AVG_1S 73
+
+/** @brief Board input power averaged over the latest 10 s, in W. */
+#define TAG_INPUT_POWER_AVG_10S 74
+
+/** @brief Hottest PVT temperature sensor in signed 16.16 fixed-point format. */
+#define TAG_ASIC_TEMPERATURE_MAX 75
+
 /** @} */ /* end of telemetry_tag group */
 
 /* Not a real tag, signifies the last tag in the list.
  * MUST be incremented if new tags are defined.
  */
-#define TAG_COUNT 65
+#define TAG_COUNT 76
 
 /* Telemetry tags are at offset `tag` in the telemetry buffer */
 #define TELEM_OFFSET(tag) (tag)
 
+/* Bounds for telemetry tier update periods */
+#define TELEMETRY_PERIOD_MIN_MS 10
+#define TELEMETRY_PERIOD_MAX_MS 60000
+
+/* Dynamic telemetry tags are refreshed in tiers, each with its own update period */
+enum telemetry_tier {
+	TELEMETRY_TIER_FAST,   /* power, current, voltage, ASIC temperature and DVFS timing */
+	TELEMETRY_TIER_MEDIUM, /* fan, GDDR temperatures and GDDR errors */
+	TELEMETRY_TIER_SLOW,   /* clock rates and link status */
+	TELEMETRY_TIER_COUNT,
+};
+
+struct telemetry_tier_stats {
+	uint32_t period_ms;
+	uint32_t runs;
+	uint32_t max_us;   /* longest single refresh */
+	uint64_t total_us; /* time spent refreshing since boot */
+};
+
 void init_telemetry(uint32_t app_version);
 uint32_t ConvertFloatToTelemetry(float value);
 float ConvertTelemetryToFloat(int32_t value);
@@ -243,7 +318,12 @@ void UpdateDmFwVersion(uint32_t bl_version, uint32_t app_version);
 void UpdateTelemetryNocTranslation(bool translation_enabled);
 void UpdateTelemetryBoardPowerLimit(uint32_t power_limit);
 void UpdateTelemetryThermTripCount(uint16_t therm_trip_count);
+void UpdateTelemetryTags(const uint16_t *tags, const uint32_t *values, size_t count);
 bool GetTelemetryTagValid(uint16_t tag);
 uint32_t GetTelemetryTag(uint16_t tag);
+void GetTelemetryTags(const uint16_t *tags, uint32_t *values, size_t count);
+int SetTelemetryTierPeriod(enum telemetry_tier tier, uint32_t period_ms);
+uint32_t GetTelemetryTierPeriod(enum telemetry_tier tier);
+const struct telemetry_tier_stats *GetTelemetryTierStats(enum telemetry_tier tier);
 
 #endif
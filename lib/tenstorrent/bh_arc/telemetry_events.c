@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "pcie_msi.h"
+#include "reg.h"
+#include "status_reg.h"
+#include "telemetry.h"
+#include "telemetry_events.h"
+#include "timer.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_TELEMETRY_EVENTS_ENTRIES),
+	     "head and tail wrap at 2^32, which must be a multiple of the capacity");
+
+struct telemetry_watch {
+	bool armed;
+	bool triggered;
+	uint8_t flags;
+	uint16_t tag;
+	uint32_t threshold;
+	uint32_t rearm_threshold; /* threshold moved back by the hysteresis */
+};
+
+static struct telemetry_watch watches[CONFIG_TT_BH_ARC_TELEMETRY_WATCHES];
+static struct k_spinlock watch_lock;
+
+static struct {
+	bool enabled;
+	uint8_t pcie_inst;
+	uint32_t vector_id;
+} event_msi;
+
+static struct telemetry_event_queue event_queue = {
+	.capacity = CONFIG_TT_BH_ARC_TELEMETRY_EVENTS_ENTRIES,
+	.entry_size = sizeof(struct telemetry_event),
+};
+
+/* Returns <0, 0 or >0 as value is below, at or above the threshold */
+static int compare(const struct telemetry_watch *watch, uint32_t value, uint32_t threshold)
+{
+	if (watch->flags & TELEMETRY_WATCH_FLAG_SIGNED) {
+		int32_t v = value;
+		int32_t t = threshold;
+
+		return (v > t) - (v < t);
+	}
+
+	return (value > threshold) - (value < threshold);
+}
+
+static bool crossed(const struct telemetry_watch *watch, uint32_t value)
+{
+	if (watch->flags & TELEMETRY_WATCH_FLAG_FALLING) {
+		return compare(watch, value, watch->threshold) < 0;
+	}
+
+	return compare(watch, value, watch->threshold) > 0;
+}
+
+static bool cleared(const struct telemetry_watch *watch, uint32_t value)
+{
+	if (watch->flags & TELEMETRY_WATCH_FLAG_FALLING) {
+		return compare(watch, value, watch->rearm_threshold) >= 0;
+	}
+
+	return compare(watch, value, watch->rearm_threshold) <= 0;
+}
+
+/* Saturates rather than wraps, so a large hysteresis never re-arms a watch immediately */
+static uint32_t rearm_threshold(uint8_t flags, uint32_t threshold, uint32_t hysteresis)
+{
+	int64_t delta = (flags & TELEMETRY_WATCH_FLAG_FALLING) ? hysteresis : -(int64_t)hysteresis;
+
+	if (flags & TELEMETRY_WATCH_FLAG_SIGNED) {
+		return (int32_t)CLAMP((int32_t)threshold + delta, INT32_MIN, INT32_MAX);
+	}
+
+	return CLAMP(threshold + delta, 0, UINT32_MAX);
+}
+
+static bool queue_event(uint8_t watch_id, const struct telemetry_watch *watch, uint32_t value,
+			uint8_t flags, uint64_t timestamp)
+{
+	struct telemetry_event_queue *queue = &event_queue;
+	uint32_t head = queue->head;
+
+	if (head - queue->tail >= queue->capacity) {
+		queue->dropped++;
+		return false;
+	}
+
+	struct telemetry_event *event = &queue->entries[head % queue->capacity];
+
+	event->timestamp_lo = (uint32_t)timestamp;
+	event->timestamp_hi = (uint32_t)(timestamp >> 32);
+	event->tag = watch->tag;
+	event->watch_id = watch_id;
+	event->flags = flags;
+	event->value = value;
+	event->threshold = watch->threshold;
+
+	/* The event must be visible before the host can see the new head */
+	barrier_dmem_fence_full();
+	queue->head = head + 1;
+	return true;
+}
+
+void telemetry_events_check(const uint32_t *telemetry)
+{
+	uint64_t timestamp = TimerTimestamp() / WAIT_1US;
+	bool queued = false;
+	k_spinlock_key_t key = k_spin_lock(&watch_lock);
+
+	for (int i = 0; i < ARRAY_SIZE(watches); i++) {
+		struct telemetry_watch *watch = &watches[i];
+		uint32_t value = telemetry[watch->tag];
+
+		if (!watch->armed) {
+			continue;
+		}
+
+		if (!watch->triggered && crossed(watch, value)) {
+			watch->triggered = true;
+			queued |= queue_event(i, watch, value, TELEMETRY_EVENT_FLAG_CROSSED,
+					      timestamp);
+		} else if (watch->triggered && cleared(watch, value)) {
+			watch->triggered = false;
+			queued |= queue_event(i, watch, value, TELEMETRY_EVENT_FLAG_CLEARED,
+					      timestamp);
+		}
+	}
+
+	bool send_msi = queued && event_msi.enabled;
+	uint8_t pcie_inst = event_msi.pcie_inst;
+	uint32_t vector_id = event_msi.vector_id;
+
+	k_spin_unlock(&watch_lock, key);
+
+	/* One MSI per check, however many events it queued */
+	if (send_msi) {
+		SendPcieMsi(pcie_inst, vector_id);
+	}
+}
+
+struct telemetry_event_queue *telemetry_events_get_queue(void)
+{
+	return &event_queue;
+}
+
+void telemetry_events_publish(void)
+{
+	WriteReg(TELEMETRY_EVENTS_REG_ADDR, (uint32_t)&event_queue);
+}
+
+static uint8_t telemetry_watch_handler(const union request *request, struct response *response)
+{
+	const struct telemetry_watch_rqst *rqst = &request->telemetry_watch;
+	bool watch_op = rqst->op == TELEMETRY_WATCH_OP_SET || rqst->op == TELEMETRY_WATCH_OP_CLEAR;
+
+	if (watch_op && rqst->watch_id >= ARRAY_SIZE(watches)) {
+		return EINVAL;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&watch_lock);
+	uint8_t ret = 0;
+
+	switch (rqst->op) {
+	case TELEMETRY_WATCH_OP_SET:
+		if (!GetTelemetryTagValid(rqst->tag)) {
+			ret = EINVAL;
+			break;
+		}
+		watches[rqst->watch_id] = (struct telemetry_watch){
+			.armed = true,
+			.flags = rqst->flags,
+			.tag = rqst->tag,
+			.threshold = rqst->threshold,
+			.rearm_threshold =
+				rearm_threshold(rqst->flags, rqst->threshold, rqst->hysteresis),
+		};
+		break;
+	case TELEMETRY_WATCH_OP_CLEAR:
+		watches[rqst->watch_id].armed = false;
+		break;
+	case TELEMETRY_WATCH_OP_SET_MSI:
+		if (rqst->pcie_inst > 1) {
+			ret = EINVAL;
+			break;
+		}
+		event_msi.enabled = true;
+		event_msi.pcie_inst = rqst->pcie_inst;
+		event_msi.vector_id = rqst->vector_id;
+		break;
+	case TELEMETRY_WATCH_OP_CLEAR_MSI:
+		event_msi.enabled = false;
+		break;
+	default:
+		ret = EINVAL;
+		break;
+	}
+
+	k_spin_unlock(&watch_lock, key);
+
+	response->data[1] = (uint32_t)&event_queue;
+	return ret;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_TELEMETRY_WATCH, telemetry_watch_handler);
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_EVENTS_H
+#define TELEMETRY_EVENTS_H
+
+#include <stdint.h>
+
+/* Telemetry events are queued in a host visible ring when a watched tag crosses its threshold,
+ * using the same head and tail protocol as the telemetry history: the SMC advances head, the
+ * host advances tail, and events that do not fit are counted in dropped. Watches are managed with
+ * TT_SMC_MSG_TELEMETRY_WATCH, which can also request an MSI whenever new events are queued.
+ */
+
+/* The watched tag crossed the threshold */
+#define TELEMETRY_EVENT_FLAG_CROSSED 0x1
+/* The watched tag returned past the threshold by the hysteresis and the watch re-armed */
+#define TELEMETRY_EVENT_FLAG_CLEARED 0x2
+
+struct telemetry_event {
+	uint32_t timestamp_lo; /* microseconds since boot */
+	uint32_t timestamp_hi;
+	uint16_t tag;
+	uint8_t watch_id;
+	uint8_t flags; /* TELEMETRY_EVENT_FLAG_* */
+	uint32_t value;
+	uint32_t threshold;
+};
+
+#ifdef CONFIG_TT_BH_ARC_TELEMETRY_EVENTS
+struct telemetry_event_queue {
+	uint32_t capacity;         /* events in the ring */
+	uint32_t entry_size;       /* bytes per event */
+	volatile uint32_t head;    /* written by the SMC */
+	volatile uint32_t tail;    /* written by the host */
+	volatile uint32_t dropped; /* events lost because the ring was full */
+	struct telemetry_event entries[CONFIG_TT_BH_ARC_TELEMETRY_EVENTS_ENTRIES];
+};
+
+/* Compare the watched tags of a telemetry data array indexed by tag against their thresholds */
+void telemetry_events_check(const uint32_t *telemetry);
+struct telemetry_event_queue *telemetry_events_get_queue(void);
+/* Publish the event queue address in TELEMETRY_EVENTS_REG_ADDR */
+void telemetry_events_publish(void);
+#else
+static inline void telemetry_events_check(const uint32_t *telemetry)
+{
+}
+
+static inline void telemetry_events_publish(void)
+{
+}
+#endif
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+#include "reg.h"
+#include "status_reg.h"
+#include "telemetry.h"
+#include "telemetry_history.h"
+#include "timer.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_ENTRIES),
+	     "head and tail wrap at 2^32, which must be a multiple of the capacity");
+
+static struct telemetry_history telemetry_history = {
+	.capacity = CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_ENTRIES,
+	.entry_size = sizeof(struct telemetry_history_entry),
+	.tags = {
+		TAG_TDP,
+		TAG_TDC,
+		TAG_VCORE,
+		TAG_INPUT_POWER,
+		TAG_AICLK,
+		TAG_ASIC_TEMPERATURE,
+		TAG_MAX_GDDR_TEMP,
+		TAG_FAN_RPM,
+	},
+};
+
+void telemetry_history_append(const uint32_t *telemetry)
+{
+	struct telemetry_history *history = &telemetry_history;
+	uint32_t head = history->head;
+
+	if (head - history->tail >= history->capacity) {
+		history->dropped++;
+		return;
+	}
+
+	struct telemetry_history_entry *entry = &history->entries[head % history->capacity];
+	uint64_t timestamp = TimerTimestamp() / WAIT_1US;
+
+	entry->timestamp_lo = (uint32_t)timestamp;
+	entry->timestamp_hi = (uint32_t)(timestamp >> 32);
+	for (int i = 0; i < TELEMETRY_HISTORY_NUM_TAGS; i++) {
+		entry->values[i] = telemetry[history->tags[i]];
+	}
+
+	/* The entry must be visible before the host can see the new head */
+	barrier_dmem_fence_full();
+	history->head = head + 1;
+}
+
+struct telemetry_history *telemetry_history_get(void)
+{
+	return &telemetry_history;
+}
+
+void telemetry_history_publish(void)
+{
+	WriteReg(TELEMETRY_HISTORY_REG_ADDR, (uint32_t)&telemetry_history);
+}
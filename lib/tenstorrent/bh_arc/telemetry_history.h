@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_HISTORY_H
+#define TELEMETRY_HISTORY_H
+
+#include <stdint.h>
+
+/* The telemetry history is a host visible ring of timestamped samples of a fixed set of tags,
+ * appended on every telemetry update. The SMC owns head and the host owns tail; both count
+ * entries since boot and wrap at 2^32. Entry n lives at entries[n % capacity]. The host reads
+ * entries [tail, head) and then advances tail. When the ring is full new samples are counted in
+ * dropped instead of overwriting entries the host has not read.
+ */
+
+#define TELEMETRY_HISTORY_NUM_TAGS 8
+
+struct telemetry_history_entry {
+	uint32_t timestamp_lo; /* microseconds since boot */
+	uint32_t timestamp_hi;
+	uint32_t values[TELEMETRY_HISTORY_NUM_TAGS];
+};
+
+#ifdef CONFIG_TT_BH_ARC_TELEMETRY_HISTORY
+struct telemetry_history {
+	uint32_t capacity;                         /* entries in the ring */
+	uint32_t entry_size;                       /* bytes per entry */
+	uint16_t tags[TELEMETRY_HISTORY_NUM_TAGS]; /* telemetry tag of each entry value */
+	volatile uint32_t head;                    /* written by the SMC */
+	volatile uint32_t tail;                    /* written by the host */
+	volatile uint32_t dropped;                 /* samples lost because the ring was full */
+	struct telemetry_history_entry entries[CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_ENTRIES];
+};
+
+/* Append one sample of the history tags from a telemetry data array indexed by tag */
+void telemetry_history_append(const uint32_t *telemetry);
+struct telemetry_history *telemetry_history_get(void);
+/* Publish the history address in TELEMETRY_HISTORY_REG_ADDR */
+void telemetry_history_publish(void);
+#else
+static inline void telemetry_history_append(const uint32_t *telemetry)
+{
+}
+
+static inline void telemetry_history_publish(void)
+{
+}
+#endif
+
+#endif
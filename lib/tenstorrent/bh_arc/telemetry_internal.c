@@ -6,63 +6,298 @@
 
 #include "avs.h"
 #include "telemetry_internal.h"
-#include "regulator.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
+#include <zephyr/logging/log.h>
 
-static int64_t last_update_time;
-static TelemetryInternalData internal_data;
+LOG_MODULE_REGISTER(telemetry_internal, CONFIG_TT_APP_LOG_LEVEL);
+
+/* Sensors are sampled without waiting on them. A sample is started once the newest one is older
+ * than a reader allows: the PVT read is submitted to RTIO and the AVS reads are queued. Later
+ * reads collect whatever has completed, and the sample is published once everything has. Samples
+ * are filled in one buffer while readers copy the other, so a reader always gets the newest
+ * complete sample and never stalls on a sensor.
+ *
+ * VCORE voltage and current are both read back from the VCORE regulator over AVSBus, so they
+ * are submitted as one batch. The PMBus readback over I2C (get_vcore()) blocks for the whole
+ * transaction and remains in use for TT_SMC_MSG_GET_VOLTAGE.
+ *
+ * A sample whose reads have not all completed within ACQ_TIMEOUT_MS is published with the reads
+ * that did, so that a sensor that never answers cannot stall its readers, the first one included.
+ */
+#define ACQ_TIMEOUT_MS 20
+
+enum {
+	ACQ_PVT = BIT(0),
+	ACQ_VCORE_VOLTAGE = BIT(1),
+	ACQ_VCORE_CURRENT = BIT(2),
+};
+
+static TelemetryInternalData samples[2];
+static int64_t sample_time[2];
+static int published = -1;
+/* AVS callbacks may run on any thread that talks to the regulator */
+static atomic_t acq_pending;
+static bool acq_active;
+/* ACQ_* reads missing from the last sample that timed out, so each failure is logged once */
+static uint32_t acq_timed_out;
+
+/* AVS responses, stored by the callbacks and copied into the sample by collect_sample() so that
+ * samples[] is only touched under acq_mutex.
+ */
+static struct {
+	uint32_t valid; /* ACQ_* reads that succeeded */
+	uint16_t vcore_voltage;
+	uint16_t vcore_current;
+} avs_results;
+static struct k_spinlock avs_result_lock;
+
+/* Serializes starting and collecting samples */
+static K_MUTEX_DEFINE(acq_mutex);
+/* Protects the published index while readers copy the sample */
+static struct k_spinlock sample_lock;
 
 #ifdef CONFIG_DT_HAS_TENSTORRENT_BH_PVT_ENABLED
 static const struct device *const pvt = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pvt));
 
-SENSOR_DT_READ_IODEV(ts_avg_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_TS_AVG, 0});
+#define TS_SWEEP_ENTRIES PVT_TT_BH_TS_SWEEP_ENTRIES(DT_PROP(DT_NODELABEL(pvt), num_ts))
+
+SENSOR_DT_READ_IODEV(ts_sweep_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_TS_SWEEP, 0});
+
+RTIO_DEFINE(ts_sweep_ctx, 1, 1);
 
-RTIO_DEFINE(ts_avg_ctx, 1, 1);
+static uint8_t ts_sweep_buf[sizeof(struct pvt_tt_bh_rtio_data) * TS_SWEEP_ENTRIES];
 
-static uint8_t ts_avg_buf[sizeof(struct sensor_value)];
+/* Set from submitting a read until its completion is consumed, which for a read abandoned by a
+ * timed out sample happens when the next sample starts.
+ */
+static bool pvt_read_outstanding;
+
+static int start_pvt_read(void)
+{
+	struct rtio_sqe *sqe;
+	int ret;
+
+	if (pvt_read_outstanding) {
+		struct rtio_cqe *cqe = rtio_cqe_consume(&ts_sweep_ctx);
+
+		if (cqe == NULL) {
+			return -EBUSY;
+		}
+		rtio_cqe_release(&ts_sweep_ctx, cqe);
+		pvt_read_outstanding = false;
+	}
+
+	sqe = rtio_sqe_acquire(&ts_sweep_ctx);
+	if (sqe == NULL) {
+		return -ENOMEM;
+	}
+
+	rtio_sqe_prep_read(sqe, &ts_sweep_iodev, RTIO_PRIO_NORM, ts_sweep_buf,
+			   sizeof(ts_sweep_buf), NULL);
+	ret = rtio_submit(&ts_sweep_ctx, 0);
+	pvt_read_outstanding = ret == 0;
+
+	return ret;
+}
+
+static float decode_ts(const struct sensor_decoder_api *decoder, enum pvt_tt_bh_channel chan)
+{
+	struct sensor_value temp;
+
+	decoder->decode(ts_sweep_buf, (struct sensor_chan_spec){chan, 0}, NULL, TS_SWEEP_ENTRIES,
+			&temp);
+	return sensor_value_to_float(&temp);
+}
+
+static bool collect_pvt_read(TelemetryInternalData *sample)
+{
+	struct rtio_cqe *cqe = rtio_cqe_consume(&ts_sweep_ctx);
+	const struct sensor_decoder_api *decoder;
+	int result;
+
+	if (cqe == NULL) {
+		return false;
+	}
+
+	result = cqe->result;
+	rtio_cqe_release(&ts_sweep_ctx, cqe);
+	pvt_read_outstanding = false;
+
+	if (result == 0 && sensor_get_decoder(pvt, &decoder) == 0) {
+		sample->asic_temperature = decode_ts(decoder, SENSOR_CHAN_PVT_TT_BH_TS_AVG);
+		sample->asic_temperature_max = decode_ts(decoder, SENSOR_CHAN_PVT_TT_BH_TS_MAX);
+	}
+
+	return true;
+}
 #endif
 
+static void vcore_voltage_done(AVSStatus status, uint16_t response, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	K_SPINLOCK(&avs_result_lock) {
+		if (status == AVSOk) {
+			avs_results.vcore_voltage = response;
+			avs_results.valid |= ACQ_VCORE_VOLTAGE;
+		}
+	}
+	atomic_and(&acq_pending, ~ACQ_VCORE_VOLTAGE);
+}
+
+static void vcore_current_done(AVSStatus status, uint16_t response, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	K_SPINLOCK(&avs_result_lock) {
+		if (status == AVSOk) {
+			avs_results.vcore_current = response;
+			avs_results.valid |= ACQ_VCORE_CURRENT;
+		}
+	}
+	atomic_and(&acq_pending, ~ACQ_VCORE_CURRENT);
+}
+
+/* Voltage in mV and current in units of AVS_CURRENT_LSB_A, sent back to back */
+static const AVSCmd vcore_reads[] = {
+	{.cmd_code = AVSCmdVoltage, .rail_sel = AVS_VCORE_RAIL, .cb = vcore_voltage_done},
+	{.cmd_code = AVSCmdCurrentRead, .rail_sel = AVS_VCORE_RAIL, .cb = vcore_current_done},
+};
+
+static int sample_buffer(void)
+{
+	return published < 0 ? 0 : !published;
+}
+
+static void start_sample(void)
+{
+	int buf = sample_buffer();
+	TelemetryInternalData *sample = &samples[buf];
+
+	/* Values whose read fails keep their previous reading */
+	if (published >= 0) {
+		*sample = samples[published];
+	}
+	sample_time[buf] = k_uptime_get();
+	K_SPINLOCK(&avs_result_lock) {
+		avs_results.valid = 0;
+	}
+	atomic_set(&acq_pending, ACQ_VCORE_VOLTAGE | ACQ_VCORE_CURRENT);
+	acq_active = true;
+
+#ifdef CONFIG_DT_HAS_TENSTORRENT_BH_PVT_ENABLED
+	if (start_pvt_read() == 0) {
+		atomic_or(&acq_pending, ACQ_PVT);
+	}
+#endif
+
+	if (AVSSubmit(vcore_reads, ARRAY_SIZE(vcore_reads)) != 0) {
+		atomic_and(&acq_pending, ~(ACQ_VCORE_VOLTAGE | ACQ_VCORE_CURRENT));
+	}
+}
+
+/* Returns true once the sample in flight has been published */
+static bool collect_sample(void)
+{
+	int buf = sample_buffer();
+	TelemetryInternalData *sample = &samples[buf];
+	atomic_val_t pending;
+
+	AVSPoll();
+#ifdef CONFIG_DT_HAS_TENSTORRENT_BH_PVT_ENABLED
+	if ((atomic_get(&acq_pending) & ACQ_PVT) && collect_pvt_read(sample)) {
+		atomic_and(&acq_pending, ~ACQ_PVT);
+	}
+#endif
+
+	pending = atomic_get(&acq_pending);
+	if (pending != 0) {
+		if (k_uptime_get() - sample_time[buf] < ACQ_TIMEOUT_MS) {
+			return false;
+		}
+
+		/* Give up on the missing reads, they keep the previous sample's values */
+		if (pending != acq_timed_out) {
+			LOG_ERR("Telemetry sample timed out waiting for reads 0x%lx",
+				(long)pending);
+			acq_timed_out = pending;
+		}
+		atomic_and(&acq_pending, ~pending);
+	} else {
+		acq_timed_out = 0;
+	}
+
+	/* Only successful AVS reads replace the values copied from the previous sample */
+	K_SPINLOCK(&avs_result_lock) {
+		if (avs_results.valid & ACQ_VCORE_VOLTAGE) {
+			sample->vcore_voltage = avs_results.vcore_voltage;
+		}
+		if (avs_results.valid & ACQ_VCORE_CURRENT) {
+			sample->vcore_current = avs_results.vcore_current * AVS_CURRENT_LSB_A;
+		}
+	}
+	sample->vcore_power = sample->vcore_current * sample->vcore_voltage * 0.001f;
+
+	K_SPINLOCK(&sample_lock) {
+		published = buf;
+	}
+	acq_active = false;
+
+	return true;
+}
+
 /**
  * @brief Read telemetry values that are shared by multiple components
  *
- * This function will update the cached TelemetryInternalData values if necessary.
- * Then return a copy of the values through the *data pointer.
+ * This function starts or collects a new sample of the TelemetryInternalData values if
+ * necessary, then returns a copy of the newest complete sample through the *data pointer.
+ * Only the first call waits for a sample, for at most ACQ_TIMEOUT_MS, so the values may be one
+ * sample older than max_staleness while a new one is being taken.
  *
  * @param max_staleness Maximum time interval in milliseconds since the last update
  * @param data Pointer to the TelemetryInternalData struct to fill with the values
  */
 void ReadTelemetryInternal(int64_t max_staleness, TelemetryInternalData *data)
 {
-	int64_t reftime = last_update_time;
+	/* Another thread is already sampling, so it can only be a moment behind */
+	if (k_mutex_lock(&acq_mutex, published < 0 ? K_FOREVER : K_NO_WAIT) == 0) {
+		if (acq_active) {
+			collect_sample();
+		}
 
-	if (k_uptime_delta(&reftime) >= max_staleness) {
-#ifdef CONFIG_DT_HAS_TENSTORRENT_BH_PVT_ENABLED
-		struct sensor_value avg_tmp;
-		const struct sensor_decoder_api *decoder;
+		if (!acq_active &&
+		    (published < 0 || k_uptime_get() - sample_time[published] >= max_staleness)) {
+			start_sample();
+		}
 
-		sensor_get_decoder(pvt, &decoder);
-		sensor_read(&ts_avg_iodev, &ts_avg_ctx, ts_avg_buf, sizeof(ts_avg_buf));
+		/* The PVT read completes on the RTIO work queue. collect_sample() publishes once
+		 * ACQ_TIMEOUT_MS has passed even if a read never completes.
+		 */
+		while (published < 0 && !collect_sample()) {
+			k_usleep(100);
+		}
 
-		decoder->decode(ts_avg_buf,
-				(struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS_AVG, 0}, NULL, 1,
-				&avg_tmp);
-#endif
-
-		/* Get all dynamically updated values */
-		internal_data.vcore_voltage = get_vcore();
-		AVSReadCurrent(AVS_VCORE_RAIL, &internal_data.vcore_current);
-		internal_data.vcore_power =
-			internal_data.vcore_current * internal_data.vcore_voltage * 0.001f;
-#ifdef CONFIG_DT_HAS_TENSTORRENT_BH_PVT_ENABLED
-		internal_data.asic_temperature = sensor_value_to_float(&avg_tmp);
-#endif
+		k_mutex_unlock(&acq_mutex);
+	}
 
-		/* reftime was updated to the current uptime by the k_uptime_delta() call */
-		last_update_time = reftime;
+	K_SPINLOCK(&sample_lock) {
+		*data = samples[published];
 	}
+}
 
-	*data = internal_data;
+float GetAsicTemperature(const TelemetryInternalData *data, enum asic_temp_source source)
+{
+	switch (source) {
+	case ASIC_TEMP_MAX:
+		return data->asic_temperature_max;
+	case ASIC_TEMP_WEIGHTED_MAX:
+		return data->asic_temperature +
+		       (data->asic_temperature_max - data->asic_temperature) *
+			       CONFIG_TT_BH_ARC_HOTSPOT_WEIGHT / 100.0f;
+	default:
+		return data->asic_temperature;
+	}
 }
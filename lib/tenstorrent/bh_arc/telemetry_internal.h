@@ -9,12 +9,22 @@
 #include <stdint.h>
 
 typedef struct {
-	float vcore_voltage;    /* mV */
-	float vcore_power;      /* W */
-	float vcore_current;    /* A */
-	float asic_temperature; /* degC */
+	float vcore_voltage;        /* mV */
+	float vcore_power;          /* W */
+	float vcore_current;        /* A */
+	float asic_temperature;     /* degC, mean of the PVT temperature sensors */
+	float asic_temperature_max; /* degC, hottest PVT temperature sensor */
 } TelemetryInternalData;
 
+/* Which ASIC temperature a control loop acts on */
+enum asic_temp_source {
+	ASIC_TEMP_MEAN,
+	ASIC_TEMP_MAX,
+	/* Between the mean and the hottest sensor, CONFIG_TT_BH_ARC_HOTSPOT_WEIGHT % of the way */
+	ASIC_TEMP_WEIGHTED_MAX,
+};
+
 void ReadTelemetryInternal(int64_t max_staleness, TelemetryInternalData *data);
+float GetAsicTemperature(const TelemetryInternalData *data, enum asic_temp_source source);
 
 #endif
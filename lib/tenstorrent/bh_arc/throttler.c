@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
+
 #include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/byteorder.h>
@@ -11,10 +13,15 @@
 #include "throttler.h"
 #include "aiclk_ppm.h"
 #include "cm2dm_msg.h"
+#include "dvfs.h"
+#include "dvfs_recorder.h"
 #include <zephyr/drivers/misc/bh_fwtable.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
 #include "telemetry_internal.h"
 #include "telemetry.h"
 #include "noc2axi.h"
+#include "power_accounting.h"
 #include "tensix_state_msg.h"
 
 static uint32_t power_limit;
@@ -25,24 +32,30 @@ static bool doppler_t2;
 static bool doppler_t3;
 static const bool thermal_throttling = true;
 
+static struct power_account board_power;
+static float board_power_average[POWER_WINDOW_COUNT];
+
+/* Set by ThrottlerThermalAlarm() and taken by the next DVFS tick */
+static atomic_t thm_alarm_raised;
+/* Keeps the thermal throttler from raising AICLK until the hottest sensor has cooled */
+static bool thm_alarm_held;
+
 #define kThrottlerAiclkScaleFactor 500.0F
 #define DEFAULT_BOARD_POWER_LIMIT  150
+#define THM_ALARM_RELEASE_TEMP     (PVT_TT_BH_ALARM_B_TEMP - PVT_TT_BH_ALARM_HYSTERESIS)
+
+#if defined(CONFIG_TT_BH_ARC_THM_ASIC_TEMP_MAX)
+#define THM_ASIC_TEMP ASIC_TEMP_MAX
+#elif defined(CONFIG_TT_BH_ARC_THM_ASIC_TEMP_WEIGHTED_MAX)
+#define THM_ASIC_TEMP ASIC_TEMP_WEIGHTED_MAX
+#else
+#define THM_ASIC_TEMP ASIC_TEMP_MEAN
+#endif
 
 LOG_MODULE_REGISTER(throttler);
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
-typedef enum {
-	kThrottlerTDP,
-	kThrottlerFastTDC,
-	kThrottlerTDC,
-	kThrottlerThm,
-	kThrottlerBoardPower,
-	kThrottlerGDDRThm,
-	kThrottlerDopplerSlow,
-	kThrottlerCount,
-} ThrottlerId;
-
 typedef struct {
 	float min;
 	float max;
@@ -199,6 +212,35 @@ static void doppler_tensix_state_callback(const struct zbus_channel *chan)
 ZBUS_LISTENER_DEFINE(doppler_tensix_state_listener, doppler_tensix_state_callback);
 ZBUS_CHAN_ADD_OBS(tensix_state_chan, doppler_tensix_state_listener, 0);
 
+/**
+ * @brief Step AICLK down for a thermal alarm without waiting for the next DVFS tick
+ *
+ * May be called from ISR. The thermal throttler can lower AICLK further but not raise it again
+ * until the hottest temperature sensor has cooled below THM_ALARM_RELEASE_TEMP.
+ */
+void ThrottlerThermalAlarm(void)
+{
+	atomic_set(&thm_alarm_raised, 1);
+	DVFSTickNow();
+}
+
+#ifdef CONFIG_TT_BH_ARC_THM_ALARM
+static const struct device *const pvt = DEVICE_DT_GET(DT_NODELABEL(pvt));
+
+static const struct sensor_trigger thm_alarm_trigger = {
+	.type = (enum sensor_trigger_type)SENSOR_TRIG_PVT_TT_BH_ALARM_B,
+	.chan = (enum sensor_channel)SENSOR_CHAN_PVT_TT_BH_TS_MAX,
+};
+
+static void thm_alarm_handler(const struct device *dev, const struct sensor_trigger *trigger)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(trigger);
+
+	ThrottlerThermalAlarm();
+}
+#endif
+
 void InitThrottlers(void)
 {
 	doppler = tt_bh_fwtable_get_fw_table(fwtable_dev)->feature_enable.doppler_en;
@@ -206,6 +248,16 @@ void InitThrottlers(void)
 	doppler_t2 = doppler;
 	doppler_t3 = doppler;
 
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		throttler[i].value = 0;
+		throttler[i].error = 0;
+		throttler[i].prev_error = 0;
+		throttler[i].output = 0;
+	}
+
+	PowerAccountInit(&board_power);
+	memset(board_power_average, 0, sizeof(board_power_average));
+
 	SetThrottlerLimit(kThrottlerTDP,
 			  tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.tdp_limit);
 	SetThrottlerLimit(kThrottlerFastTDC,
@@ -234,6 +286,15 @@ void InitThrottlers(void)
 
 	SetAiclkArbMax(kAiclkArbMaxDopplerCritical, GetAiclkFmin());
 	EnableArbMax(kAiclkArbMaxDopplerCritical, false); /* enabled when limit triggered */
+
+	atomic_clear(&thm_alarm_raised);
+	thm_alarm_held = false;
+
+#ifdef CONFIG_TT_BH_ARC_THM_ALARM
+	if (sensor_trigger_set(pvt, &thm_alarm_trigger, thm_alarm_handler) != 0) {
+		LOG_ERR("Failed to set up the thermal alarm");
+	}
+#endif
 }
 
 static void UpdateThrottler(ThrottlerId id, float value)
@@ -257,28 +318,24 @@ static void UpdateThrottlerArb(ThrottlerId id)
 	SetAiclkArbMax(t->arb_max, arb_val);
 }
 
-static uint16_t board_power_history[1000];
-static uint16_t *board_power_history_cursor = board_power_history;
-static uint32_t board_power_sum;
 static bool kernel_nops_enabled;
 
 static uint8_t t2_count;
 static uint8_t t3_count;
 
-#define ADVANCE_CIRCULAR_POINTER(pointer, array)                                                   \
-	do {                                                                                       \
-		if (++(pointer) == (array) + ARRAY_SIZE(array))                                    \
-			(pointer) = (array);                                                       \
-	} while (false)
-
-static uint16_t UpdateMovingAveragePower(uint16_t current_power)
+static void UpdateBoardPower(void)
 {
-	board_power_sum += current_power - *board_power_history_cursor;
-	*board_power_history_cursor = current_power;
+	PowerAccountUpdate(&board_power, GetInputPower());
 
-	ADVANCE_CIRCULAR_POINTER(board_power_history_cursor, board_power_history);
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		board_power_average[w] = PowerAccountAverage(&board_power, w);
+	}
+}
 
-	return board_power_sum / ARRAY_SIZE(board_power_history);
+/* Board input power in W, averaged over window as of the latest DVFS update */
+float GetBoardPowerAverage(enum power_window window)
+{
+	return board_power_average[window];
 }
 
 static bool DopplerActive(void)
@@ -289,9 +346,8 @@ static bool DopplerActive(void)
 static void UpdateDoppler(const TelemetryInternalData *telemetry)
 {
 	uint16_t current_power = GetInputPower();
-	uint16_t average_power = UpdateMovingAveragePower(current_power);
 
-	UpdateThrottler(kThrottlerDopplerSlow, average_power);
+	UpdateThrottler(kThrottlerDopplerSlow, board_power_average[POWER_WINDOW_1S]);
 
 	/* Doppler T2 throttler: 2x power limit for 10 consecutive samples */
 	uint32_t t2_power_limit = power_limit * 2;
@@ -325,6 +381,11 @@ static void UpdateDoppler(const TelemetryInternalData *telemetry)
 
 	bool critical_throttling = t2_triggered || t3_triggered;
 
+	if (IS_ENABLED(CONFIG_TT_BH_ARC_DVFS_RECORDER) && critical_throttling) {
+		DVFSRecorderTrigger(t3_triggered ? DVFS_RECORDER_TRIGGER_DOPPLER_T3
+						 : DVFS_RECORDER_TRIGGER_DOPPLER_T2);
+	}
+
 	bool new_kernel_nops_enabled =
 		((kernel_nops_enabled || start_nops) && !stop_nops) || critical_throttling;
 
@@ -336,11 +397,35 @@ static void UpdateDoppler(const TelemetryInternalData *telemetry)
 	EnableArbMax(kAiclkArbMaxDopplerCritical, critical_throttling);
 }
 
-void CalculateThrottlers(void)
+static void UpdateThermalAlarm(const TelemetryInternalData *telemetry)
 {
-	TelemetryInternalData telemetry_internal_data;
+	Throttler *t = &throttler[kThrottlerThm];
+
+	if (atomic_clear(&thm_alarm_raised)) {
+		float aiclk = MIN(GetThrottlerArbMax(t->arb_max), GetAiclkTarg());
 
+		SetAiclkArbMax(t->arb_max, aiclk - CONFIG_TT_BH_ARC_THM_ALARM_STEP_MHZ);
+		thm_alarm_held = true;
+
+		if (IS_ENABLED(CONFIG_TT_BH_ARC_DVFS_RECORDER)) {
+			DVFSRecorderTrigger(DVFS_RECORDER_TRIGGER_THM_ALARM);
+		}
+	} else if (thm_alarm_held && telemetry->asic_temperature_max < THM_ALARM_RELEASE_TEMP) {
+		thm_alarm_held = false;
+	}
+
+	if (thm_alarm_held) {
+		t->output = MIN(t->output, 0);
+	}
+}
+
+/* The telemetry sample the latest CalculateThrottlers() acted on */
+static TelemetryInternalData telemetry_internal_data;
+
+void CalculateThrottlers(void)
+{
 	ReadTelemetryInternal(1, &telemetry_internal_data);
+	UpdateBoardPower();
 
 	if (DopplerActive()) {
 		UpdateDoppler(&telemetry_internal_data);
@@ -351,7 +436,8 @@ void CalculateThrottlers(void)
 		UpdateThrottler(kThrottlerBoardPower, GetInputPower());
 	}
 
-	UpdateThrottler(kThrottlerThm, telemetry_internal_data.asic_temperature);
+	UpdateThrottler(kThrottlerThm, GetAsicTemperature(&telemetry_internal_data, THM_ASIC_TEMP));
+	UpdateThermalAlarm(&telemetry_internal_data);
 	UpdateThrottler(kThrottlerGDDRThm, GetMaxGDDRTemp());
 
 	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
@@ -359,6 +445,21 @@ void CalculateThrottlers(void)
 	}
 }
 
+float GetThrottlerOutput(ThrottlerId id)
+{
+	return throttler[id].output;
+}
+
+/**
+ * @brief Get the telemetry sample the latest CalculateThrottlers() acted on
+ *
+ * A sample read from telemetry afterwards may already be newer.
+ */
+void GetThrottlerTelemetry(TelemetryInternalData *telemetry)
+{
+	*telemetry = telemetry_internal_data;
+}
+
 int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size)
 {
 	if (size != 2) {
@@ -6,8 +6,28 @@
 #ifndef THROTTLER_H
 #define THROTTLER_H
 
+#include <stdint.h>
+
+#include "power_accounting.h"
+#include "telemetry_internal.h"
+
+typedef enum {
+	kThrottlerTDP,
+	kThrottlerFastTDC,
+	kThrottlerTDC,
+	kThrottlerThm,
+	kThrottlerBoardPower,
+	kThrottlerGDDRThm,
+	kThrottlerDopplerSlow,
+	kThrottlerCount,
+} ThrottlerId;
+
 void InitThrottlers(void);
 void CalculateThrottlers(void);
+float GetThrottlerOutput(ThrottlerId id);
+void GetThrottlerTelemetry(TelemetryInternalData *telemetry);
+void ThrottlerThermalAlarm(void);
+float GetBoardPowerAverage(enum power_window window);
 int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size);
 
 #endif
@@ -10,11 +10,14 @@
 
 #include <tenstorrent/bh_power.h>
 
+#include "aiclk_ppm.h"
+#include "dvfs.h"
 #include "telemetry.h"
 #include "smbus_target.h"
 #include "gddr.h"
 #include "asic_state.h"
 #include "noc_init.h"
+#include "msgqueue_stats.h"
 LOG_MODULE_REGISTER(tt_shell, CONFIG_LOG_DEFAULT_LEVEL);
 
 static int l2cpu_enable_handler(const struct shell *sh, size_t argc, char **argv)
@@ -148,12 +151,215 @@ static int telem_handler(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+static void msgstat_print_hist(const struct shell *sh, const char *name, const uint32_t *hist)
+{
+	shell_print(sh, "%s:", name);
+	for (int i = 0; i < MSGQUEUE_STATS_NUM_BUCKETS; i++) {
+		if (hist[i] == 0) {
+			continue;
+		}
+		if (i == 0) {
+			shell_print(sh, "  <1us: %u", hist[i]);
+		} else if (i == MSGQUEUE_STATS_NUM_BUCKETS - 1) {
+			shell_print(sh, "  >=%uus: %u", 1U << (i - 1), hist[i]);
+		} else {
+			shell_print(sh, "  %u-%uus: %u", 1U << (i - 1), (1U << i) - 1, hist[i]);
+		}
+	}
+}
+
+static int msgstat_handler(const struct shell *sh, size_t argc, char **argv)
+{
+	if (!IS_ENABLED(CONFIG_TT_BH_ARC_MSGQUEUE_STATS)) {
+		shell_error(sh, "Message statistics not enabled");
+		return -ENOTSUP;
+	}
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		msgqueue_stats_reset();
+		shell_print(sh, "OK");
+		return 0;
+	}
+
+	if (argc == 2) {
+		uint32_t code = strtoul(argv[1], NULL, 0);
+		const struct msgqueue_stats *s = msgqueue_stats_get(code);
+
+		if (s == NULL) {
+			shell_error(sh, "No statistics for message 0x%02X", code);
+			return -EINVAL;
+		}
+
+		shell_print(sh, "count %u", s->count);
+		msgstat_print_hist(sh, "service", s->service_hist);
+		msgstat_print_hist(sh, "queue", s->queue_hist);
+		return 0;
+	}
+
+	shell_print(sh, "code  count      svc_min_us svc_max_us svc_mean_us q_max_us   q_mean_us");
+	for (uint32_t code = 0; code < CONFIG_TT_BH_ARC_NUM_MSG_CODES; code++) {
+		const struct msgqueue_stats *s = msgqueue_stats_get(code);
+
+		if (s == NULL || s->count == 0) {
+			continue;
+		}
+
+		shell_print(sh, "0x%02X  %-10u %-10u %-10u %-11u %-10u %u", code, s->count,
+			    s->service_min_ns / 1000, s->service_max_ns / 1000,
+			    msgqueue_stats_mean_ns(s->service_total_ns, s->count) / 1000,
+			    s->queue_max_ns / 1000,
+			    msgqueue_stats_mean_ns(s->queue_total_ns, s->count) / 1000);
+	}
+	shell_print(sh, "untracked %u", msgqueue_stats_untracked());
+
+	const struct msgqueue_wakeup_stats *w = msgqueue_stats_get_wakeup();
+
+	shell_print(sh, "wakeups %u (timer %u), doorbells %u, messages %u (max %u), publishes %u",
+		    w->wakeups, w->timer_wakeups, w->doorbells, w->messages, w->max_messages,
+		    w->publishes);
+	for (int i = 0; i < MSGQUEUE_WAKEUP_NUM_BUCKETS; i++) {
+		if (i == 0) {
+			shell_print(sh, "  0 msgs: %u", w->hist[i]);
+		} else if (i == MSGQUEUE_WAKEUP_NUM_BUCKETS - 1) {
+			shell_print(sh, "  >=%u msgs: %u", 1U << (i - 1), w->hist[i]);
+		} else {
+			shell_print(sh, "  %u-%u msgs: %u", 1U << (i - 1), (1U << i) - 1,
+				    w->hist[i]);
+		}
+	}
+
+	return 0;
+}
+
+static const char *const telemetry_tier_names[TELEMETRY_TIER_COUNT] = {
+	[TELEMETRY_TIER_FAST] = "fast",
+	[TELEMETRY_TIER_MEDIUM] = "medium",
+	[TELEMETRY_TIER_SLOW] = "slow",
+};
+
+static int telemtier_handler(const struct shell *sh, size_t argc, char **argv)
+{
+	if (argc == 2) {
+		shell_error(sh, "Missing period");
+		return -EINVAL;
+	}
+
+	if (argc == 3) {
+		int tier;
+
+		for (tier = 0; tier < TELEMETRY_TIER_COUNT; tier++) {
+			if (strcmp(argv[1], telemetry_tier_names[tier]) == 0) {
+				break;
+			}
+		}
+
+		if (SetTelemetryTierPeriod(tier, strtoul(argv[2], NULL, 0)) != 0) {
+			shell_error(sh, "Invalid tier or period");
+			return -EINVAL;
+		}
+	}
+
+	shell_print(sh, "tier    period_ms runs       mean_us    max_us     total_ms");
+	for (int tier = 0; tier < TELEMETRY_TIER_COUNT; tier++) {
+		const struct telemetry_tier_stats *s = GetTelemetryTierStats(tier);
+		uint32_t mean_us = s->runs == 0 ? 0 : s->total_us / s->runs;
+
+		shell_print(sh, "%-7s %-9u %-10u %-10u %-10u %u", telemetry_tier_names[tier],
+			    s->period_ms, s->runs, mean_us, s->max_us,
+			    (uint32_t)(s->total_us / 1000));
+	}
+
+	return 0;
+}
+
+static int dvfs_handler(const struct shell *sh, size_t argc, char **argv)
+{
+	struct dvfs_stats s;
+
+	if (IS_ENABLED(CONFIG_TT_SMC_RECOVERY)) {
+		shell_error(sh, "DVFS not available");
+		return -ENOTSUP;
+	}
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		ResetDVFSStats();
+		shell_print(sh, "OK");
+		return 0;
+	}
+
+	GetDVFSStats(&s);
+	shell_print(sh, "enabled %u, period %u us, ticks %u, missed %u", dvfs_enabled, s.period_us,
+		    s.ticks, s.missed);
+	shell_print(sh, "        last_us    mean_us    max_us");
+	shell_print(sh, "exec    %-10u %-10u %u", s.exec_last_us,
+		    s.ticks == 0 ? 0 : (uint32_t)(s.exec_total_us / s.ticks), s.exec_max_us);
+	shell_print(sh, "late    %-10u %-10u %u", s.late_last_us,
+		    s.ticks == 0 ? 0 : (uint32_t)(s.late_total_us / s.ticks), s.late_max_us);
+
+	return 0;
+}
+
+static const char *const aiclk_limiter_names[AICLK_LIMITER_COUNT] = {
+	[kAiclkArbMaxFmax] = "fmax",
+	[kAiclkArbMaxTDP] = "tdp",
+	[kAiclkArbMaxFastTDC] = "fast_tdc",
+	[kAiclkArbMaxTDC] = "tdc",
+	[kAiclkArbMaxThm] = "thm",
+	[kAiclkArbMaxBoardPower] = "board_power",
+	[kAiclkArbMaxVoltage] = "voltage",
+	[kAiclkArbMaxGDDRThm] = "gddr_thm",
+	[kAiclkArbMaxDopplerSlow] = "doppler_slow",
+	[kAiclkArbMaxDopplerCritical] = "doppler_crit",
+	[AICLK_LIMITER_ARB_MIN(kAiclkArbMinFmin)] = "fmin",
+	[AICLK_LIMITER_ARB_MIN(kAiclkArbMinBusy)] = "busy",
+	[AICLK_LIMITER_FORCED] = "forced",
+	[AICLK_LIMITER_SWEEP] = "sweep",
+};
+
+static int limiters_handler(const struct shell *sh, size_t argc, char **argv)
+{
+	struct aiclk_limiter_stats s;
+
+	if (IS_ENABLED(CONFIG_TT_SMC_RECOVERY)) {
+		shell_error(sh, "DVFS not available");
+		return -ENOTSUP;
+	}
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		ResetAiclkLimiterStats();
+		shell_print(sh, "OK");
+		return 0;
+	}
+
+	shell_print(sh, "AICLK limited by %s", aiclk_limiter_names[GetAiclkLimiter()]);
+	shell_print(sh, "limiter      ticks      mean_mhz   last_ms");
+	for (uint32_t i = 0; i < AICLK_LIMITER_COUNT; i++) {
+		GetAiclkLimiterStats(i, &s);
+		if (s.ticks == 0) {
+			continue;
+		}
+
+		shell_print(sh, "%-12s %-10u %-10u %lld", aiclk_limiter_names[i], s.ticks,
+			    (uint32_t)(s.removed_mhz / s.ticks), s.last_ms);
+	}
+
+	return 0;
+}
+
 SHELL_STATIC_SUBCMD_SET_CREATE(
 	sub_tt_commands, SHELL_CMD_ARG(mrisc_power, NULL, "[off|on]", mrisc_power_handler, 2, 0),
 	SHELL_CMD_ARG(tensix_power, NULL, "[off|on]", tensix_enable_handler, 2, 0),
 	SHELL_CMD_ARG(l2cpu_power, NULL, "[off|on]", l2cpu_enable_handler, 2, 0),
 	SHELL_CMD_ARG(asic_state, NULL, "[|0|3]", asic_state_handler, 1, 1),
 	SHELL_CMD_ARG(telem, NULL, "<Telemetry Index> [|x|f|d]", telem_handler, 2, 1),
+	SHELL_CMD_ARG(msgstat, NULL, "[|reset|<msg code>]", msgstat_handler, 1, 1),
+	SHELL_CMD_ARG(telemtier, NULL, "[<fast|medium|slow> <period ms>]", telemtier_handler, 1,
+		      2),
+	SHELL_CMD_ARG(dvfs, NULL,
+		      "[|reset] periodic DVFS tick statistics. late is from the scheduled time "
+		      "to the start of a tick, missed counts scheduled times passed over",
+		      dvfs_handler, 1, 1),
+	SHELL_CMD_ARG(limiters, NULL, "[|reset]", limiters_handler, 1, 1),
 	SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(tt, &sub_tt_commands, "Tensorrent commands", NULL);
@@ -4,9 +4,17 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <errno.h>
+#include <float.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
 #include "aiclk_ppm.h"
 #include "vf_curve.h"
+#include "voltage.h"
 #include <zephyr/drivers/misc/bh_fwtable.h>
 #include <tenstorrent/msgqueue.h>
 #include <tenstorrent/smc_msg.h>
@@ -17,6 +25,22 @@
 #define VOLTAGE_MARGIN_MAX 150.0F
 #define VOLTAGE_MARGIN_MIN -150.0F
 
+/* Characterized points may be at most this far below the default curve */
+#define VF_POINT_BELOW_DEFAULT_MAX_MV 50.0F
+
+/* Domains of the lookup tables. The frequency table covers every possible fmin..fmax, and the
+ * voltage table covers the curve over that range for any margin.
+ */
+#define VF_TABLE_FREQ_MIN_MHZ    200
+#define VF_TABLE_FREQ_MAX_MHZ    1400
+#define VF_TABLE_VOLTAGE_MIN_MV  500
+#define VF_TABLE_VOLTAGE_MAX_MV  1200
+#define VF_TABLE_FREQ_ENTRIES    (VF_TABLE_FREQ_MAX_MHZ - VF_TABLE_FREQ_MIN_MHZ + 1)
+#define VF_TABLE_VOLTAGE_ENTRIES (VF_TABLE_VOLTAGE_MAX_MV - VF_TABLE_VOLTAGE_MIN_MV + 1)
+
+BUILD_ASSERT((int)AICLK_FMIN_MIN >= VF_TABLE_FREQ_MIN_MHZ);
+BUILD_ASSERT((int)AICLK_FMAX_MAX <= VF_TABLE_FREQ_MAX_MHZ);
+
 static const float vf_quadratic_coeff = 0.00031395F;
 static const float vf_linear_coeff = -0.43953F;
 static const float vf_constant = 828.83F;
@@ -24,16 +48,163 @@ static const float vf_constant = 828.83F;
 static float freq_margin_mhz = FREQ_MARGIN_MAX;
 static float voltage_margin_mv = VOLTAGE_MARGIN_MAX;
 
+/* Characterized curve of this chip, used instead of the quadratic when set */
+static struct vf_point vf_points[VF_CURVE_MAX_POINTS];
+static size_t vf_num_points;
+static enum vf_curve_source vf_source = VF_CURVE_SOURCE_DEFAULT;
+
+struct vf_tables {
+	/* Voltage in mV for each MHz, rounded down */
+	uint16_t voltage[VF_TABLE_FREQ_ENTRIES];
+	/* Highest frequency in MHz, up to AICLK fmax, whose voltage is within each mV, or 0 if
+	 * there is none
+	 */
+	uint16_t freq[VF_TABLE_VOLTAGE_ENTRIES];
+};
+
+/* The DVFS thread can preempt a rebuild, so tables are rebuilt in the buffer not in use and
+ * published with a single pointer store. A lookup sees either the old tables or the new ones.
+ */
+static struct vf_tables vf_table_bufs[2];
+static atomic_ptr_t vf_tables = ATOMIC_PTR_INIT(&vf_table_bufs[0]);
+/* Serializes rebuilds, which share the buffer not in use */
+static K_MUTEX_DEFINE(vf_tables_mutex);
+
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
+/* The default curve, without margins */
+static float vf_quadratic(float freq_mhz)
+{
+	return vf_quadratic_coeff * freq_mhz * freq_mhz + vf_linear_coeff * freq_mhz + vf_constant;
+}
+
+/* A characterized curve is only trusted if its voltage never falls as frequency rises, every
+ * point lies within the voltage and AICLK limits, and no point is far below the default curve.
+ */
+static bool vf_points_plausible(const struct vf_point *points, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (points[i].voltage_mv < voltage_arbiter.vdd_min ||
+		    points[i].voltage_mv > voltage_arbiter.vdd_max ||
+		    points[i].freq_mhz < GetAiclkFmin() || points[i].freq_mhz > GetAiclkFmax()) {
+			return false;
+		}
+
+		if (i > 0 && points[i].voltage_mv < points[i - 1].voltage_mv) {
+			return false;
+		}
+
+		if (points[i].voltage_mv <
+		    vf_quadratic(points[i].freq_mhz) - VF_POINT_BELOW_DEFAULT_MAX_MV) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Replace the curve without rebuilding the tables */
+static int set_vf_curve_points(const struct vf_point *points, size_t count)
+{
+	if (count == 0) {
+		vf_num_points = 0;
+		vf_source = VF_CURVE_SOURCE_DEFAULT;
+		return 0;
+	}
+
+	if (points == NULL || count < 2 || count > VF_CURVE_MAX_POINTS) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (points[i].voltage_mv == 0 ||
+		    (i > 0 && points[i].freq_mhz <= points[i - 1].freq_mhz)) {
+			return -EINVAL;
+		}
+	}
+
+	memcpy(vf_points, points, count * sizeof(*points));
+	vf_num_points = count;
+	vf_source = VF_CURVE_SOURCE_CUSTOM;
+
+	return 0;
+}
+
+static void LoadVFCurvePoints(void)
+{
+	const FwTable *fw_table = tt_bh_fwtable_get_fw_table(fwtable_dev);
+	struct vf_point points[VF_CURVE_MAX_POINTS];
+	size_t count = MIN(fw_table->vf_curve.points_count, VF_CURVE_MAX_POINTS);
+
+	for (size_t i = 0; i < count; i++) {
+		/* Out of range values fail validation below */
+		points[i].freq_mhz = MIN(fw_table->vf_curve.points[i].freq_mhz, UINT16_MAX);
+		points[i].voltage_mv = MIN(fw_table->vf_curve.points[i].voltage_mv, UINT16_MAX);
+	}
+
+	/* An absent, invalid or implausible curve leaves the default one in place */
+	if (count >= 2 && vf_points_plausible(points, count) &&
+	    set_vf_curve_points(points, count) == 0) {
+		vf_source = VF_CURVE_SOURCE_FWTABLE;
+	}
+}
+
+static void set_vf_curve_margins(float freq_margin, float voltage_margin)
+{
+	freq_margin_mhz = CLAMP(freq_margin, FREQ_MARGIN_MIN, FREQ_MARGIN_MAX);
+	voltage_margin_mv = CLAMP(voltage_margin, VOLTAGE_MARGIN_MIN, VOLTAGE_MARGIN_MAX);
+}
+
 void InitVFCurve(void)
 {
-	freq_margin_mhz =
-		CLAMP(tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.frequency_margin,
-		      FREQ_MARGIN_MIN, FREQ_MARGIN_MAX);
-	voltage_margin_mv =
-		CLAMP(tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.voltage_margin,
-		      VOLTAGE_MARGIN_MIN, VOLTAGE_MARGIN_MAX);
+	const FwTable *fw_table = tt_bh_fwtable_get_fw_table(fwtable_dev);
+
+	/* Curve and margins are both in place before the one rebuild */
+	LoadVFCurvePoints();
+	set_vf_curve_margins(fw_table->chip_limits.frequency_margin,
+			     fw_table->chip_limits.voltage_margin);
+	UpdateVFTables();
+}
+
+/**
+ * @brief Replace the VF curve with a piecewise linear one
+ *
+ * Voltages beyond the first and last points are extrapolated from the end segments. The
+ * margins still apply on top of the curve.
+ *
+ * @param points Points in strictly increasing frequency, or NULL to restore the default curve
+ * @param count Number of points, 2 to VF_CURVE_MAX_POINTS, or 0 to restore the default curve
+ * @return 0 on success, -EINVAL if the points are not a valid curve
+ */
+int SetVFCurvePoints(const struct vf_point *points, size_t count)
+{
+	int ret = set_vf_curve_points(points, count);
+
+	if (ret == 0) {
+		UpdateVFTables();
+	}
+
+	return ret;
+}
+
+enum vf_curve_source GetVFCurvePoints(const struct vf_point **points, size_t *count)
+{
+	*points = vf_points;
+	*count = vf_num_points;
+
+	return vf_source;
+}
+
+void SetVFCurveMargins(float freq_margin, float voltage_margin)
+{
+	set_vf_curve_margins(freq_margin, voltage_margin);
+	UpdateVFTables();
+}
+
+void GetVFCurveMargins(float *freq_margin, float *voltage_margin)
+{
+	*freq_margin = freq_margin_mhz;
+	*voltage_margin = voltage_margin_mv;
 }
 
 /**
@@ -45,12 +216,105 @@ void InitVFCurve(void)
 float VFCurve(float freq_mhz)
 {
 	float freq_with_margin_mhz = freq_mhz + freq_margin_mhz;
-	float voltage_mv = vf_quadratic_coeff * freq_with_margin_mhz * freq_with_margin_mhz +
-			   vf_linear_coeff * freq_with_margin_mhz + vf_constant;
+	float voltage_mv;
+
+	if (vf_num_points == 0) {
+		voltage_mv = vf_quadratic(freq_with_margin_mhz);
+	} else {
+		const struct vf_point *lo = &vf_points[0];
+		const struct vf_point *hi = &vf_points[1];
+
+		for (size_t i = 2; i < vf_num_points && freq_with_margin_mhz > hi->freq_mhz; i++) {
+			lo = hi;
+			hi = &vf_points[i];
+		}
+
+		float slope = ((float)hi->voltage_mv - lo->voltage_mv) /
+			      (hi->freq_mhz - lo->freq_mhz);
+
+		voltage_mv = lo->voltage_mv + (freq_with_margin_mhz - lo->freq_mhz) * slope;
+	}
 
 	return voltage_mv + voltage_margin_mv;
 }
 
+/**
+ * @brief Regenerate the VF lookup tables from VFCurve()
+ *
+ * Must be called whenever the curve, its margins or AICLK fmax change.
+ */
+void UpdateVFTables(void)
+{
+	float min_voltage_mv = FLT_MAX;
+	int voltage_mv = VF_TABLE_VOLTAGE_MAX_MV;
+	int fmax_mhz = CLAMP((int)GetAiclkFmax(), VF_TABLE_FREQ_MIN_MHZ, VF_TABLE_FREQ_MAX_MHZ);
+	struct vf_tables *tables;
+
+	k_mutex_lock(&vf_tables_mutex, K_FOREVER);
+	tables = atomic_ptr_get(&vf_tables) == &vf_table_bufs[0] ? &vf_table_bufs[1]
+								   : &vf_table_bufs[0];
+
+	for (int i = 0; i < VF_TABLE_FREQ_ENTRIES; i++) {
+		float voltage = VFCurve(VF_TABLE_FREQ_MIN_MHZ + i);
+
+		tables->voltage[i] = (uint16_t)CLAMP(voltage, 0.0F, (float)UINT16_MAX);
+	}
+
+	/* The curve is not monotonic at low frequencies, so walk down from fmax keeping the
+	 * lowest voltage seen. Each mV that this minimum reaches maps to the current frequency.
+	 */
+	for (int freq_mhz = fmax_mhz; freq_mhz >= VF_TABLE_FREQ_MIN_MHZ; freq_mhz--) {
+		min_voltage_mv = MIN(min_voltage_mv, VFCurve(freq_mhz));
+
+		while (voltage_mv >= VF_TABLE_VOLTAGE_MIN_MV && voltage_mv >= min_voltage_mv) {
+			tables->freq[voltage_mv - VF_TABLE_VOLTAGE_MIN_MV] = freq_mhz;
+			voltage_mv--;
+		}
+	}
+
+	for (; voltage_mv >= VF_TABLE_VOLTAGE_MIN_MV; voltage_mv--) {
+		tables->freq[voltage_mv - VF_TABLE_VOLTAGE_MIN_MV] = 0;
+	}
+
+	atomic_ptr_set(&vf_tables, tables);
+	k_mutex_unlock(&vf_tables_mutex);
+}
+
+/**
+ * @brief Look up the voltage for a frequency in the VF table
+ *
+ * @param freq_mhz The frequency in MHz, clamped to the table
+ * @return The voltage in mV, rounded down
+ */
+uint32_t VFCurveLookup(uint32_t freq_mhz)
+{
+	const struct vf_tables *tables = atomic_ptr_get(&vf_tables);
+
+	freq_mhz = CLAMP(freq_mhz, VF_TABLE_FREQ_MIN_MHZ, VF_TABLE_FREQ_MAX_MHZ);
+
+	return tables->voltage[freq_mhz - VF_TABLE_FREQ_MIN_MHZ];
+}
+
+/**
+ * @brief Look up the highest frequency whose voltage is within a voltage
+ *
+ * @param voltage_mv The voltage in mV
+ * @return The highest frequency in MHz up to AICLK fmax with VFCurve(freq) <= voltage_mv, or 0
+ *         if there is none
+ */
+uint32_t VFCurveMaxFreq(uint32_t voltage_mv)
+{
+	const struct vf_tables *tables = atomic_ptr_get(&vf_tables);
+
+	if (voltage_mv < VF_TABLE_VOLTAGE_MIN_MV) {
+		return 0;
+	}
+
+	voltage_mv = MIN(voltage_mv, VF_TABLE_VOLTAGE_MAX_MV);
+
+	return tables->freq[voltage_mv - VF_TABLE_VOLTAGE_MIN_MV];
+}
+
 static uint8_t get_voltage_curve_from_freq_handler(const union request *request,
 						   struct response *response)
 {
@@ -77,5 +341,23 @@ static uint8_t get_freq_curve_from_voltage_handler(const union request *request,
 	return 0;
 }
 
+static uint8_t get_vf_curve_handler(const union request *request, struct response *response)
+{
+	uint8_t first_point = request->get_vf_curve.first_point;
+
+	response->data[1] = vf_source | (vf_num_points << 8);
+	response->data[2] = (int32_t)freq_margin_mhz;
+	response->data[3] = (int32_t)voltage_margin_mv;
+
+	for (size_t i = 0; i < 4 && first_point + i < vf_num_points; i++) {
+		const struct vf_point *point = &vf_points[first_point + i];
+
+		response->data[4 + i] = point->freq_mhz | ((uint32_t)point->voltage_mv << 16);
+	}
+
+	return 0;
+}
+
 REGISTER_MESSAGE(TT_SMC_MSG_GET_VOLTAGE_CURVE_FROM_FREQ, get_voltage_curve_from_freq_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_GET_FREQ_CURVE_FROM_VOLTAGE, get_freq_curve_from_voltage_handler);
+REGISTER_MESSAGE(TT_SMC_MSG_GET_VF_CURVE, get_vf_curve_handler);
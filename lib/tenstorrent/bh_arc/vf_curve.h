@@ -6,6 +6,30 @@
 #ifndef VF_CURVE_H
 #define VF_CURVE_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+#define VF_CURVE_MAX_POINTS 16
+
+/* Where the active VF curve came from, as reported by TT_SMC_MSG_GET_VF_CURVE */
+enum vf_curve_source {
+	VF_CURVE_SOURCE_DEFAULT = 0, /* built in quadratic */
+	VF_CURVE_SOURCE_FWTABLE = 1, /* characterization points in the fw_table */
+	VF_CURVE_SOURCE_CUSTOM = 2,  /* points set at runtime */
+};
+
+struct vf_point {
+	uint16_t freq_mhz;
+	uint16_t voltage_mv;
+};
+
 void InitVFCurve(void);
+int SetVFCurvePoints(const struct vf_point *points, size_t count);
+enum vf_curve_source GetVFCurvePoints(const struct vf_point **points, size_t *count);
+void SetVFCurveMargins(float freq_margin_mhz, float voltage_margin_mv);
+void GetVFCurveMargins(float *freq_margin_mhz, float *voltage_margin_mv);
 float VFCurve(float freq_mhz);
+void UpdateVFTables(void);
+uint32_t VFCurveLookup(uint32_t freq_mhz);
+uint32_t VFCurveMaxFreq(uint32_t voltage_mv);
 #endif
@@ -82,8 +82,9 @@ uint8_t ForceVdd(uint32_t voltage)
 	}
 
 	if (dvfs_enabled) {
+		/* Applied by the DVFS thread, so it never runs alongside a DVFS tick */
 		voltage_arbiter.forced_voltage = voltage;
-		DVFSChange();
+		DVFSTickNow();
 	} else {
 		/* restore to boot voltage */
 		if (voltage == 0) {
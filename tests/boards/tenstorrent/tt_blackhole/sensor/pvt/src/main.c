@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <float.h>
+
 #include <zephyr/device.h>
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
@@ -45,6 +47,8 @@ SENSOR_DT_READ_IODEV(ts_ts_avg_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_
 		     {SENSOR_CHAN_PVT_TT_BH_TS, 5}, {SENSOR_CHAN_PVT_TT_BH_TS, 6},
 		     {SENSOR_CHAN_PVT_TT_BH_TS, 7}, {SENSOR_CHAN_PVT_TT_BH_TS_AVG, 0});
 
+SENSOR_DT_READ_IODEV(ts_sweep_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_TS_SWEEP, 0});
+
 RTIO_DEFINE(test_pvt_ctx, NUM_READS, NUM_READS);
 
 /*
@@ -246,6 +250,66 @@ ZTEST(pvt_tt_bh_tests, test_read_decode_ts_avg)
 		       celcius_from_avg_channel.val1, celcius_from_manual_avg.val1);
 }
 
+/*
+ * Test that one sweep reports the hottest sensor and the mean of the sensors it read.
+ */
+ZTEST(pvt_tt_bh_tests, test_read_decode_ts_sweep)
+{
+	const uint16_t entries = PVT_TT_BH_TS_SWEEP_ENTRIES(8);
+	uint8_t sweep_buf[sizeof(struct pvt_tt_bh_rtio_data) * PVT_TT_BH_TS_SWEEP_ENTRIES(8)];
+	struct sensor_value celcius;
+	const struct sensor_decoder_api *decoder;
+	float max_tmp = -FLT_MAX;
+	float avg_tmp = 0;
+	int ret;
+
+	ret = sensor_get_decoder(pvt, &decoder);
+	zassert_ok(ret, "Get decoder failed with %d", ret);
+
+	ret = sensor_read(&ts_sweep_iodev, &test_pvt_ctx, sweep_buf, sizeof(sweep_buf));
+	zassert_ok(ret, "Sensor read failed with %d", ret);
+
+	for (uint8_t i = 0; i < 8; i++) {
+		decoder->decode(sweep_buf, (struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS, i},
+				NULL, entries, &celcius);
+		max_tmp = MAX(max_tmp, sensor_value_to_float(&celcius));
+		avg_tmp += sensor_value_to_float(&celcius);
+	}
+	avg_tmp /= 8;
+
+	/* The summaries come from the same readings, so only rounding separates them */
+	decoder->decode(sweep_buf, (struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS_MAX, 0}, NULL,
+			entries, &celcius);
+	zassert_within(sensor_value_to_float(&celcius), max_tmp, 0.001f);
+
+	decoder->decode(sweep_buf, (struct sensor_chan_spec){SENSOR_CHAN_PVT_TT_BH_TS_AVG, 0}, NULL,
+			entries, &celcius);
+	zassert_within(sensor_value_to_float(&celcius), avg_tmp, 0.1f);
+}
+
+#ifdef CONFIG_PVT_TT_BH_SCAN
+/*
+ * With the background scan, a read of sensors that have been scanned is
+ * served from the cache instead of waiting for conversions.
+ */
+ZTEST(pvt_tt_bh_tests, test_scan_read_without_waiting)
+{
+	uint8_t sweep_buf[sizeof(struct pvt_tt_bh_rtio_data) * PVT_TT_BH_TS_SWEEP_ENTRIES(8)];
+	uint32_t start;
+	uint32_t elapsed_us;
+	int ret;
+
+	k_usleep(2 * CONFIG_PVT_TT_BH_SCAN_PERIOD_US);
+
+	start = k_cycle_get_32();
+	ret = sensor_read(&ts_sweep_iodev, &test_pvt_ctx, sweep_buf, sizeof(sweep_buf));
+	elapsed_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+	zassert_ok(ret, "Sensor read failed with %d", ret);
+	zassert_true(elapsed_us < 100, "Cached read took %u us", elapsed_us);
+}
+#endif
+
 /*
  * Test read and decode all three sensors.
  *
@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "adaptive_margin.h"
+#include "vf_curve.h"
+
+#define LEARN_SAMPLES 16
+#define HOLD_PERIODS  10
+#define FAULT_PERIODS 3
+#define AICLK_MHZ     1000
+#define VCORE_MV      800
+
+static float static_voltage_margin;
+
+static uint32_t send_op(uint8_t op, struct response *rsp)
+{
+	union request req = {0};
+
+	req.adaptive_margin.command_code = TT_SMC_MSG_ADAPTIVE_MARGIN;
+	req.adaptive_margin.op = op;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+
+	return rsp->data[0];
+}
+
+/* A sample at aiclk_mhz with the slowest process detector at pd_mhz */
+static void update_at(uint32_t aiclk_mhz, float pd_mhz, int count)
+{
+	struct adaptive_margin_sample sample = {
+		.valid = true,
+		.aiclk_limited = true,
+		.aiclk_mhz = aiclk_mhz,
+		.vcore_mv = VCORE_MV,
+		.pd_mhz = pd_mhz,
+		.vm_mv = VCORE_MV - 10,
+	};
+
+	for (int i = 0; i < count; i++) {
+		AdaptiveMarginUpdate(&sample);
+	}
+}
+
+static void update(float pd_mhz, int count)
+{
+	update_at(AICLK_MHZ, pd_mhz, count);
+}
+
+static struct adaptive_margin_status status(void)
+{
+	struct adaptive_margin_status st;
+
+	GetAdaptiveMarginStatus(&st);
+	return st;
+}
+
+static float voltage_margin(void)
+{
+	float freq_margin;
+	float voltage_margin;
+
+	GetVFCurveMargins(&freq_margin, &voltage_margin);
+	return voltage_margin;
+}
+
+static uint8_t last_event(void)
+{
+	struct adaptive_margin_history_entry entry;
+
+	zassert_ok(GetAdaptiveMarginHistory(status().history_count - 1, &entry));
+	return entry.event;
+}
+
+ZTEST(adaptive_margin, test_learn_then_trim)
+{
+	update(1000.0F, LEARN_SAMPLES - 1);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_LEARNING);
+	zassert_equal(status().trim_mv, 0);
+	zassert_equal(status().ref_slack_permille, 0);
+
+	update(1000.0F, 1);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_TRACKING);
+	zassert_equal(status().ref_slack_permille, 1000);
+	zassert_equal(status().trim_mv, CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+	zassert_equal(last_event(), ADAPTIVE_MARGIN_EVENT_TRIM_DOWN);
+
+	/* Slack within the guardband keeps trimming up to the limit */
+	update(990.0F, 100);
+	zassert_equal(status().trim_mv, CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_MAX_TRIM_MV);
+	zassert_within(voltage_margin(),
+		       static_voltage_margin - CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_MAX_TRIM_MV, 0.01F);
+}
+
+ZTEST(adaptive_margin, test_back_off_and_hold)
+{
+	uint8_t trim;
+
+	update(1000.0F, LEARN_SAMPLES + 5);
+	trim = status().trim_mv;
+
+	/* Below the guardband, but above twice the guardband */
+	update(960.0F, 1);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_TRACKING);
+	zassert_equal(status().trim_mv, trim - 2 * CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+	zassert_equal(last_event(), ADAPTIVE_MARGIN_EVENT_TRIM_UP);
+
+	update(1000.0F, HOLD_PERIODS);
+	zassert_equal(status().trim_mv, trim - 2 * CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+	update(1000.0F, 1);
+	zassert_equal(status().trim_mv, trim - CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+}
+
+ZTEST(adaptive_margin, test_anomalies_restore_static_margin)
+{
+	struct adaptive_margin_sample droop = {
+		.valid = true,
+		.aiclk_limited = true,
+		.aiclk_mhz = AICLK_MHZ,
+		.vcore_mv = VCORE_MV,
+		.pd_mhz = 1000.0F,
+		.vm_mv = VCORE_MV - CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_DROOP_LIMIT_MV - 1,
+	};
+	struct response rsp;
+
+	update(1000.0F, LEARN_SAMPLES + 3);
+	zassert_true(status().trim_mv > 0);
+
+	AdaptiveMarginUpdate(&droop);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_FALLBACK);
+	zassert_equal(status().trim_mv, 0);
+	zassert_equal(last_event(), ADAPTIVE_MARGIN_EVENT_VOLTAGE_DROOP);
+	zassert_within(voltage_margin(), static_voltage_margin, 0.01F);
+
+	/* Nothing is trimmed until the host re-enables adaptation */
+	update(1000.0F, LEARN_SAMPLES + 3);
+	zassert_equal(status().trim_mv, 0);
+
+	zassert_equal(send_op(1, &rsp), 0);
+	zassert_equal(rsp.data[1] & 0xFF, ADAPTIVE_MARGIN_LEARNING);
+
+	/* Slack lost beyond twice the guardband */
+	update(1000.0F, LEARN_SAMPLES + 3);
+	update(900.0F, 1);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_FALLBACK);
+	zassert_equal(last_event(), ADAPTIVE_MARGIN_EVENT_SLACK_LOST);
+}
+
+ZTEST(adaptive_margin, test_sensor_fault_needs_consecutive_failures)
+{
+	struct adaptive_margin_sample fault = {.valid = false};
+
+	update(1000.0F, LEARN_SAMPLES + 3);
+
+	for (int i = 0; i < FAULT_PERIODS - 1; i++) {
+		AdaptiveMarginUpdate(&fault);
+	}
+	update(1000.0F, 1);
+	for (int i = 0; i < FAULT_PERIODS - 1; i++) {
+		AdaptiveMarginUpdate(&fault);
+	}
+	zassert_equal(status().state, ADAPTIVE_MARGIN_TRACKING);
+	zassert_true(status().trim_mv > 0);
+
+	AdaptiveMarginUpdate(&fault);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_FALLBACK);
+	zassert_equal(status().trim_mv, 0);
+	zassert_equal(last_event(), ADAPTIVE_MARGIN_EVENT_SENSOR_FAULT);
+}
+
+ZTEST(adaptive_margin, test_reference_per_operating_point)
+{
+	update(1000.0F, LEARN_SAMPLES + 2);
+	zassert_equal(status().trim_mv, 3 * CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+
+	/* Less slack per MHz at a higher AICLK is not lost slack, it has its own reference */
+	update_at(1400, 1050.0F, 1);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_LEARNING);
+	zassert_equal(status().trim_mv, CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+	zassert_equal(status().ref_slack_permille, 0);
+
+	update_at(1400, 1050.0F, 1 + LEARN_SAMPLES);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_TRACKING);
+	zassert_equal(status().ref_slack_permille, 750);
+	zassert_equal(status().trim_mv, CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+
+	/* The first operating point keeps its reference */
+	update(1000.0F, 1);
+	zassert_equal(status().ref_slack_permille, 1000);
+	zassert_equal(status().trim_mv, 2 * CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_STEP_MV);
+}
+
+ZTEST(adaptive_margin, test_aging)
+{
+	struct adaptive_margin_sample sample = {
+		.valid = true,
+		.aiclk_limited = true,
+		.aiclk_mhz = AICLK_MHZ,
+		.vcore_mv = VCORE_MV,
+		.pd_mhz = 1000.0F,
+		.aging_pd_mhz = 500.0F,
+		.vm_mv = VCORE_MV,
+	};
+
+	/* The first aging reading becomes the reference */
+	AdaptiveMarginUpdate(&sample);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_LEARNING);
+
+	/* Readings at another voltage are not compared */
+	sample.vcore_mv = VCORE_MV + 50;
+	sample.vm_mv = sample.vcore_mv;
+	sample.aging_pd_mhz = 400.0F;
+	AdaptiveMarginUpdate(&sample);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_LEARNING);
+
+	sample.vcore_mv = VCORE_MV;
+	sample.vm_mv = VCORE_MV;
+	sample.aging_pd_mhz = 500.0F * (1000 - CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_AGING_LIMIT - 5) /
+			      1000;
+	AdaptiveMarginUpdate(&sample);
+	zassert_equal(status().state, ADAPTIVE_MARGIN_FALLBACK);
+	zassert_equal(last_event(), ADAPTIVE_MARGIN_EVENT_AGING);
+	zassert_true(status().aging_permille > CONFIG_TT_BH_ARC_ADAPTIVE_MARGIN_AGING_LIMIT);
+}
+
+ZTEST(adaptive_margin, test_other_operating_points_are_ignored)
+{
+	struct adaptive_margin_sample sample = {
+		.valid = true,
+		.aiclk_limited = false,
+		.aiclk_mhz = AICLK_MHZ,
+		.vcore_mv = VCORE_MV,
+		.pd_mhz = 1000.0F,
+		.vm_mv = VCORE_MV,
+	};
+	struct response rsp;
+
+	for (int i = 0; i < 2 * LEARN_SAMPLES; i++) {
+		AdaptiveMarginUpdate(&sample);
+	}
+
+	zassert_equal(send_op(0, &rsp), 0);
+	zassert_equal(rsp.data[1] & 0xFF, ADAPTIVE_MARGIN_LEARNING);
+	zassert_equal(rsp.data[3], 0);
+
+	zassert_equal(send_op(2, &rsp), 0);
+	zassert_equal(rsp.data[1] & 0xFF, ADAPTIVE_MARGIN_DISABLED);
+	zassert_equal(send_op(0xFF, &rsp), EINVAL);
+}
+
+static void *setup(void)
+{
+	float freq_margin;
+
+	GetVFCurveMargins(&freq_margin, &static_voltage_margin);
+	InitAdaptiveMargin();
+
+	return NULL;
+}
+
+static void before(void *fixture)
+{
+	struct response rsp;
+
+	ARG_UNUSED(fixture);
+
+	send_op(2, &rsp);
+	send_op(1, &rsp);
+}
+
+static void after(void *fixture)
+{
+	struct response rsp;
+
+	ARG_UNUSED(fixture);
+
+	send_op(2, &rsp);
+}
+
+ZTEST_SUITE(adaptive_margin, NULL, setup, before, after, NULL);
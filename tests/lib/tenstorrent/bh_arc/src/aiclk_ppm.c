@@ -5,10 +5,16 @@
  */
 
 #include <zephyr/ztest.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/clock_control_tt_bh.h>
 
 #include "aiclk_ppm.h"
 #include <tenstorrent/msgqueue.h>
 #include <tenstorrent/smc_msg.h>
+
+#define RAMP_TIMEOUT_MS 1000
+
+static const struct device *const pll_dev_0 = DEVICE_DT_GET(DT_NODELABEL(pll0));
 static uint32_t fmax;
 static uint32_t fmin;
 
@@ -262,4 +268,208 @@ ZTEST(aiclk_ppm, test_min_arb_greater_than_max_arb)
 		      targ_freq, fmin);
 }
 
+static uint32_t aiclk_rate(void)
+{
+	uint32_t rate;
+
+	clock_control_get_rate(pll_dev_0, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
+			       &rate);
+	return rate;
+}
+
+/* Waits for a ramp to freq and returns the highest AICLK seen on the way */
+static uint32_t wait_for_ramp(uint32_t freq)
+{
+	int64_t start = k_uptime_get();
+	uint32_t peak = GetAiclkCurr();
+
+	while (GetAiclkCurr() != freq && k_uptime_get() - start < RAMP_TIMEOUT_MS) {
+		k_sleep(K_USEC(100));
+		peak = MAX(peak, GetAiclkCurr());
+	}
+
+	zassert_equal(GetAiclkCurr(), freq);
+	zassert_equal(aiclk_rate(), freq);
+
+	return peak;
+}
+
+ZTEST(aiclk_ppm, test_ramp_is_asynchronous)
+{
+	int64_t start;
+	uint32_t prev;
+
+	zassert_equal(ForceAiclk(fmin), 0);
+	wait_for_ramp(fmin);
+
+	start = k_uptime_get();
+	zassert_equal(ForceAiclk(fmax), 0);
+
+	/* The request returns while the ramp is still in flight */
+	zassert_true(GetAiclkCurr() < fmax);
+
+	prev = GetAiclkCurr();
+	while (GetAiclkCurr() != fmax && k_uptime_get() - start < RAMP_TIMEOUT_MS) {
+		k_sleep(K_USEC(100));
+		zassert_true(GetAiclkCurr() >= prev, "AICLK fell during a ramp up");
+		prev = GetAiclkCurr();
+	}
+	wait_for_ramp(fmax);
+
+	/* The slew rate is in MHz per ms */
+	zassert_true(k_uptime_get() - start >= (fmax - fmin) / CONFIG_TT_BH_ARC_AICLK_SLEW_RATE);
+
+	zassert_equal(ForceAiclk(0), 0);
+}
+
+ZTEST(aiclk_ppm, test_ramp_is_retargeted)
+{
+	uint32_t peak;
+
+	zassert_equal(ForceAiclk(fmin), 0);
+	wait_for_ramp(fmin);
+
+	zassert_equal(ForceAiclk(fmax), 0);
+	while (GetAiclkCurr() == fmin) {
+		k_sleep(K_USEC(100));
+	}
+	zassert_true(GetAiclkCurr() < fmax);
+
+	/* A lower target turns the ramp around instead of finishing it first */
+	zassert_equal(ForceAiclk(fmin + 100), 0);
+	peak = wait_for_ramp(fmin + 100);
+	zassert_true(peak < fmax, "ramp reached %u MHz", peak);
+
+	zassert_equal(ForceAiclk(0), 0);
+}
+
+ZTEST(aiclk_ppm, test_limiter_attribution)
+{
+	struct aiclk_limiter_stats before;
+	struct aiclk_limiter_stats after;
+
+	set_busy(true);
+	EnableArbMin(kAiclkArbMinBusy, true);
+
+	SetAiclkArbMax(kAiclkArbMaxTDP, fmax - 200);
+	EnableArbMax(kAiclkArbMaxTDP, true);
+
+	SetAiclkArbMax(kAiclkArbMaxThm, fmax - 100);
+	EnableArbMax(kAiclkArbMaxThm, true);
+
+	GetAiclkLimiterStats(kAiclkArbMaxTDP, &before);
+	CalculateTargAiclk();
+	CalculateTargAiclk();
+	GetAiclkLimiterStats(kAiclkArbMaxTDP, &after);
+
+	zassert_equal(GetAiclkLimiter(), kAiclkArbMaxTDP);
+	zassert_equal(after.ticks - before.ticks, 2);
+	zassert_equal(after.removed_mhz - before.removed_mhz, 2 * 200);
+	zassert_true(after.last_ms >= before.last_ms && after.last_ms <= k_uptime_get());
+
+	/* The next lowest throttler takes over */
+	EnableArbMax(kAiclkArbMaxTDP, false);
+	CalculateTargAiclk();
+	zassert_equal(GetAiclkLimiter(), kAiclkArbMaxThm);
+
+	/* Without throttling, the busy request sets AICLK */
+	EnableArbMax(kAiclkArbMaxThm, false);
+	CalculateTargAiclk();
+	zassert_equal(GetAiclkLimiter(), AICLK_LIMITER_ARB_MIN(kAiclkArbMinBusy));
+
+	set_busy(false);
+	CalculateTargAiclk();
+	zassert_equal(GetAiclkLimiter(), AICLK_LIMITER_ARB_MIN(kAiclkArbMinFmin));
+}
+
+static void expect_removed(uint32_t limiter, uint64_t removed_mhz)
+{
+	struct aiclk_limiter_stats stats;
+
+	for (uint32_t i = 0; i < AICLK_LIMITER_COUNT; i++) {
+		GetAiclkLimiterStats(i, &stats);
+		zexpect_equal(stats.removed_mhz, i == limiter ? removed_mhz : 0, "limiter %u", i);
+	}
+}
+
+ZTEST(aiclk_ppm, test_idle_removes_nothing)
+{
+	/* A throttler above Fmin does not remove anything from an idle chip */
+	set_busy(false);
+	EnableArbMin(kAiclkArbMinFmin, true);
+	EnableArbMin(kAiclkArbMinBusy, true);
+	SetAiclkArbMax(kAiclkArbMaxTDP, fmin + 100);
+	EnableArbMax(kAiclkArbMaxTDP, true);
+
+	ResetAiclkLimiterStats();
+	CalculateTargAiclk();
+
+	zassert_equal(GetAiclkTarg(), fmin);
+	zassert_equal(GetAiclkLimiter(), AICLK_LIMITER_ARB_MIN(kAiclkArbMinFmin));
+	expect_removed(AICLK_LIMITER_COUNT, 0);
+}
+
+ZTEST(aiclk_ppm, test_single_throttler_removes_its_limit)
+{
+	set_busy(true);
+	EnableArbMin(kAiclkArbMinBusy, true);
+	SetAiclkArbMax(kAiclkArbMaxThm, fmax - 150);
+	EnableArbMax(kAiclkArbMaxThm, true);
+
+	ResetAiclkLimiterStats();
+	CalculateTargAiclk();
+
+	zassert_equal(GetAiclkLimiter(), kAiclkArbMaxThm);
+	expect_removed(kAiclkArbMaxThm, 150);
+
+	/* Against a lower busy request, the throttler only removes the difference */
+	SetAiclkArbMin(kAiclkArbMinBusy, fmax - 100);
+	ResetAiclkLimiterStats();
+	CalculateTargAiclk();
+	expect_removed(kAiclkArbMaxThm, 50);
+
+	set_busy(false);
+}
+
+static void send_limiters(uint8_t limiter, bool reset, struct response *rsp)
+{
+	union request req = {0};
+
+	req.aiclk_limiters.command_code = TT_SMC_MSG_AICLK_LIMITERS;
+	req.aiclk_limiters.limiter = limiter;
+	req.aiclk_limiters.reset = reset;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+}
+
+ZTEST(aiclk_ppm, test_limiters_message)
+{
+	struct aiclk_limiter_stats stats;
+	struct response rsp = {0};
+
+	ResetAiclkLimiterStats();
+
+	set_busy(true);
+	EnableArbMin(kAiclkArbMinBusy, true);
+	SetAiclkArbMax(kAiclkArbMaxBoardPower, fmin + 50);
+	EnableArbMax(kAiclkArbMaxBoardPower, true);
+	CalculateTargAiclk();
+
+	send_limiters(kAiclkArbMaxBoardPower, true, &rsp);
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1] & 0xFF, kAiclkArbMaxBoardPower);
+	zassert_equal(rsp.data[1] >> 8, AICLK_LIMITER_COUNT);
+	zassert_equal(rsp.data[2], 1);
+	zassert_equal(rsp.data[3], fmax - fmin - 50);
+	zassert_equal(rsp.data[4], 0);
+	zassert_true((((uint64_t)rsp.data[6] << 32) | rsp.data[5]) <= k_uptime_get());
+
+	GetAiclkLimiterStats(kAiclkArbMaxBoardPower, &stats);
+	zassert_equal(stats.ticks, 0);
+
+	send_limiters(AICLK_LIMITER_COUNT, false, &rsp);
+	zassert_equal(rsp.data[0], EINVAL);
+}
+
 ZTEST_SUITE(aiclk_ppm, NULL, aiclk_ppm_setup, reset_arb, NULL, reinit_arb);
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "avs.h"
+#include "reg_mock.h"
+
+#define AVS_CMD_REG_ADDR          0x80100000
+#define AVS_READBACK_REG_ADDR     0x80100004
+#define AVS_FIFOS_STATUS_REG_ADDR 0x80100028
+#define AVS_CFG_0_REG_ADDR        0x80100050
+
+#define AVS_CMD_DATA(cmd) (((cmd) >> 3) & 0xFFFF)
+#define AVS_CMD_RAIL(cmd) (((cmd) >> 19) & 0xF)
+#define AVS_CMD_CODE(cmd) (((cmd) >> 23) & 0xF)
+#define AVS_CMD_READ(cmd) ((((cmd) >> 28) & 0x3) == 3)
+
+#define AVS_CMD_FIFO_VACANT_SHIFT 8
+#define AVS_READBACK_FIFO_PENDING 0x10000
+#define AVS_READBACK_DATA_SHIFT   8
+#define AVS_READBACK_ACK_SHIFT    30
+
+/* Time the emulated regulator takes to answer each command, one command at a time */
+#define AVS_LATENCY_US 100
+#define AVS_FIFO_DEPTH 15
+
+/* Register model of the AVS controller and the regulator behind it */
+static struct {
+	uint16_t voltage_mv[2];
+	uint16_t current_10ma;
+	uint16_t temp_100mc;
+	uint8_t max_retries;
+	uint8_t bad_crcs; /* responses to NACK with a bad CRC */
+	uint8_t cmd_fifo_vacant;
+	uint32_t cmds;    /* commands received */
+	uint32_t responses[AVS_FIFO_DEPTH];
+	uint32_t ready_us[AVS_FIFO_DEPTH];
+	uint32_t head;
+	uint32_t count;
+	uint32_t busy_until_us;
+} avs;
+
+struct completion {
+	uintptr_t tag;
+	AVSStatus status;
+	uint16_t response;
+};
+
+static struct completion completions[AVS_MAX_PENDING_CMDS];
+static int num_completions;
+
+static uint32_t now_us(void)
+{
+	return k_cyc_to_us_floor32(k_cycle_get_32());
+}
+
+static void push_response(uint16_t data, AVSStatus ack)
+{
+	uint32_t slot = (avs.head + avs.count) % AVS_FIFO_DEPTH;
+	uint32_t start = (int32_t)(avs.busy_until_us - now_us()) > 0 ? avs.busy_until_us : now_us();
+
+	zassert_true(avs.count < AVS_FIFO_DEPTH);
+	avs.responses[slot] = (data << AVS_READBACK_DATA_SHIFT) | (ack << AVS_READBACK_ACK_SHIFT);
+	avs.ready_us[slot] = start + AVS_LATENCY_US;
+	avs.busy_until_us = avs.ready_us[slot];
+	avs.count++;
+}
+
+static uint16_t avs_execute(uint32_t cmd)
+{
+	uint32_t rail = AVS_CMD_RAIL(cmd);
+
+	switch (AVS_CMD_CODE(cmd)) {
+	case AVSCmdVoltage:
+		if (!AVS_CMD_READ(cmd)) {
+			avs.voltage_mv[rail] = AVS_CMD_DATA(cmd);
+			return 0;
+		}
+		return avs.voltage_mv[rail];
+	case AVSCmdCurrentRead:
+		return avs.current_10ma;
+	case AVSCmdTempRead:
+		return avs.temp_100mc;
+	default:
+		return 0;
+	}
+}
+
+static void avs_write_reg(uint32_t addr, uint32_t val)
+{
+	uint8_t tries = 0;
+
+	if (addr != AVS_CMD_REG_ADDR) {
+		return;
+	}
+
+	avs.cmds++;
+
+	/* The controller resends a NACKed command up to max_retries times */
+	while (avs.bad_crcs > 0 && tries <= avs.max_retries) {
+		push_response(0, AVSBadCrc);
+		avs.bad_crcs--;
+		tries++;
+	}
+	if (tries <= avs.max_retries) {
+		push_response(avs_execute(val), AVSOk);
+	}
+}
+
+static uint32_t avs_read_reg(uint32_t addr)
+{
+	uint32_t response;
+
+	switch (addr) {
+	case AVS_FIFOS_STATUS_REG_ADDR:
+		/* Model the time the APB read takes, so polling loops advance the clock */
+		k_busy_wait(1);
+		response = avs.cmd_fifo_vacant << AVS_CMD_FIFO_VACANT_SHIFT;
+		if (avs.count > 0 && (int32_t)(now_us() - avs.ready_us[avs.head]) >= 0) {
+			response |= AVS_READBACK_FIFO_PENDING;
+		}
+		return response;
+	case AVS_READBACK_REG_ADDR:
+		zassert_true(avs.count > 0);
+		response = avs.responses[avs.head];
+		avs.head = (avs.head + 1) % AVS_FIFO_DEPTH;
+		avs.count--;
+		return response;
+	case AVS_CFG_0_REG_ADDR:
+		return avs.max_retries;
+	default:
+		return 0;
+	}
+}
+
+static void record(AVSStatus status, uint16_t response, void *user_data)
+{
+	if (num_completions == ARRAY_SIZE(completions)) {
+		return;
+	}
+
+	completions[num_completions++] = (struct completion){
+		.tag = (uintptr_t)user_data,
+		.status = status,
+		.response = response,
+	};
+}
+
+static AVSCmd read_cmd(uint8_t cmd_code, uintptr_t tag)
+{
+	return (AVSCmd){
+		.cmd_code = cmd_code,
+		.rail_sel = AVS_VCORE_RAIL,
+		.cb = record,
+		.user_data = (void *)tag,
+	};
+}
+
+/* Wait until every queued command has completed */
+static void drain(void)
+{
+	while (AVSPoll() > 0) {
+		k_busy_wait(AVS_LATENCY_US);
+	}
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(&avs, 0, sizeof(avs));
+	avs.voltage_mv[AVS_VCORE_RAIL] = 750;
+	avs.current_10ma = 4200;
+	avs.temp_100mc = 553;
+	avs.cmd_fifo_vacant = AVS_FIFO_DEPTH;
+	num_completions = 0;
+
+	ReadReg_fake.custom_fake = avs_read_reg;
+	WriteReg_fake.custom_fake = avs_write_reg;
+
+	/* Commands that other suites left waiting on their own mocks get an answer here */
+	for (int pending = AVSPoll(); pending > 0; pending--) {
+		push_response(0, AVSOk);
+	}
+	drain();
+	avs.cmds = 0;
+	num_completions = 0;
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	drain();
+}
+
+ZTEST(avs, test_batch)
+{
+	AVSCmd batch[] = {
+		{
+			.cmd_code = AVSCmdVoltage,
+			.rail_sel = AVS_VCORE_RAIL,
+			.write = true,
+			.data = 800,
+			.cb = record,
+			.user_data = (void *)0,
+		},
+		read_cmd(AVSCmdCurrentRead, 1),
+		read_cmd(AVSCmdTempRead, 2),
+	};
+	uint32_t start = now_us();
+
+	zassert_equal(AVSSubmit(batch, ARRAY_SIZE(batch)), 0);
+
+	/* Submitting doesn't wait for the regulator */
+	zassert_true(now_us() - start < AVS_LATENCY_US);
+	zassert_equal(avs.cmds, 3);
+	zassert_equal(AVSPoll(), 3);
+	zassert_equal(num_completions, 0);
+
+	k_busy_wait(3 * AVS_LATENCY_US);
+	zassert_equal(AVSPoll(), 0);
+
+	zassert_equal(num_completions, 3);
+	for (int i = 0; i < num_completions; i++) {
+		zassert_equal(completions[i].tag, i);
+		zassert_equal(completions[i].status, AVSOk);
+	}
+	zassert_equal(avs.voltage_mv[AVS_VCORE_RAIL], 800);
+	zassert_equal(completions[1].response, 4200);
+	zassert_within(completions[2].response * AVS_TEMP_LSB_C, 55.3f, 0.01f);
+}
+
+ZTEST(avs, test_future)
+{
+	AVSFuture future = {0};
+	AVSCmd cmd = {
+		.cmd_code = AVSCmdVoltage,
+		.rail_sel = AVS_VCORE_RAIL,
+		.cb = AVSFutureDone,
+		.user_data = &future,
+	};
+	uint16_t voltage;
+
+	zassert_equal(AVSSubmit(&cmd, 1), 0);
+	zassert_false(future.done);
+
+	zassert_equal(AVSFutureWait(&future, &voltage), AVSOk);
+	zassert_true(future.done);
+	zassert_equal(voltage, 750);
+}
+
+ZTEST(avs, test_write_voltage_async)
+{
+	uint32_t start = now_us();
+
+	zassert_equal(AVSWriteVoltageAsync(850, AVS_VCORE_RAIL, record, (void *)3), 0);
+
+	/* Waits neither for the regulator nor for the rail to settle */
+	zassert_true(now_us() - start < AVS_LATENCY_US);
+	zassert_equal(num_completions, 0);
+
+	drain();
+	zassert_equal(num_completions, 1);
+	zassert_equal(completions[0].tag, 3);
+	zassert_equal(completions[0].status, AVSOk);
+	zassert_equal(avs.voltage_mv[AVS_VCORE_RAIL], 850);
+}
+
+ZTEST(avs, test_sync_completes_queued_first)
+{
+	float current;
+
+	zassert_equal(AVSReadVoltageAsync(AVS_VCORE_RAIL, record, (void *)7), 0);
+
+	/* The queued read's response is ahead of the synchronous one in the RX FIFO */
+	zassert_equal(AVSReadCurrent(AVS_VCORE_RAIL, &current), AVSOk);
+	zassert_within(current, 42.0f, 0.001f);
+
+	zassert_equal(num_completions, 1);
+	zassert_equal(completions[0].tag, 7);
+	zassert_equal(completions[0].response, 750);
+	zassert_equal(AVSPoll(), 0);
+}
+
+ZTEST(avs, test_queue_full)
+{
+	AVSCmd cmds[2] = {read_cmd(AVSCmdCurrentRead, 0), read_cmd(AVSCmdCurrentRead, 1)};
+
+	for (int i = 0; i < AVS_MAX_PENDING_CMDS - 1; i++) {
+		zassert_equal(AVSSubmit(cmds, 1), 0);
+	}
+
+	/* A submission is sent whole or not at all */
+	zassert_equal(AVSSubmit(cmds, 2), -EBUSY);
+	zassert_equal(avs.cmds, AVS_MAX_PENDING_CMDS - 1);
+
+	zassert_equal(AVSSubmit(cmds, 1), 0);
+	zassert_equal(AVSReadCurrentAsync(AVS_VCORE_RAIL, record, NULL), -EBUSY);
+
+	drain();
+	zassert_equal(num_completions, AVS_MAX_PENDING_CMDS);
+	zassert_equal(AVSSubmit(cmds, 2), 0);
+}
+
+ZTEST(avs, test_cmd_fifo_full)
+{
+	AVSCmd cmds[] = {read_cmd(AVSCmdCurrentRead, 0), read_cmd(AVSCmdTempRead, 1)};
+
+	/* A controller still working through earlier commands turns a submission away rather
+	 * than having it wait for room
+	 */
+	avs.cmd_fifo_vacant = 1;
+	zassert_equal(AVSSubmit(cmds, 2), -EBUSY);
+	zassert_equal(avs.cmds, 0);
+	zassert_equal(AVSPoll(), 0);
+
+	zassert_equal(AVSSubmit(cmds, 1), 0);
+	avs.cmd_fifo_vacant = 0;
+	zassert_equal(AVSReadCurrentAsync(AVS_VCORE_RAIL, record, NULL), -EBUSY);
+
+	avs.cmd_fifo_vacant = AVS_FIFO_DEPTH;
+	zassert_equal(AVSSubmit(cmds, 2), 0);
+	drain();
+	zassert_equal(num_completions, 3);
+}
+
+ZTEST(avs, test_retry)
+{
+	uint16_t voltage;
+
+	/* A retried command completes once, with the response to the retry */
+	avs.max_retries = 2;
+	avs.bad_crcs = 1;
+	zassert_equal(AVSReadVoltageAsync(AVS_VCORE_RAIL, record, NULL), 0);
+	drain();
+	zassert_equal(num_completions, 1);
+	zassert_equal(completions[0].status, AVSOk);
+	zassert_equal(completions[0].response, 750);
+
+	/* Without retries the NACK is the response */
+	avs.max_retries = 0;
+	avs.bad_crcs = 1;
+	zassert_equal(AVSReadVoltage(AVS_VCORE_RAIL, &voltage), AVSBadCrc);
+	zassert_equal(voltage, 0xffff);
+	zassert_equal(AVSPoll(), 0);
+}
+
+ZTEST_SUITE(avs, NULL, NULL, before, after, NULL);
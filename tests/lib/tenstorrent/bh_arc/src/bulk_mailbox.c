@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+#include <tenstorrent/smc_msg.h>
+#include <tenstorrent/msgqueue.h>
+
+#include "bulk_mailbox.h"
+
+/* Payload bytes an 8 word request can carry after the command word */
+#define INLINE_PAYLOAD_BYTES ((REQUEST_MSG_LEN - 1) * sizeof(uint32_t))
+
+static uint32_t round_trips;
+
+static void send_msg(union request *req, struct response *rsp)
+{
+	msgqueue_request_push(0, req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+	round_trips++;
+}
+
+static uint8_t *get_mailbox(uint32_t *size)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.bulk_mailbox.command_code = TT_SMC_MSG_BULK_MAILBOX;
+	req.bulk_mailbox.op = BULK_MAILBOX_OP_INFO;
+	send_msg(&req, &rsp);
+	zassert_equal(rsp.data[0], 0);
+
+	*size = rsp.data[2];
+	return (uint8_t *)rsp.data[1];
+}
+
+ZTEST(bulk_mailbox, test_info)
+{
+	uint32_t size;
+	uint8_t *mailbox = get_mailbox(&size);
+
+	zexpect_equal(size, CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE);
+	zexpect_equal_ptr(mailbox, bulk_mailbox_region(0, size));
+}
+
+ZTEST(bulk_mailbox, test_checksum_round_trip)
+{
+	union request req = {0};
+	struct response rsp = {0};
+	uint32_t size;
+	uint8_t *mailbox = get_mailbox(&size);
+
+	for (uint32_t i = 0; i < size; i++) {
+		mailbox[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	/* The whole mailbox moves and is verified in one round trip */
+	round_trips = 0;
+	req.bulk_mailbox.command_code = TT_SMC_MSG_BULK_MAILBOX;
+	req.bulk_mailbox.op = BULK_MAILBOX_OP_CHECKSUM;
+	req.bulk_mailbox.xfer.offset = 0;
+	req.bulk_mailbox.xfer.length = size;
+
+	uint64_t start = k_cycle_get_64();
+
+	send_msg(&req, &rsp);
+
+	uint64_t elapsed_us = MAX(k_cyc_to_us_ceil64(k_cycle_get_64() - start), 1);
+
+	zexpect_equal(rsp.data[0], 0);
+	zexpect_equal(rsp.data[1], crc32_ieee(mailbox, size));
+	zexpect_equal(round_trips, 1);
+
+	uint32_t inline_round_trips = DIV_ROUND_UP(size, INLINE_PAYLOAD_BYTES);
+
+	TC_PRINT("%u bytes in %llu us (%llu KiB/s): %u bulk round trip(s), %u inline round trips\n",
+		 size, elapsed_us, (uint64_t)size * USEC_PER_SEC / 1024 / elapsed_us, round_trips,
+		 inline_round_trips);
+	zexpect_true(inline_round_trips > round_trips);
+
+	/* A sub-region */
+	req.bulk_mailbox.xfer.offset = 100;
+	req.bulk_mailbox.xfer.length = 256;
+	send_msg(&req, &rsp);
+	zexpect_equal(rsp.data[1], crc32_ieee(&mailbox[100], 256));
+}
+
+ZTEST(bulk_mailbox, test_out_of_bounds)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.bulk_mailbox.command_code = TT_SMC_MSG_BULK_MAILBOX;
+	req.bulk_mailbox.op = BULK_MAILBOX_OP_CHECKSUM;
+	req.bulk_mailbox.xfer.offset = CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE - 4;
+	req.bulk_mailbox.xfer.length = 8;
+	send_msg(&req, &rsp);
+	zexpect_equal(rsp.data[0], EINVAL);
+
+	/* offset + length must not wrap */
+	zexpect_is_null(bulk_mailbox_region(8, UINT32_MAX));
+	zexpect_is_null(bulk_mailbox_region(CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE + 1, 0));
+	zexpect_not_null(bulk_mailbox_region(CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE, 0));
+
+	req.bulk_mailbox.op = 0xFF;
+	send_msg(&req, &rsp);
+	zexpect_equal(rsp.data[0], EINVAL);
+}
+
+ZTEST(bulk_mailbox, test_get_verifies_checksum)
+{
+	uint8_t *region = bulk_mailbox_region(0, 64);
+	uint8_t *data = NULL;
+
+	zassert_not_null(region);
+	memset(region, 0x5A, 64);
+
+	uint32_t crc = crc32_ieee(region, 64);
+
+	zexpect_equal(bulk_mailbox_get(0, 64, crc, &data), 0);
+	zexpect_equal_ptr(data, region);
+	zexpect_equal(bulk_mailbox_get(0, 64, crc ^ 1, &data), -EBADMSG);
+	zexpect_equal(bulk_mailbox_get(0, CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE + 1, crc, &data),
+		      -EINVAL);
+}
+
+ZTEST_SUITE(bulk_mailbox, NULL, NULL, NULL, NULL, NULL);
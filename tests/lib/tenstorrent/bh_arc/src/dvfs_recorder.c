@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/ztest.h>
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "bulk_mailbox.h"
+#include "cat.h"
+#include "dvfs_recorder.h"
+
+#define ENTRIES      CONFIG_TT_BH_ARC_DVFS_RECORDER_ENTRIES
+#define POST_TRIGGER CONFIG_TT_BH_ARC_DVFS_RECORDER_POST_TRIGGER
+
+static uint32_t next_timestamp;
+
+static void add(float temperature, int count)
+{
+	struct dvfs_record rec = {
+		.asic_temperature = temperature,
+		.targ_freq = 800,
+		.limiter = kAiclkArbMaxTDP,
+	};
+
+	for (int i = 0; i < count; i++) {
+		rec.timestamp_us = next_timestamp++;
+		DVFSRecorderAdd(&rec);
+	}
+}
+
+static struct dvfs_recorder_status status(void)
+{
+	struct dvfs_recorder_status st;
+
+	GetDVFSRecorderStatus(&st);
+	return st;
+}
+
+static uint32_t send(const struct dvfs_recorder_rqst *rqst, struct response *rsp)
+{
+	union request req = {0};
+
+	req.dvfs_recorder = *rqst;
+	req.dvfs_recorder.command_code = TT_SMC_MSG_DVFS_RECORDER;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+
+	return rsp->data[0];
+}
+
+ZTEST(dvfs_recorder, test_trigger_freezes_after_post_trigger)
+{
+	struct dvfs_record rec;
+
+	add(50.0F, 3);
+	DVFSRecorderTrigger(DVFS_RECORDER_TRIGGER_DOPPLER_T3);
+	/* Later triggers do not replace the first */
+	DVFSRecorderTrigger(DVFS_RECORDER_TRIGGER_DOPPLER_T2);
+
+	add(50.0F, POST_TRIGGER);
+	zassert_equal(status().state, DVFS_RECORDER_TRIGGERED);
+	add(50.0F, 1);
+	zassert_equal(status().state, DVFS_RECORDER_FROZEN);
+	zassert_equal(status().trigger, DVFS_RECORDER_TRIGGER_DOPPLER_T3);
+	zassert_equal(status().trigger_tick, 3);
+	zassert_equal(status().count, 3 + POST_TRIGGER + 1);
+
+	/* Frozen ticks are kept */
+	add(50.0F, ENTRIES);
+	zassert_equal(status().count, 3 + POST_TRIGGER + 1);
+	zassert_ok(GetDVFSRecord(3, &rec));
+	zassert_equal(rec.timestamp_us, 3);
+	zassert_equal(GetDVFSRecord(3 + POST_TRIGGER + 1, &rec), -ENOENT);
+}
+
+ZTEST(dvfs_recorder, test_thermal_trigger)
+{
+	add(T_J_SHUTDOWN - CONFIG_TT_BH_ARC_DVFS_RECORDER_THERMAL_MARGIN - 1.0F, ENTRIES + 5);
+	zassert_equal(status().state, DVFS_RECORDER_RECORDING);
+
+	add(T_J_SHUTDOWN - CONFIG_TT_BH_ARC_DVFS_RECORDER_THERMAL_MARGIN, 1);
+	zassert_equal(status().state, POST_TRIGGER > 0 ? DVFS_RECORDER_TRIGGERED
+						       : DVFS_RECORDER_FROZEN);
+	zassert_equal(status().trigger, DVFS_RECORDER_TRIGGER_THERMAL);
+	zassert_equal(status().trigger_tick, ENTRIES + 5);
+}
+
+ZTEST(dvfs_recorder, test_host_read)
+{
+	struct dvfs_recorder_rqst rqst = {0};
+	struct response rsp;
+	struct dvfs_record rec;
+	uint32_t length = ENTRIES * sizeof(rec);
+	uint8_t *mailbox = bulk_mailbox_region(0, length);
+
+	zassert_not_null(mailbox);
+	add(50.0F, ENTRIES + 5);
+
+	rqst.op = 2;
+	zassert_equal(send(&rqst, &rsp), 0);
+	zassert_equal(rsp.data[1] & 0xFF, DVFS_RECORDER_FROZEN);
+	zassert_equal((rsp.data[1] >> 8) & 0xFF, DVFS_RECORDER_TRIGGER_HOST);
+	zassert_equal(rsp.data[1] >> 16, sizeof(rec));
+	zassert_equal(rsp.data[2], ENTRIES + 5);
+	zassert_equal(rsp.data[3], ENTRIES + 5);
+	zassert_equal(rsp.data[4], ENTRIES);
+
+	rqst.op = 1;
+	rqst.first = 5;
+	rqst.num_records = ENTRIES;
+	zassert_equal(send(&rqst, &rsp), 0);
+	zassert_equal(rsp.data[1], bulk_mailbox_checksum(mailbox, length));
+	for (uint32_t i = 0; i < ENTRIES; i++) {
+		memcpy(&rec, mailbox + i * sizeof(rec), sizeof(rec));
+		zassert_equal(rec.timestamp_us, 5 + i);
+		zassert_equal(rec.targ_freq, 800);
+	}
+
+	/* The oldest ticks have been overwritten */
+	rqst.first = 4;
+	zassert_equal(send(&rqst, &rsp), ENOENT);
+
+	rqst.first = 5;
+	rqst.offset = CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE;
+	zassert_equal(send(&rqst, &rsp), EINVAL);
+
+	rqst.op = 3;
+	zassert_equal(send(&rqst, &rsp), 0);
+	zassert_equal(rsp.data[1] & 0xFFFF, DVFS_RECORDER_RECORDING);
+	zassert_equal(rsp.data[2], 0);
+
+	rqst.op = 0xFF;
+	zassert_equal(send(&rqst, &rsp), EINVAL);
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	DVFSRecorderArm();
+	next_timestamp = 0;
+}
+
+ZTEST_SUITE(dvfs_recorder, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Closed-loop DVFS simulation. The real throttlers, AICLK and voltage arbiters run against a
+ * plant model of the chip and board, which answers their sensor reads through the register
+ * mocks: VCORE current and voltage over AVS, the VCORE setpoint over the regulator I2C bus and
+ * board power from the DMC power message. Workload traces are replayed one DVFS tick at a time,
+ * and each run reports how AICLK settled.
+ *
+ * There is no PVT sensor on native_sim, so the thermal throttler reads 0 C. The junction
+ * temperature is still modelled for its effect on leakage. The PVT emulator only raises the
+ * thermal alarm.
+ */
+
+#include <stdlib.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "aiclk_ppm.h"
+#include "cm2dm_msg.h"
+#include "dvfs.h"
+#include "reg_mock.h"
+#include "throttler.h"
+#include "timer.h"
+#include "voltage.h"
+
+#define TICK_MS 1
+
+static const struct device *const pvt = DEVICE_DT_GET(DT_NODELABEL(pvt));
+
+/* Plant model */
+#define DYN_W_PER_MHZ_V2 0.17F  /* switching power per MHz per V^2 at full activity */
+#define LEAK_W           8.0F   /* leakage at 0.8 V and 45 C */
+#define LEAK_PER_C       0.02F  /* relative leakage increase per degree */
+#define AMBIENT_C        35.0F
+#define THETA_C_PER_W    0.4F   /* junction to ambient */
+#define THERMAL_TAU_MS   200.0F
+#define VR_EFFICIENCY    0.88F
+#define REST_OF_BOARD_W  40.0F
+
+/* AICLK is settled once it stays within this band around its final value */
+#define SETTLE_BAND_PERCENT 2
+#define SETTLE_BAND_MHZ     10
+/* The final value is the average over this last part of the trace */
+#define FINAL_WINDOW_PERCENT 20
+
+/* Regression limits for a step to full load, which the TDC throttlers bind at about 300 MHz.
+ *
+ * Leakage keeps rising with the junction temperature for a few THERMAL_TAU_MS after the step,
+ * and AICLK follows it down through the slow TDC filter (alpha 0.1, about 10 ticks). The model
+ * settles in under 100 ms, and 500 ms is two and a half thermal time constants.
+ *
+ * The first tick at full load sees a current several times the limit, and the next still acts
+ * on a sample from before the AICLK drop, so AICLK briefly hits Fmin. That undershoot is
+ * bounded by (final - Fmin) / (AICLK before the step - final), about 12% for this plant.
+ */
+#define MAX_SETTLING_MS       500
+#define MAX_OVERSHOOT_PERCENT 15
+
+#define REFCLK_LO_REG_ADDR 0x800300E0
+#define REFCLK_HI_REG_ADDR 0x800300E4
+
+#define AVS_CMD_REG_ADDR          0x80100000
+#define AVS_READBACK_REG_ADDR     0x80100004
+#define AVS_FIFOS_STATUS_REG_ADDR 0x80100028
+#define AVS_CMD_CODE(cmd)         (((cmd) >> 23) & 0xF)
+#define AVS_CMD_VOLTAGE           0x0
+#define AVS_CMD_CURRENT           0x2
+#define AVS_CMD_FIFO_VACANT       0xF00
+#define AVS_READBACK_FIFO_PENDING 0x10000
+#define AVS_READBACK_DATA_SHIFT   8
+#define AVS_FIFO_DEPTH            8
+
+/* The VCORE regulator is on the PMBus I2C controller */
+#define I2C_BASE_ADDR       0x80090000
+#define I2C_TAR_REG_ADDR    (I2C_BASE_ADDR + 0x04)
+#define I2C_DATA_REG_ADDR   (I2C_BASE_ADDR + 0x10)
+#define I2C_STATUS_REG_ADDR (I2C_BASE_ADDR + 0x70)
+#define I2C_STATUS_IDLE     0x6 /* TX FIFO not full and empty, master idle */
+#define I2C_DATA_STOP       BIT(9)
+#define VCORE_I2C_ADDR      0x64
+#define PMBUS_VOUT_COMMAND  0x21
+
+struct trace_step {
+	uint32_t duration_ms;
+	float activity; /* fraction of the chip switching */
+};
+
+struct sim_result {
+	uint32_t avg_aiclk;
+	uint32_t final_aiclk;
+	uint32_t settling_ms;       /* from the load step until AICLK stays in the settle band */
+	uint32_t overshoot_percent; /* of the AICLK correction after the load step */
+	uint32_t peak_power;
+	uint32_t peak_temp;
+};
+
+static struct {
+	float activity;
+	float vcore_mv;
+	float temp_c;
+} plant;
+
+static uint32_t avs_responses[AVS_FIFO_DEPTH];
+static uint32_t avs_head;
+static uint32_t avs_count;
+
+static uint32_t i2c_target;
+static uint8_t i2c_frame[4];
+static uint32_t i2c_frame_len;
+
+static float core_power(void)
+{
+	float vcore = plant.vcore_mv / 1000.0F;
+	float dynamic = DYN_W_PER_MHZ_V2 * plant.activity * GetAiclkCurr() * vcore * vcore;
+	float leakage = LEAK_W * vcore / 0.8F * (1.0F + LEAK_PER_C * (plant.temp_c - 45.0F));
+
+	return dynamic + leakage;
+}
+
+static void step_plant(void)
+{
+	float power = core_power();
+	uint16_t board_power = power / VR_EFFICIENCY + REST_OF_BOARD_W;
+
+	plant.temp_c += (AMBIENT_C + THETA_C_PER_W * power - plant.temp_c) * TICK_MS /
+			THERMAL_TAU_MS;
+
+	/* The DMC reports board power every tick */
+	Dm2CmSendPowerHandler((const uint8_t *)&board_power, sizeof(board_power));
+}
+
+static void avs_command(uint32_t cmd)
+{
+	uint32_t slot;
+	uint32_t response;
+
+	if (AVS_CMD_CODE(cmd) == AVS_CMD_VOLTAGE) {
+		response = plant.vcore_mv;
+	} else if (AVS_CMD_CODE(cmd) == AVS_CMD_CURRENT) {
+		/* 10 mA units */
+		response = core_power() / plant.vcore_mv * 100000.0F;
+	} else {
+		response = 0;
+	}
+
+	zassert_true(avs_count < AVS_FIFO_DEPTH);
+	slot = (avs_head + avs_count) % AVS_FIFO_DEPTH;
+	avs_responses[slot] = response << AVS_READBACK_DATA_SHIFT;
+	avs_count++;
+}
+
+static void i2c_data(uint32_t data)
+{
+	if (i2c_frame_len < ARRAY_SIZE(i2c_frame)) {
+		i2c_frame[i2c_frame_len++] = data & 0xFF;
+	}
+
+	if (data & I2C_DATA_STOP) {
+		if (i2c_target == VCORE_I2C_ADDR && i2c_frame_len == 3 &&
+		    i2c_frame[0] == PMBUS_VOUT_COMMAND) {
+			/* VOUT_COMMAND is in 0.5 mV units */
+			plant.vcore_mv = (i2c_frame[1] | (i2c_frame[2] << 8)) / 2.0F;
+		}
+		i2c_frame_len = 0;
+	}
+}
+
+static void sim_write_reg(uint32_t addr, uint32_t val)
+{
+	switch (addr) {
+	case AVS_CMD_REG_ADDR:
+		avs_command(val);
+		break;
+	case I2C_TAR_REG_ADDR:
+		i2c_target = val;
+		break;
+	case I2C_DATA_REG_ADDR:
+		i2c_data(val);
+		break;
+	default:
+		break;
+	}
+}
+
+static uint64_t refclk(void)
+{
+	return (uint64_t)k_cyc_to_us_floor32(k_cycle_get_32()) * WAIT_1US;
+}
+
+static uint32_t sim_read_reg(uint32_t addr)
+{
+	uint32_t response;
+
+	switch (addr) {
+	case REFCLK_LO_REG_ADDR:
+		/* Let busy-wait loops advance the clock */
+		k_busy_wait(1);
+		return (uint32_t)refclk();
+	case REFCLK_HI_REG_ADDR:
+		return refclk() >> 32;
+	case AVS_FIFOS_STATUS_REG_ADDR:
+		return AVS_CMD_FIFO_VACANT | (avs_count > 0 ? AVS_READBACK_FIFO_PENDING : 0);
+	case AVS_READBACK_REG_ADDR:
+		zassert_true(avs_count > 0);
+		response = avs_responses[avs_head];
+		avs_head = (avs_head + 1) % AVS_FIFO_DEPTH;
+		avs_count--;
+		return response;
+	case I2C_STATUS_REG_ADDR:
+		return I2C_STATUS_IDLE;
+	default:
+		return 0;
+	}
+}
+
+static void set_busy(bool busy)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.aiclk_set_speed.command_code =
+		busy ? TT_SMC_MSG_AICLK_GO_BUSY : TT_SMC_MSG_AICLK_GO_LONG_IDLE;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+}
+
+static void wait_for_ramp(void)
+{
+	int64_t timeout = k_uptime_get() + 100;
+
+	while (GetAiclkCurr() != GetAiclkTarg() && k_uptime_get() < timeout) {
+		k_sleep(K_USEC(100));
+	}
+	/* Let the DVFS thread act on the end of the ramp */
+	k_sleep(K_MSEC(TICK_MS));
+}
+
+/* Replays a trace and measures the AICLK response to the load step at step_ms */
+static struct sim_result run_trace(const char *name, const struct trace_step *trace,
+				   size_t num_steps, uint32_t step_ms)
+{
+	static uint16_t aiclk[2000];
+	struct sim_result result = {0};
+	uint32_t ticks = 0;
+	uint64_t aiclk_sum = 0;
+	uint32_t final_ticks;
+	uint32_t band;
+	uint32_t lowest;
+	int32_t last_outside = -1;
+
+	for (size_t i = 0; i < num_steps; i++) {
+		plant.activity = trace[i].activity;
+
+		for (uint32_t t = 0; t < trace[i].duration_ms; t += TICK_MS) {
+			zassert_true(ticks < ARRAY_SIZE(aiclk), "trace too long");
+
+			step_plant();
+			DVFSChange();
+			k_sleep(K_MSEC(TICK_MS));
+
+			aiclk[ticks] = GetAiclkCurr();
+			aiclk_sum += aiclk[ticks];
+			result.peak_power = MAX(result.peak_power, (uint32_t)core_power());
+			result.peak_temp = MAX(result.peak_temp, (uint32_t)plant.temp_c);
+			ticks++;
+		}
+	}
+
+	final_ticks = MAX(ticks * FINAL_WINDOW_PERCENT / 100, 1);
+	for (uint32_t i = ticks - final_ticks; i < ticks; i++) {
+		result.final_aiclk += aiclk[i];
+	}
+	result.final_aiclk /= final_ticks;
+	result.avg_aiclk = aiclk_sum / ticks;
+
+	band = MAX(result.final_aiclk * SETTLE_BAND_PERCENT / 100, SETTLE_BAND_MHZ);
+	lowest = result.final_aiclk;
+	for (uint32_t i = step_ms / TICK_MS; i < ticks; i++) {
+		if (abs((int32_t)aiclk[i] - (int32_t)result.final_aiclk) > band) {
+			last_outside = i;
+		}
+		lowest = MIN(lowest, aiclk[i]);
+	}
+	result.settling_ms = last_outside < 0 ? 0 : (last_outside + 1) * TICK_MS - step_ms;
+
+	/* How far AICLK fell past its final value, relative to the fall it needed */
+	if (step_ms > 0 && aiclk[step_ms / TICK_MS - 1] > result.final_aiclk) {
+		result.overshoot_percent = (result.final_aiclk - lowest) * 100 /
+					   (aiclk[step_ms / TICK_MS - 1] - result.final_aiclk);
+	}
+
+	TC_PRINT("%s: average AICLK %u MHz, final %u MHz, settling %u ms, overshoot %u%%, "
+		 "peak power %u W, peak temperature %u C\n",
+		 name, result.avg_aiclk, result.final_aiclk, result.settling_ms,
+		 result.overshoot_percent, result.peak_power, result.peak_temp);
+
+	return result;
+}
+
+ZTEST(dvfs_sim, test_light_load_is_not_throttled)
+{
+	static const struct trace_step trace[] = {
+		{.duration_ms = 500, .activity = 0.1F},
+	};
+	struct sim_result result = run_trace("light load", trace, ARRAY_SIZE(trace), 0);
+
+	zassert_equal(result.avg_aiclk, GetAiclkFmax());
+	zassert_equal(result.settling_ms, 0);
+}
+
+ZTEST(dvfs_sim, test_load_step_settles)
+{
+	static const struct trace_step trace[] = {
+		{.duration_ms = 100, .activity = 0.1F},
+		{.duration_ms = 1000, .activity = 1.0F},
+	};
+	struct sim_result result = run_trace("load step", trace, ARRAY_SIZE(trace), 100);
+
+	zassert_true(result.final_aiclk < GetAiclkFmax(), "full load was not throttled");
+	zassert_true(result.final_aiclk > GetAiclkFmin(), "throttled to Fmin");
+	zassert_true(result.settling_ms <= MAX_SETTLING_MS, "settling took %u ms",
+		     result.settling_ms);
+	zassert_true(result.overshoot_percent <= MAX_OVERSHOOT_PERCENT, "overshoot %u%%",
+		     result.overshoot_percent);
+}
+
+ZTEST(dvfs_sim, test_bursty_load)
+{
+	static const struct trace_step burst[] = {
+		{.duration_ms = 25, .activity = 1.0F},
+		{.duration_ms = 25, .activity = 0.1F},
+	};
+	struct trace_step trace[2 * 20];
+	struct sim_result result;
+
+	for (size_t i = 0; i < ARRAY_SIZE(trace); i++) {
+		trace[i] = burst[i % ARRAY_SIZE(burst)];
+	}
+
+	result = run_trace("bursty load", trace, ARRAY_SIZE(trace), 0);
+
+	zassert_true(result.avg_aiclk < GetAiclkFmax());
+	zassert_true(result.avg_aiclk > GetAiclkFmin());
+}
+
+ZTEST(dvfs_sim, test_tick_stats)
+{
+	const uint32_t period_us = CONFIG_TT_BH_ARC_DVFS_PERIOD_US;
+	struct dvfs_stats stats;
+
+	ResetDVFSStats();
+	StartDVFSTimer();
+
+	/* Halfway between the 10th and 11th ticks */
+	k_sleep(K_USEC(10 * period_us + period_us / 2));
+	GetDVFSStats(&stats);
+	zassert_equal(stats.ticks, 10);
+	zassert_equal(stats.missed, 0);
+	zassert_true(stats.late_max_us < period_us / 2, "late %u us", stats.late_max_us);
+
+	/* Hold the DVFS thread off past three scheduled ticks. It then runs one tick, for the
+	 * 13th, late by three quarters of a period, and the 11th and 12th are missed.
+	 */
+	k_sched_lock();
+	k_busy_wait(3 * period_us + period_us / 4);
+	k_sched_unlock();
+	k_sleep(K_USEC(period_us / 10));
+	GetDVFSStats(&stats);
+	zassert_equal(stats.ticks, 11);
+	zassert_equal(stats.missed, 2);
+	zassert_within(stats.late_last_us, 3 * period_us / 4, period_us / 10, "late %u us",
+		       stats.late_last_us);
+
+	/* Back on schedule, with nothing counted twice */
+	k_sleep(K_USEC(2 * period_us));
+	GetDVFSStats(&stats);
+	zassert_equal(stats.ticks, 13);
+	zassert_equal(stats.missed, 2);
+	zassert_true(stats.late_last_us < period_us / 2, "late %u us", stats.late_last_us);
+}
+
+static void force_aiclk(uint32_t freq)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.data[0] = TT_SMC_MSG_FORCE_AICLK;
+	req.data[1] = freq;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+	zassert_equal(rsp.data[0], 0);
+}
+
+ZTEST(dvfs_sim, test_force_aiclk_with_timer_running)
+{
+	const uint32_t period_us = CONFIG_TT_BH_ARC_DVFS_PERIOD_US;
+	const uint32_t forced = GetAiclkFmin() + 200;
+	struct dvfs_stats stats;
+
+	ResetDVFSStats();
+	StartDVFSTimer();
+
+	/* Force and release AICLK at points spread across the tick period. The handler only
+	 * records the request, and the DVFS thread applies it between periodic ticks.
+	 */
+	for (int i = 0; i < 20; i++) {
+		step_plant();
+		force_aiclk(i % 2 == 0 ? forced : 0);
+		k_sleep(K_USEC(period_us / 3));
+	}
+
+	/* The DVFS thread picks each request up once this thread sleeps */
+	force_aiclk(forced);
+	k_sleep(K_USEC(100));
+	wait_for_ramp();
+	zassert_equal(GetAiclkTarg(), forced);
+	zassert_equal(GetAiclkCurr(), forced);
+	zassert_equal(voltage_arbiter.curr_voltage, voltage_arbiter.targ_voltage);
+
+	/* The forced changes ran as off-schedule ticks, and the periodic ones kept going */
+	GetDVFSStats(&stats);
+	zassert_true(stats.ticks > 0);
+	zassert_equal(stats.missed, 0);
+
+	force_aiclk(0);
+	k_sleep(K_USEC(100));
+	wait_for_ramp();
+	zassert_equal(GetAiclkTarg(), GetAiclkFmax());
+}
+
+ZTEST(dvfs_sim, test_thermal_alarm_steps_aiclk_down)
+{
+	static const struct trace_step trace[] = {
+		{.duration_ms = 100, .activity = 0.1F},
+	};
+	struct dvfs_stats stats;
+	uint32_t before;
+
+	run_trace("before thermal alarm", trace, ARRAY_SIZE(trace), 0);
+	before = GetAiclkTarg();
+	ResetDVFSStats();
+
+	/* The throttler subscribed to alarm B in InitThrottlers(). The DVFS thread takes the
+	 * alarm at once rather than at the next tick.
+	 */
+	zassert_ok(pvt_tt_bh_emul_raise_alarm(pvt, SENSOR_TRIG_PVT_TT_BH_ALARM_B));
+	k_sleep(K_USEC(100));
+
+	zassert_true(GetAiclkTarg() <= before - CONFIG_TT_BH_ARC_THM_ALARM_STEP_MHZ,
+		     "AICLK target %u MHz after the alarm, %u MHz before", GetAiclkTarg(), before);
+
+	/* The off-schedule tick is not one of the periodic ticks */
+	GetDVFSStats(&stats);
+	zassert_equal(stats.ticks, 0);
+	zassert_equal(stats.missed, 0);
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	ReadReg_fake.custom_fake = sim_read_reg;
+	WriteReg_fake.custom_fake = sim_write_reg;
+
+	plant.activity = 0.0F;
+	plant.temp_c = AMBIENT_C;
+	avs_count = 0;
+	i2c_frame_len = 0;
+
+	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
+		SetAiclkArbMax(i, GetAiclkFmax());
+	}
+	EnableArbMax(kAiclkArbMaxFmax, true);
+	for (AiclkArbMin i = 0; i < kAiclkArbMinCount; i++) {
+		SetAiclkArbMin(i, GetAiclkFmin());
+		EnableArbMin(i, true);
+	}
+	set_busy(true);
+
+	InitVoltagePPM();
+	InitArbMaxVoltage();
+	InitThrottlers();
+	dvfs_enabled = true;
+
+	/* Start every trace from AICLK at rest */
+	step_plant();
+	DVFSChange();
+	wait_for_ramp();
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	StopDVFSTimer();
+	wait_for_ramp();
+	dvfs_enabled = false;
+	set_busy(false);
+}
+
+ZTEST_SUITE(dvfs_sim, NULL, NULL, before, after, NULL);
@@ -97,4 +97,37 @@ ZTEST(gddr, test_mrisc_power_off)
 	num_mrisc_msgs = 0U;
 }
 
+static const uint32_t mrisc_telemetry_table =
+	ARC_NOC0_BASE_ADDR + (mrisc_tlb << NOC_TLB_LOG_SIZE) + GDDR_TELEMETRY_TABLE_ADDR;
+
+uint32_t read_reg_fake_gddr_telemetry(uint32_t addr)
+{
+	uint32_t word = (addr - mrisc_telemetry_table) / sizeof(uint32_t);
+
+	if (word == 0) {
+		return GDDR_TELEMETRY_TABLE_T_VERSION;
+	}
+
+	return 0x01010000 * word + word;
+}
+
+ZTEST(gddr, test_read_telemetry_table)
+{
+	gddr_telemetry_table_t gddr_telemetry;
+
+	ReadReg_fake.custom_fake = read_reg_fake_gddr_telemetry;
+	zassert_equal(read_gddr_telemetry_table(0, &gddr_telemetry), 0);
+
+	/* Without DMA the table is read a word at a time through one TLB window */
+	zassert_equal(ReadReg_fake.call_count, sizeof(gddr_telemetry) / sizeof(uint32_t));
+	for (uint32_t i = 0; i < ReadReg_fake.call_count; i++) {
+		zassert_equal(ReadReg_fake.arg0_history[i],
+			      mrisc_telemetry_table + i * sizeof(uint32_t));
+	}
+
+	zassert_equal(gddr_telemetry.dram_temperature_top, 1);
+	zassert_equal(gddr_telemetry.dram_temperature_bottom, 0x0101);
+	zassert_equal(gddr_telemetry.dram_speed, 2);
+}
+
 ZTEST_SUITE(gddr, NULL, NULL, NULL, NULL, NULL);
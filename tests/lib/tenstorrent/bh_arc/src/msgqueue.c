@@ -105,6 +105,215 @@ ZTEST(msgqueue, test_msgqueue_register_handler)
 	zassert_equal(rsp.data[1], 0x73737373);
 }
 
+static uint32_t sched_log[16];
+static uint32_t sched_log_len;
+
+static uint8_t msgqueue_handler_sched_log(const union request *req, struct response *rsp)
+{
+	if (sched_log_len < ARRAY_SIZE(sched_log)) {
+		sched_log[sched_log_len++] = req->data[1];
+	}
+	return 0;
+}
+
+/* Queue msgs tagged with (queue << 8 | n) on each queue, then run them all in one call. */
+static void run_sched_msgs(const uint32_t *count_per_queue)
+{
+	union request sched_req = {0};
+	struct response sched_rsp = {0};
+
+	sched_log_len = 0;
+	msgqueue_register_handler(0x74, msgqueue_handler_sched_log);
+
+	for (uint32_t q = 0; q < NUM_MSG_QUEUES; q++) {
+		for (uint32_t n = 0; n < count_per_queue[q]; n++) {
+			sched_req.data[0] = 0x74;
+			sched_req.data[1] = (q << 8) | n;
+			msgqueue_request_push(q, &sched_req);
+		}
+	}
+
+	process_message_queues();
+
+	for (uint32_t q = 0; q < NUM_MSG_QUEUES; q++) {
+		for (uint32_t n = 0; n < count_per_queue[q]; n++) {
+			msgqueue_response_pop(q, &sched_rsp);
+			zexpect_equal(sched_rsp.data[0], 0);
+		}
+	}
+}
+
+/* Restore the Kconfig scheduling defaults. */
+static void reset_sched(void)
+{
+	static const uint8_t priorities[NUM_MSG_QUEUES] = {
+		CONFIG_TT_BH_ARC_MSGQUEUE_0_PRIORITY,
+		CONFIG_TT_BH_ARC_MSGQUEUE_1_PRIORITY,
+		CONFIG_TT_BH_ARC_MSGQUEUE_2_PRIORITY,
+		CONFIG_TT_BH_ARC_MSGQUEUE_3_PRIORITY,
+	};
+
+	for (uint32_t q = 0; q < NUM_MSG_QUEUES; q++) {
+		msgqueue_set_priority(q, priorities[q]);
+		msgqueue_set_budget(q, CONFIG_TT_BH_ARC_MSGQUEUE_BUDGET);
+	}
+}
+
+ZTEST(msgqueue, test_msgqueue_default_priority)
+{
+	static const uint32_t counts[NUM_MSG_QUEUES] = {2, 2, 0, 0};
+	static const uint32_t expected[] = {0x000, 0x001, 0x100, 0x101};
+
+	reset_sched();
+
+	/* Queue 0 carries the runtime's AICLK requests and is drained before the others */
+	run_sched_msgs(counts);
+
+	zassert_equal(sched_log_len, ARRAY_SIZE(expected));
+	zassert_mem_equal(sched_log, expected, sizeof(expected));
+}
+
+ZTEST(msgqueue, test_msg_type_msgqueue_sched)
+{
+	static const uint32_t counts[NUM_MSG_QUEUES] = {0, 2, 0, 1};
+	static const uint32_t expected[] = {0x300, 0x100, 0x101};
+
+	reset_sched();
+
+	/* Read queue 3 without changing it */
+	req.data[0] = TT_SMC_MSG_MSGQUEUE_SCHED | (3 << 8);
+	push_msg_success();
+	zexpect_equal(rsp.data[1], CONFIG_TT_BH_ARC_MSGQUEUE_3_PRIORITY);
+	zexpect_equal(rsp.data[2], CONFIG_TT_BH_ARC_MSGQUEUE_BUDGET);
+
+	/* Move queue 3 ahead of queue 1 with a budget of 2 */
+	req.data[0] = TT_SMC_MSG_MSGQUEUE_SCHED | (3 << 8) | (0 << 16) | (2 << 24);
+	push_msg_success();
+	zexpect_equal(rsp.data[1], 0);
+	zexpect_equal(rsp.data[2], 2);
+	zexpect_equal(msgqueue_get_priority(3), 0);
+
+	run_sched_msgs(counts);
+
+	zassert_equal(sched_log_len, ARRAY_SIZE(expected));
+	zassert_mem_equal(sched_log, expected, sizeof(expected));
+
+	/* Unknown queue */
+	req.data[0] = TT_SMC_MSG_MSGQUEUE_SCHED | (NUM_MSG_QUEUES << 8);
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+	zexpect_equal(rsp.data[0], 1);
+
+	reset_sched();
+}
+
+ZTEST(msgqueue, test_msgqueue_priority_order)
+{
+	static const uint32_t counts[NUM_MSG_QUEUES] = {0, 3, 2, 0};
+	static const uint32_t expected[] = {0x200, 0x201, 0x100, 0x101, 0x102};
+
+	reset_sched();
+	msgqueue_set_priority(2, 0);
+	msgqueue_set_priority(1, 1);
+	zexpect_equal(msgqueue_get_priority(1), 1);
+
+	run_sched_msgs(counts);
+
+	zassert_equal(sched_log_len, ARRAY_SIZE(expected));
+	zassert_mem_equal(sched_log, expected, sizeof(expected));
+
+	reset_sched();
+}
+
+ZTEST(msgqueue, test_msgqueue_equal_priority_round_robin)
+{
+	static const uint32_t counts[NUM_MSG_QUEUES] = {0, 3, 2, 0};
+	static const uint32_t expected[] = {0x100, 0x200, 0x101, 0x201, 0x102};
+
+	reset_sched();
+
+	run_sched_msgs(counts);
+
+	zassert_equal(sched_log_len, ARRAY_SIZE(expected));
+	zassert_mem_equal(sched_log, expected, sizeof(expected));
+}
+
+ZTEST(msgqueue, test_msgqueue_budget)
+{
+	static const uint32_t counts[NUM_MSG_QUEUES] = {0, 3, 3, 0};
+	static const uint32_t expected[] = {0x100, 0x101, 0x200, 0x201, 0x102, 0x202};
+
+	reset_sched();
+	msgqueue_set_budget(1, 2);
+	msgqueue_set_budget(2, 2);
+
+	run_sched_msgs(counts);
+
+	zassert_equal(sched_log_len, ARRAY_SIZE(expected));
+	zassert_mem_equal(sched_log, expected, sizeof(expected));
+
+	reset_sched();
+}
+
+ZTEST(msgqueue, test_msgqueue_sched_invalid_args)
+{
+	zexpect_equal(msgqueue_set_priority(NUM_MSG_QUEUES, 0), -1);
+	zexpect_equal(msgqueue_get_priority(NUM_MSG_QUEUES), -1);
+	zexpect_equal(msgqueue_set_budget(NUM_MSG_QUEUES, 1), -1);
+	zexpect_equal(msgqueue_set_budget(0, 0), -1);
+}
+
+static struct msgqueue_deferred_response deferred_token;
+
+static uint8_t msgqueue_handler_deferred(const union request *req, struct response *rsp)
+{
+	zassert_equal(msgqueue_defer_response(&deferred_token), 0);
+	/* A second deferral of the same message is rejected */
+	zexpect_equal(msgqueue_defer_response(&deferred_token), -1);
+	return 0;
+}
+
+ZTEST(msgqueue, test_msgqueue_deferred_response)
+{
+	union request deferred_req = {0};
+	struct response deferred_rsp = {0};
+	struct response completion = {0};
+
+	msgqueue_register_handler(0x75, msgqueue_handler_deferred);
+	msgqueue_register_handler(0x73, msgqueue_handler_73);
+
+	/* Outside of a handler there is nothing to defer */
+	zexpect_equal(msgqueue_defer_response(&deferred_token), -1);
+
+	deferred_req.data[0] = 0x75;
+	msgqueue_request_push(1, &deferred_req);
+	deferred_req.data[0] = 0x73;
+	msgqueue_request_push(1, &deferred_req);
+	process_message_queues();
+
+	zexpect_equal(deferred_token.msgqueue_id, 1);
+
+	/* Other queues keep running while the response is outstanding */
+	req.data[0] = TT_SMC_MSG_TEST;
+	req.data[1] = 1;
+	push_msg_success();
+	zexpect_equal(rsp.data[1], 2);
+
+	completion.data[1] = 0xCAFE;
+	zassert_equal(msgqueue_complete_deferred(&deferred_token, &completion, 3), 0);
+	/* Completing twice fails */
+	zexpect_equal(msgqueue_complete_deferred(&deferred_token, &completion, 3), -1);
+
+	/* Responses are published in request order */
+	msgqueue_response_pop(1, &deferred_rsp);
+	zexpect_equal(deferred_rsp.data[0], 3);
+	zexpect_equal(deferred_rsp.data[1], 0xCAFE);
+	msgqueue_response_pop(1, &deferred_rsp);
+	zexpect_equal(deferred_rsp.data[0], 0);
+	zexpect_equal(deferred_rsp.data[1], 0x73);
+}
+
 ZTEST(msgqueue, test_msgqueue_power_settings_cmd)
 {
 	const struct device *pll4 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pll4));
@@ -414,6 +623,102 @@ ZTEST(msgqueue, test_msg_type_test)
 	zexpect_equal(rsp.data[1], 43); /* test_value + 1 */
 }
 
+ZTEST(msgqueue, test_msg_type_get_msg_stats)
+{
+	uint32_t total = 0;
+
+	/* Clear any statistics from earlier tests */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | BIT(24);
+	push_msg_success();
+
+	for (int i = 0; i < 3; i++) {
+		req.data[0] = TT_SMC_MSG_TEST;
+		req.data[1] = i;
+		push_msg_success();
+	}
+
+	/* Summary page */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | (TT_SMC_MSG_TEST << 8);
+	push_msg_success();
+	zexpect_equal(rsp.data[1], 3);
+	zexpect_true(rsp.data[2] <= rsp.data[3]);
+	zexpect_true(rsp.data[4] >= rsp.data[2] && rsp.data[4] <= rsp.data[3]);
+	zexpect_equal(rsp.data[7], 0);
+
+	/* Service time histogram pages together hold every message */
+	for (uint32_t page = 1; page <= 3; page++) {
+		req.data[0] = TT_SMC_MSG_GET_MSG_STATS | (TT_SMC_MSG_TEST << 8) | (page << 16);
+		push_msg_success();
+		for (int i = 1; i < RESPONSE_MSG_LEN; i++) {
+			total += rsp.data[i];
+		}
+	}
+	zexpect_equal(total, 3);
+
+	/* Out of range page */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | (TT_SMC_MSG_TEST << 8) | (9 << 16);
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+	zexpect_equal(rsp.data[0], 1);
+}
+
+ZTEST(msgqueue, test_msgqueue_batched_publication)
+{
+	/* Clear statistics, this run counts as one wakeup with one message */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | BIT(24);
+	push_msg_success();
+
+	/* A burst of three requests is handled in one wakeup */
+	req.data[0] = TT_SMC_MSG_TEST;
+	for (int i = 0; i < 3; i++) {
+		req.data[1] = i;
+		msgqueue_request_push(0, &req);
+	}
+	process_message_queues();
+	for (int i = 0; i < 3; i++) {
+		msgqueue_response_pop(0, &rsp);
+		zexpect_equal(rsp.data[0], 0);
+		zexpect_equal(rsp.data[1], i + 1);
+	}
+
+	/* Wakeup counters */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | (7 << 16);
+	push_msg_success();
+	zexpect_equal(rsp.data[1], 2); /* wakeups */
+	zexpect_equal(rsp.data[4], 4); /* messages */
+	zexpect_equal(rsp.data[5], 3); /* max messages per wakeup */
+	/* The burst needed a single response pointer update */
+	zexpect_equal(rsp.data[6], 2);
+
+	/* Messages per wakeup histogram: two wakeups with 1 message, one with 2-3 */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | (8 << 16);
+	push_msg_success();
+	zexpect_equal(rsp.data[1], 0);
+	zexpect_equal(rsp.data[2], 2);
+	zexpect_equal(rsp.data[3], 1);
+}
+
+ZTEST(msgqueue, test_msgqueue_publish_per_slice)
+{
+	static const uint32_t counts[NUM_MSG_QUEUES] = {0, 2, 2, 0};
+
+	reset_sched();
+
+	/* Clear statistics, this run publishes one response */
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | BIT(24);
+	push_msg_success();
+
+	/* Queues 1 and 2 alternate one message slices. Each slice publishes its own response
+	 * rather than waiting for the other queue to drain.
+	 */
+	run_sched_msgs(counts);
+
+	req.data[0] = TT_SMC_MSG_GET_MSG_STATS | (7 << 16);
+	push_msg_success();
+	zexpect_equal(rsp.data[6], 5);
+}
+
 ZTEST(msgqueue, test_msg_type_asic_state)
 {
 	union request req = {0};
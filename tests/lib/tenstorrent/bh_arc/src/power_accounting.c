@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "power_accounting.h"
+
+static const uint32_t window_samples[POWER_WINDOW_COUNT] = {1, 10, 100, 1000, 10000};
+
+/* The moving average that Doppler used before power accounting: one uint16_t per sample */
+struct reference_window {
+	uint16_t history[10000];
+	uint32_t length;
+	uint32_t cursor;
+	uint32_t sum;
+};
+
+static struct reference_window reference[POWER_WINDOW_COUNT];
+static struct power_account acct;
+
+static void reference_update(struct reference_window *ref, uint16_t sample)
+{
+	ref->sum += sample - ref->history[ref->cursor];
+	ref->history[ref->cursor] = sample;
+	ref->cursor = (ref->cursor + 1) % ref->length;
+}
+
+static float reference_average(const struct reference_window *ref)
+{
+	return (float)ref->sum / ref->length;
+}
+
+static void update(uint16_t sample)
+{
+	PowerAccountUpdate(&acct, sample);
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		reference_update(&reference[w], sample);
+	}
+}
+
+/* Board power that steps between 120 and 270 W every 1.7 s, with up to 30 W of noise */
+static uint16_t trace_sample(uint32_t n)
+{
+	uint16_t level = (n / 1700) % 2 ? 270 : 120;
+
+	return level + rand() % 31;
+}
+
+static void *power_accounting_setup(void)
+{
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		reference[w].length = window_samples[w];
+	}
+
+	return NULL;
+}
+
+static void power_accounting_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	PowerAccountInit(&acct);
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		memset(reference[w].history, 0, sizeof(reference[w].history));
+		reference[w].cursor = 0;
+		reference[w].sum = 0;
+	}
+	srand(1);
+}
+
+ZTEST(power_accounting, test_box_matches_moving_average)
+{
+	float max_error[POWER_WINDOW_COUNT] = {0};
+
+	for (uint32_t n = 0; n < 30000; n++) {
+		update(trace_sample(n));
+
+		for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+			float error = fabsf(PowerAccountAverage(&acct, w) -
+					    reference_average(&reference[w]));
+
+			max_error[w] = MAX(max_error[w], error);
+		}
+	}
+
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		TC_PRINT("window %u: max error %.3f W\n", window_samples[w], (double)max_error[w]);
+	}
+
+	/* Windows of single samples are exact */
+	zassert_within(max_error[POWER_WINDOW_1MS], 0, 0.01);
+	zassert_within(max_error[POWER_WINDOW_10MS], 0, 0.01);
+
+	/* Longer windows prorate their oldest sub-window. A 150 W step inside it is off by at most
+	 * a quarter of the step over a tenth of the window, plus the noise in that sub-window.
+	 */
+	for (enum power_window w = POWER_WINDOW_100MS; w < POWER_WINDOW_COUNT; w++) {
+		zassert_true(max_error[w] <= 150 / 40.0f + 30 / 10.0f, "window %u off by %f W",
+			     window_samples[w], (double)max_error[w]);
+	}
+}
+
+ZTEST(power_accounting, test_constant_power)
+{
+	for (uint32_t n = 0; n < 10000; n++) {
+		update(200);
+	}
+
+	for (enum power_window w = 0; w < POWER_WINDOW_COUNT; w++) {
+		zassert_within(PowerAccountAverage(&acct, w), 200, 0.01);
+		/* The 10 s average has only seen one time constant */
+		if (w < POWER_WINDOW_10S) {
+			zassert_within(PowerAccountEma(&acct, w), 200, 0.5);
+		}
+	}
+}
+
+ZTEST(power_accounting, test_ema_time_constant)
+{
+	for (uint32_t n = 0; n < 1000; n++) {
+		PowerAccountUpdate(&acct, 100);
+	}
+
+	/* After one time constant a step has risen by 1 - 1/e */
+	zassert_equal(PowerAccountEma(&acct, POWER_WINDOW_1MS), 100);
+	zassert_within(PowerAccountEma(&acct, POWER_WINDOW_1S), 63.2, 0.5);
+	zassert_within(PowerAccountEma(&acct, POWER_WINDOW_10S), 9.5, 0.5);
+}
+
+ZTEST(power_accounting, test_cost)
+{
+	/* Every window, up to 10 s, in less state than the old 1 s history alone */
+	TC_PRINT("power account %zu B, 1 s moving average %zu B\n", sizeof(struct power_account),
+		 sizeof(uint16_t) * 1000);
+	zassert_true(sizeof(struct power_account) < sizeof(uint16_t) * 1000 / 4);
+}
+
+ZTEST_SUITE(power_accounting, NULL, power_accounting_setup, power_accounting_before, NULL, NULL);
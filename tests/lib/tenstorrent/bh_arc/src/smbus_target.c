@@ -7,6 +7,8 @@
 #include <zephyr/ztest.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/fff.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
 #include <tenstorrent/tt_smbus_regs.h>
 #include <zephyr/drivers/i2c.h>
 #include "reg_mock.h"
@@ -248,4 +250,98 @@ ZTEST(smbus_target, test_block_write_block_read_with_pec)
 	zexpect_equal(4, read_data[0]);
 }
 
+/* Issues a telemetry block read and checks the block size and PEC of the response */
+static void telem_block_read(const uint8_t *select, uint8_t select_size, uint32_t *values,
+			     uint8_t count)
+{
+	uint8_t write_data[2 + 10] = {CMFW_SMBUS_TELEMETRY_BLOCK_READ, select_size};
+	uint8_t read_data[1 + 255 + 1];
+	uint8_t read_size = 1 + count * sizeof(uint32_t) + 1;
+	uint8_t pec_data[2 + 10 + 1 + 1 + 255];
+	uint8_t pec_size = 0;
+
+	memcpy(&write_data[2], select, select_size);
+	zassert_equal(0, i2c_write_read(i2c0_dev, tt_i2c_addr, write_data, 2 + select_size,
+					read_data, read_size));
+	zassert_equal(count * sizeof(uint32_t), read_data[0]);
+
+	pec_data[pec_size++] = tt_i2c_addr << 1;
+	memcpy(&pec_data[pec_size], write_data, 2 + select_size);
+	pec_size += 2 + select_size;
+	pec_data[pec_size++] = tt_i2c_addr << 1 | 1;
+	memcpy(&pec_data[pec_size], read_data, read_size - 1);
+	pec_size += read_size - 1;
+	zexpect_equal(crc8(pec_data, pec_size, 0x07, 0, false), read_data[read_size - 1]);
+
+	for (uint8_t i = 0; i < count; i++) {
+		values[i] = sys_get_le32(&read_data[1 + i * sizeof(uint32_t)]);
+	}
+}
+
+ZTEST(smbus_target, test_telem_block_read_range)
+{
+	const uint16_t tags[] = {TAG_VCORE, TAG_TDP, TAG_TDC};
+	const uint32_t expected[] = {750, 120, 160};
+	const uint8_t select[] = {CMFW_SMBUS_TELEM_BLOCK_RANGE, TAG_VCORE, ARRAY_SIZE(tags)};
+	uint32_t values[ARRAY_SIZE(tags)];
+
+	UpdateTelemetryTags(tags, expected, ARRAY_SIZE(tags));
+	telem_block_read(select, sizeof(select), values, ARRAY_SIZE(values));
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zexpect_equal(expected[i], values[i]);
+	}
+}
+
+ZTEST(smbus_target, test_telem_block_read_bitmap)
+{
+	const uint16_t tags[] = {TAG_VCORE, TAG_TDC, TAG_AICLK};
+	const uint32_t expected[] = {800, 90, 1350};
+	/* Bits 0, 2 and 8 of a bitmap based at TAG_VCORE */
+	const uint8_t select[] = {CMFW_SMBUS_TELEM_BLOCK_BITMAP, TAG_VCORE, 0x05, 0x01};
+	uint32_t values[ARRAY_SIZE(tags)];
+
+	UpdateTelemetryTags(tags, expected, ARRAY_SIZE(tags));
+	telem_block_read(select, sizeof(select), values, ARRAY_SIZE(values));
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zexpect_equal(expected[i], values[i]);
+	}
+}
+
+ZTEST(smbus_target, test_telem_block_read_max_tags)
+{
+	const uint8_t count = CONFIG_SMBUS_MAX_MSG_SIZE / sizeof(uint32_t);
+	const uint8_t select[] = {CMFW_SMBUS_TELEM_BLOCK_RANGE, 0, count};
+	const uint16_t tag = TAG_TDP;
+	const uint32_t expected = 150;
+	uint32_t values[CONFIG_SMBUS_MAX_MSG_SIZE / sizeof(uint32_t)];
+
+	UpdateTelemetryTags(&tag, &expected, 1);
+	telem_block_read(select, sizeof(select), values, count);
+	zexpect_equal(expected, values[TAG_TDP]);
+}
+
+ZTEST(smbus_target, test_telem_block_read_bad_select)
+{
+	const uint8_t bad_selects[][4] = {
+		{CMFW_SMBUS_TELEM_BLOCK_RANGE, TAG_VCORE, 0},
+		{CMFW_SMBUS_TELEM_BLOCK_RANGE, TAG_VCORE, 64},
+		{CMFW_SMBUS_TELEM_BLOCK_RANGE, TAG_COUNT - 1, 2},
+		{CMFW_SMBUS_TELEM_BLOCK_BITMAP, TAG_VCORE, 0, 0},
+		{CMFW_SMBUS_TELEM_BLOCK_BITMAP, TAG_COUNT - 8, 0, 0x80},
+		{0xFF, TAG_VCORE, 1},
+	};
+	uint8_t write_data[2 + 4] = {CMFW_SMBUS_TELEMETRY_BLOCK_READ, 4};
+	uint8_t read_data[1];
+
+	for (size_t i = 0; i < ARRAY_SIZE(bad_selects); i++) {
+		/* Range and unknown mode selections are 3 bytes, bitmaps here are 4 */
+		write_data[1] = bad_selects[i][0] == CMFW_SMBUS_TELEM_BLOCK_BITMAP ? 4 : 3;
+		memcpy(&write_data[2], bad_selects[i], write_data[1]);
+		zexpect_equal(-1, i2c_write_read(i2c0_dev, tt_i2c_addr, write_data,
+						 2 + write_data[1], read_data, sizeof(read_data)),
+			      "selection %zu", i);
+		tear_down_tc(NULL);
+	}
+}
+
 ZTEST_SUITE(smbus_target, NULL, NULL, NULL, tear_down_tc, NULL);
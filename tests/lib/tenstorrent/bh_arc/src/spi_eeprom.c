@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+#include <tenstorrent/smc_msg.h>
+#include <tenstorrent/msgqueue.h>
+
+#include "bulk_mailbox.h"
+
+/* buffer_mem_type for a bulk mailbox transfer, see spi_eeprom.c */
+#define EEPROM_BUFFER_BULK_MAILBOX 1
+
+#define TEST_SPI_ADDR DT_REG_ADDR(DT_NODELABEL(storage_partition))
+
+static const struct device *flash = DEVICE_DT_GET(DT_NODELABEL(spi_flash));
+
+static uint8_t pattern[CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE];
+
+static void send_msg(union request *req, struct response *rsp)
+{
+	msgqueue_request_push(0, req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+}
+
+static void *spi_eeprom_setup(void)
+{
+	struct flash_pages_info info;
+	size_t erased = 0;
+
+	zassert_true(device_is_ready(flash));
+
+	for (uint32_t i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = (uint8_t)(i * 13 + 5);
+	}
+
+	while (erased < sizeof(pattern)) {
+		zassert_ok(flash_get_page_info_by_offs(flash, TEST_SPI_ADDR + erased, &info));
+		zassert_ok(flash_erase(flash, info.start_offset, info.size));
+		erased += info.size;
+	}
+	zassert_ok(flash_write(flash, TEST_SPI_ADDR, pattern, sizeof(pattern)));
+
+	return NULL;
+}
+
+ZTEST(spi_eeprom, test_bulk_read)
+{
+	union request req = {0};
+	struct response rsp = {0};
+	uint8_t *mailbox = bulk_mailbox_region(0, sizeof(pattern));
+
+	zassert_not_null(mailbox);
+	memset(mailbox, 0, sizeof(pattern));
+
+	req.data[0] = TT_SMC_MSG_READ_EEPROM | (EEPROM_BUFFER_BULK_MAILBOX << 8);
+	req.data[1] = TEST_SPI_ADDR;
+	req.data[2] = sizeof(pattern);
+	req.data[3] = 0;
+
+	uint64_t start = k_cycle_get_64();
+
+	send_msg(&req, &rsp);
+
+	uint64_t elapsed_us = MAX(k_cyc_to_us_ceil64(k_cycle_get_64() - start), 1);
+
+	zexpect_equal(rsp.data[0], 0);
+	zexpect_mem_equal(mailbox, pattern, sizeof(pattern));
+	zexpect_equal(rsp.data[1], crc32_ieee(pattern, sizeof(pattern)));
+
+	TC_PRINT("%zu byte EEPROM read in %llu us (%llu KiB/s)\n", sizeof(pattern), elapsed_us,
+		 (uint64_t)sizeof(pattern) * USEC_PER_SEC / 1024 / elapsed_us);
+
+	/* An unaligned read into the middle of the mailbox */
+	memset(mailbox, 0, sizeof(pattern));
+	req.data[1] = TEST_SPI_ADDR + 3;
+	req.data[2] = 1000;
+	req.data[3] = 64;
+	send_msg(&req, &rsp);
+
+	zexpect_equal(rsp.data[0], 0);
+	zexpect_mem_equal(&mailbox[64], &pattern[3], 1000);
+	zexpect_equal(rsp.data[1], crc32_ieee(&pattern[3], 1000));
+	zexpect_equal(mailbox[63], 0);
+	zexpect_equal(mailbox[64 + 1000], 0);
+}
+
+ZTEST(spi_eeprom, test_bulk_read_out_of_bounds)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.data[0] = TT_SMC_MSG_READ_EEPROM | (EEPROM_BUFFER_BULK_MAILBOX << 8);
+	req.data[1] = TEST_SPI_ADDR;
+	req.data[2] = 8;
+	req.data[3] = CONFIG_TT_BH_ARC_BULK_MAILBOX_SIZE - 4;
+	send_msg(&req, &rsp);
+
+	zexpect_equal(rsp.data[0], 2);
+}
+
+ZTEST_SUITE(spi_eeprom, NULL, spi_eeprom_setup, NULL, NULL, NULL);
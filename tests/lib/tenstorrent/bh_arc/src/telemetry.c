@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "telemetry.h"
+
+#define RACE_UPDATES      1000
+#define WRITER_STACK_SIZE 1024
+
+/* A power, current and voltage that always come from the same update */
+static const uint16_t race_tags[] = {TAG_TDP, TAG_TDC, TAG_VCORE};
+
+static K_THREAD_STACK_DEFINE(writer_stack, WRITER_STACK_SIZE);
+static struct k_thread writer_thread;
+static volatile bool writer_done;
+
+static void telemetry_writer(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (uint32_t i = 1; i <= RACE_UPDATES; i++) {
+		uint32_t values[] = {i, i, i};
+
+		UpdateTelemetryTags(race_tags, values, ARRAY_SIZE(values));
+		k_yield();
+	}
+
+	writer_done = true;
+}
+
+static bool values_match(const uint32_t *values)
+{
+	for (size_t i = 1; i < ARRAY_SIZE(race_tags); i++) {
+		if (values[i] != values[0]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Reads race_tags the way a host does over PCIe. When slow is set, the reader yields between
+ * words, so the writer can publish an update in the middle of the read.
+ */
+static bool read_snapshot(uint32_t *values, bool slow)
+{
+	uint32_t sequence = GetTelemetryTag(TAG_TELEM_SEQUENCE);
+
+	for (size_t i = 0; i < ARRAY_SIZE(race_tags); i++) {
+		values[i] = GetTelemetryTag(race_tags[i]);
+		if (slow) {
+			k_yield();
+		}
+	}
+
+	return (sequence & 1) == 0 && sequence == GetTelemetryTag(TAG_TELEM_SEQUENCE);
+}
+
+ZTEST(telemetry, test_update_advances_sequence)
+{
+	const uint16_t tags[] = {TAG_TDP, TAG_TELEM_SEQUENCE, TAG_COUNT};
+	const uint32_t values[] = {42, 0xDEAD, 0xBEEF};
+	uint32_t sequence = GetTelemetryTag(TAG_TELEM_SEQUENCE);
+
+	zassert_equal(sequence & 1, 0);
+
+	UpdateTelemetryTags(tags, values, ARRAY_SIZE(tags));
+
+	/* Writers cannot set the sequence number directly */
+	zassert_equal(GetTelemetryTag(TAG_TELEM_SEQUENCE), sequence + 2);
+	zassert_equal(GetTelemetryTag(TAG_TDP), 42);
+}
+
+ZTEST(telemetry, test_snapshot_race)
+{
+	uint32_t values[ARRAY_SIZE(race_tags)];
+	uint32_t snapshots = 0;
+	uint32_t retries = 0;
+	uint32_t torn = 0;
+
+	writer_done = false;
+	k_thread_create(&writer_thread, writer_stack, K_THREAD_STACK_SIZEOF(writer_stack),
+			telemetry_writer, NULL, NULL, NULL, k_thread_priority_get(k_current_get()),
+			0, K_NO_WAIT);
+
+	for (uint32_t attempt = 0; !writer_done; attempt++) {
+		bool consistent = read_snapshot(values, attempt & 1);
+
+		if (!consistent) {
+			retries++;
+			torn += !values_match(values);
+			continue;
+		}
+
+		zassert_true(values_match(values), "torn snapshot: %u %u %u", values[0],
+			     values[1], values[2]);
+		snapshots++;
+		k_yield();
+	}
+
+	k_thread_join(&writer_thread, K_FOREVER);
+
+	/* The race was real: a plain read would have mixed updates */
+	zassert_true(torn > 0);
+	zassert_true(retries > 0);
+	zassert_true(snapshots > 0);
+
+	zassert_true(read_snapshot(values, true));
+	zassert_true(values_match(values));
+	zassert_equal(values[0], RACE_UPDATES);
+}
+
+ZTEST(telemetry, test_tier_periods)
+{
+	uint32_t medium_ms = GetTelemetryTierPeriod(TELEMETRY_TIER_MEDIUM);
+
+	zassert_equal(SetTelemetryTierPeriod(TELEMETRY_TIER_MEDIUM, 250), 0);
+	zassert_equal(GetTelemetryTierPeriod(TELEMETRY_TIER_MEDIUM), 250);
+
+	zassert_equal(SetTelemetryTierPeriod(TELEMETRY_TIER_COUNT, 250), -EINVAL);
+	zassert_equal(SetTelemetryTierPeriod(TELEMETRY_TIER_SLOW, TELEMETRY_PERIOD_MIN_MS - 1),
+		      -EINVAL);
+	zassert_equal(SetTelemetryTierPeriod(TELEMETRY_TIER_SLOW, TELEMETRY_PERIOD_MAX_MS + 1),
+		      -EINVAL);
+
+	zassert_equal(SetTelemetryTierPeriod(TELEMETRY_TIER_MEDIUM, medium_ms), 0);
+}
+
+ZTEST(telemetry, test_tier_periods_msg)
+{
+	union request req = {0};
+	struct response rsp = {0};
+	uint32_t fast_ms = GetTelemetryTierPeriod(TELEMETRY_TIER_FAST);
+
+	req.telemetry_periods.command_code = TT_SMC_MSG_TELEMETRY_PERIODS;
+	req.telemetry_periods.tier = TELEMETRY_TIER_FAST;
+	req.telemetry_periods.period_ms = 20;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 20);
+	zassert_equal(rsp.data[2], GetTelemetryTierPeriod(TELEMETRY_TIER_MEDIUM));
+	zassert_equal(rsp.data[3], GetTelemetryTierPeriod(TELEMETRY_TIER_SLOW));
+	zassert_equal(GetTelemetryTag(TAG_UPDATE_TELEM_SPEED), 20);
+
+	/* Out of range periods are rejected and leave the periods unchanged */
+	req.telemetry_periods.period_ms = 1;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], EINVAL);
+	zassert_equal(GetTelemetryTierPeriod(TELEMETRY_TIER_FAST), 20);
+
+	zassert_equal(SetTelemetryTierPeriod(TELEMETRY_TIER_FAST, fast_ms), 0);
+}
+
+ZTEST_SUITE(telemetry, NULL, NULL, NULL, NULL, NULL);
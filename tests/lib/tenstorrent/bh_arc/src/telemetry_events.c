@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/ztest.h>
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "telemetry.h"
+#include "telemetry_events.h"
+
+static uint32_t telem[TAG_COUNT];
+
+static uint32_t send_watch(const struct telemetry_watch_rqst *watch)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.telemetry_watch = *watch;
+	req.telemetry_watch.command_code = TT_SMC_MSG_TELEMETRY_WATCH;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	return rsp.data[0];
+}
+
+static struct telemetry_event *pop_event(struct telemetry_event_queue *queue)
+{
+	if (queue->tail == queue->head) {
+		return NULL;
+	}
+
+	return &queue->entries[queue->tail++ % queue->capacity];
+}
+
+static void before(void *fixture)
+{
+	struct telemetry_event_queue *queue = telemetry_events_get_queue();
+
+	ARG_UNUSED(fixture);
+
+	for (uint8_t id = 0; id < CONFIG_TT_BH_ARC_TELEMETRY_WATCHES; id++) {
+		send_watch(&(struct telemetry_watch_rqst){.op = TELEMETRY_WATCH_OP_CLEAR,
+							  .watch_id = id});
+	}
+
+	memset(telem, 0, sizeof(telem));
+	queue->tail = queue->head;
+}
+
+ZTEST(telemetry_events, test_rising_with_hysteresis)
+{
+	struct telemetry_event_queue *queue = telemetry_events_get_queue();
+	struct telemetry_event *event;
+
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){.op = TELEMETRY_WATCH_OP_SET,
+								.watch_id = 1,
+								.tag = TAG_TDP,
+								.threshold = 150,
+								.hysteresis = 10}),
+		      0);
+
+	telem[TAG_TDP] = 150;
+	telemetry_events_check(telem);
+	zassert_is_null(pop_event(queue));
+
+	telem[TAG_TDP] = 151;
+	telemetry_events_check(telem);
+	event = pop_event(queue);
+	zassert_not_null(event);
+	zassert_equal(event->tag, TAG_TDP);
+	zassert_equal(event->watch_id, 1);
+	zassert_equal(event->flags, TELEMETRY_EVENT_FLAG_CROSSED);
+	zassert_equal(event->value, 151);
+	zassert_equal(event->threshold, 150);
+
+	/* Staying above the threshold or dipping within the hysteresis is not a new event */
+	telem[TAG_TDP] = 200;
+	telemetry_events_check(telem);
+	telem[TAG_TDP] = 141;
+	telemetry_events_check(telem);
+	zassert_is_null(pop_event(queue));
+
+	telem[TAG_TDP] = 140;
+	telemetry_events_check(telem);
+	event = pop_event(queue);
+	zassert_not_null(event);
+	zassert_equal(event->flags, TELEMETRY_EVENT_FLAG_CLEARED);
+	zassert_equal(event->value, 140);
+}
+
+ZTEST(telemetry_events, test_falling_signed)
+{
+	struct telemetry_event_queue *queue = telemetry_events_get_queue();
+	struct telemetry_event *event;
+	uint8_t flags = TELEMETRY_WATCH_FLAG_FALLING | TELEMETRY_WATCH_FLAG_SIGNED;
+
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){
+				 .op = TELEMETRY_WATCH_OP_SET,
+				 .watch_id = 0,
+				 .flags = flags,
+				 .tag = TAG_ASIC_TEMPERATURE,
+				 .threshold = ConvertFloatToTelemetry(0.0f),
+				 .hysteresis = ConvertFloatToTelemetry(5.0f)}),
+		      0);
+
+	telem[TAG_ASIC_TEMPERATURE] = ConvertFloatToTelemetry(-1.0f);
+	telemetry_events_check(telem);
+	event = pop_event(queue);
+	zassert_not_null(event);
+	zassert_equal(event->flags, TELEMETRY_EVENT_FLAG_CROSSED);
+
+	telem[TAG_ASIC_TEMPERATURE] = ConvertFloatToTelemetry(4.0f);
+	telemetry_events_check(telem);
+	zassert_is_null(pop_event(queue));
+
+	telem[TAG_ASIC_TEMPERATURE] = ConvertFloatToTelemetry(5.0f);
+	telemetry_events_check(telem);
+	event = pop_event(queue);
+	zassert_not_null(event);
+	zassert_equal(event->flags, TELEMETRY_EVENT_FLAG_CLEARED);
+}
+
+ZTEST(telemetry_events, test_full_queue_drops)
+{
+	struct telemetry_event_queue *queue = telemetry_events_get_queue();
+	uint32_t dropped = queue->dropped;
+	uint32_t tail = queue->tail;
+
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){.op = TELEMETRY_WATCH_OP_SET,
+								.tag = TAG_TDC,
+								.threshold = 100}),
+		      0);
+
+	for (uint32_t i = 0; i < queue->capacity / 2 + 1; i++) {
+		telem[TAG_TDC] = 101;
+		telemetry_events_check(telem);
+		telem[TAG_TDC] = 0;
+		telemetry_events_check(telem);
+	}
+
+	zassert_equal(queue->head, tail + queue->capacity);
+	zassert_equal(queue->dropped, dropped + 2);
+	zassert_equal(queue->entries[tail % queue->capacity].flags, TELEMETRY_EVENT_FLAG_CROSSED);
+}
+
+ZTEST(telemetry_events, test_invalid_requests)
+{
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){
+				 .op = TELEMETRY_WATCH_OP_SET,
+				 .watch_id = CONFIG_TT_BH_ARC_TELEMETRY_WATCHES,
+				 .tag = TAG_TDP}),
+		      EINVAL);
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){.op = TELEMETRY_WATCH_OP_SET,
+								.tag = TAG_COUNT}),
+		      EINVAL);
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){.op = TELEMETRY_WATCH_OP_SET_MSI,
+								.pcie_inst = 2}),
+		      EINVAL);
+	zassert_equal(send_watch(&(struct telemetry_watch_rqst){.op = 0xFF}), EINVAL);
+}
+
+ZTEST_SUITE(telemetry_events, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include "telemetry.h"
+#include "telemetry_history.h"
+
+static uint32_t sample[TAG_COUNT];
+
+static void fill_sample(uint32_t seed)
+{
+	for (int i = 0; i < TAG_COUNT; i++) {
+		sample[i] = seed * 1000 + i;
+	}
+}
+
+/* Consume everything the host has not read yet, as a host would */
+static void drain(struct telemetry_history *history)
+{
+	history->tail = history->head;
+}
+
+ZTEST(telemetry_history, test_layout)
+{
+	struct telemetry_history *history = telemetry_history_get();
+
+	zassert_equal(history->capacity, CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_ENTRIES);
+	zassert_equal(history->entry_size, sizeof(struct telemetry_history_entry));
+	for (int i = 0; i < TELEMETRY_HISTORY_NUM_TAGS; i++) {
+		zassert_true(GetTelemetryTagValid(history->tags[i]));
+	}
+}
+
+ZTEST(telemetry_history, test_append_and_drain)
+{
+	struct telemetry_history *history = telemetry_history_get();
+
+	drain(history);
+
+	uint32_t head = history->head;
+
+	for (uint32_t n = 0; n < 3; n++) {
+		fill_sample(n);
+		telemetry_history_append(sample);
+	}
+
+	zassert_equal(history->head, head + 3);
+
+	for (uint32_t n = 0; n < 3; n++) {
+		struct telemetry_history_entry *entry =
+			&history->entries[(history->tail + n) % history->capacity];
+
+		for (int i = 0; i < TELEMETRY_HISTORY_NUM_TAGS; i++) {
+			zassert_equal(entry->values[i], n * 1000 + history->tags[i]);
+		}
+	}
+
+	drain(history);
+	zassert_equal(history->tail, head + 3);
+}
+
+ZTEST(telemetry_history, test_full_ring_drops_new_samples)
+{
+	struct telemetry_history *history = telemetry_history_get();
+
+	drain(history);
+
+	uint32_t tail = history->tail;
+	uint32_t dropped = history->dropped;
+
+	for (uint32_t n = 0; n < history->capacity + 2; n++) {
+		fill_sample(n);
+		telemetry_history_append(sample);
+	}
+
+	/* Unread entries are never overwritten */
+	zassert_equal(history->head, tail + history->capacity);
+	zassert_equal(history->dropped, dropped + 2);
+	zassert_equal(history->entries[tail % history->capacity].values[0], history->tags[0]);
+
+	/* Reading one entry frees one slot */
+	history->tail = tail + 1;
+	fill_sample(7);
+	telemetry_history_append(sample);
+	zassert_equal(history->head, tail + history->capacity + 1);
+	zassert_equal(history->entries[tail % history->capacity].values[0],
+		      7000 + history->tags[0]);
+
+	drain(history);
+}
+
+ZTEST_SUITE(telemetry_history, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "avs.h"
+#include "reg_mock.h"
+#include "telemetry_internal.h"
+
+#define AVS_CMD_REG_ADDR          0x80100000
+#define AVS_READBACK_REG_ADDR     0x80100004
+#define AVS_FIFOS_STATUS_REG_ADDR 0x80100028
+
+#define AVS_CMD_RAIL(cmd)         (((cmd) >> 19) & 0xF)
+#define AVS_CMD_CODE(cmd)         (((cmd) >> 23) & 0xF)
+#define AVS_CMD_READ(cmd)         ((((cmd) >> 28) & 0x3) == 3)
+#define AVS_CMD_VOLTAGE           0x0
+#define AVS_CMD_CURRENT_READ      0x2
+#define AVS_CMD_FIFO_VACANT       0xF00
+#define AVS_READBACK_FIFO_PENDING 0x10000
+#define AVS_READBACK_DATA_SHIFT   8
+
+/* Time the emulated regulator takes to answer a command */
+#define AVS_LATENCY_US 200
+#define AVS_FIFO_DEPTH 8
+
+static uint16_t vcore_mv;
+static uint16_t vcore_10ma;
+/* The emulated regulator stops answering while set */
+static bool avs_stalled;
+
+/* Commands sent to the regulator, and writes to any other register */
+static uint32_t cmds_sent[AVS_FIFO_DEPTH];
+static uint32_t num_cmds_sent;
+static uint32_t other_writes;
+
+static uint32_t responses[AVS_FIFO_DEPTH];
+static uint32_t ready_us[AVS_FIFO_DEPTH];
+static uint32_t response_head;
+static uint32_t response_count;
+
+static uint32_t now_us(void)
+{
+	return k_cyc_to_us_floor32(k_cycle_get_32());
+}
+
+static void avs_write_reg(uint32_t addr, uint32_t val)
+{
+	uint32_t slot = (response_head + response_count) % AVS_FIFO_DEPTH;
+
+	if (addr != AVS_CMD_REG_ADDR) {
+		other_writes++;
+		return;
+	}
+
+	if (num_cmds_sent < AVS_FIFO_DEPTH) {
+		cmds_sent[num_cmds_sent++] = val;
+	}
+
+	zassert_true(response_count < AVS_FIFO_DEPTH);
+	responses[slot] = (AVS_CMD_CODE(val) == AVS_CMD_VOLTAGE ? vcore_mv : vcore_10ma)
+			  << AVS_READBACK_DATA_SHIFT;
+	ready_us[slot] = now_us() + AVS_LATENCY_US;
+	response_count++;
+}
+
+static uint32_t avs_read_reg(uint32_t addr)
+{
+	uint32_t response;
+
+	switch (addr) {
+	case AVS_FIFOS_STATUS_REG_ADDR:
+		/* Model the time the APB read takes, so polling loops advance the clock */
+		k_busy_wait(1);
+		if (!avs_stalled && response_count > 0 &&
+		    (int32_t)(now_us() - ready_us[response_head]) >= 0) {
+			return AVS_CMD_FIFO_VACANT | AVS_READBACK_FIFO_PENDING;
+		}
+		return AVS_CMD_FIFO_VACANT;
+	case AVS_READBACK_REG_ADDR:
+		zassert_true(response_count > 0);
+		response = responses[response_head];
+		response_head = (response_head + 1) % AVS_FIFO_DEPTH;
+		response_count--;
+		return response;
+	default:
+		return 0;
+	}
+}
+
+/* Collects any sample in flight, then takes and returns a sample of the current values */
+static void read_settled(TelemetryInternalData *data)
+{
+	for (int i = 0; i < 3; i++) {
+		ReadTelemetryInternal(0, data);
+		k_busy_wait(AVS_LATENCY_US);
+	}
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	ReadReg_fake.custom_fake = avs_read_reg;
+	WriteReg_fake.custom_fake = avs_write_reg;
+	avs_stalled = false;
+}
+
+ZTEST(telemetry_internal, test_read_does_not_wait_for_sensors)
+{
+	TelemetryInternalData data;
+	uint32_t start;
+	float current;
+
+	vcore_mv = 750;
+	vcore_10ma = 1000;
+	read_settled(&data);
+	zassert_equal(data.vcore_voltage, 750);
+	zassert_within(data.vcore_current, 10.0f, 0.001f);
+	zassert_within(data.vcore_power, 7.5f, 0.001f);
+
+	/* A synchronous read waits out the regulator latency */
+	start = now_us();
+	AVSReadCurrent(AVS_VCORE_RAIL, &current);
+	zassert_true(now_us() - start >= AVS_LATENCY_US);
+
+	/* Readers get the previous sample at once while the next one is in flight */
+	vcore_mv = 800;
+	for (int i = 0; i < 5; i++) {
+		start = now_us();
+		ReadTelemetryInternal(0, &data);
+		zassert_true(now_us() - start < AVS_LATENCY_US / 10, "read took %u us",
+			     now_us() - start);
+		zassert_equal(data.vcore_voltage, 750);
+	}
+
+	k_busy_wait(AVS_LATENCY_US);
+	ReadTelemetryInternal(0, &data);
+	zassert_equal(data.vcore_voltage, 800);
+	zassert_within(data.vcore_power, 8.0f, 0.001f);
+}
+
+ZTEST(telemetry_internal, test_fresh_sample_is_not_retaken)
+{
+	TelemetryInternalData data;
+	uint32_t writes;
+
+	vcore_mv = 700;
+	read_settled(&data);
+
+	/* The newest sample is younger than max_staleness, so nothing is sent to the regulator */
+	writes = WriteReg_fake.call_count;
+	ReadTelemetryInternal(1000, &data);
+	zassert_equal(WriteReg_fake.call_count, writes);
+	zassert_equal(data.vcore_voltage, 700);
+}
+
+ZTEST(telemetry_internal, test_vcore_is_read_back_over_avs)
+{
+	TelemetryInternalData data;
+
+	vcore_mv = 720;
+	vcore_10ma = 2000;
+	read_settled(&data);
+
+	/* A sample is one AVS voltage read and one current read of the VCORE rail, and nothing
+	 * else: the PMBus readback would show up as I2C register writes.
+	 */
+	num_cmds_sent = 0;
+	other_writes = 0;
+	read_settled(&data);
+	zassert_equal(num_cmds_sent % 2, 0);
+	zassert_true(num_cmds_sent > 0);
+	for (uint32_t i = 0; i < num_cmds_sent; i++) {
+		zexpect_true(AVS_CMD_READ(cmds_sent[i]));
+		zexpect_equal(AVS_CMD_RAIL(cmds_sent[i]), AVS_VCORE_RAIL);
+		zexpect_equal(AVS_CMD_CODE(cmds_sent[i]),
+			      i % 2 == 0 ? AVS_CMD_VOLTAGE : AVS_CMD_CURRENT_READ);
+	}
+	zexpect_equal(other_writes, 0);
+
+	zassert_equal(data.vcore_voltage, 720);
+	zassert_within(data.vcore_current, 20.0f, 0.001f);
+	zassert_within(data.vcore_power, 14.4f, 0.001f);
+}
+
+ZTEST(telemetry_internal, test_sample_times_out)
+{
+	TelemetryInternalData data;
+
+	vcore_mv = 740;
+	read_settled(&data);
+
+	/* The regulator stops answering part way through a sample */
+	avs_stalled = true;
+	vcore_mv = 760;
+	ReadTelemetryInternal(0, &data);
+	num_cmds_sent = 0;
+	for (int i = 0; i < 5; i++) {
+		k_busy_wait(USEC_PER_MSEC);
+		ReadTelemetryInternal(0, &data);
+		zassert_equal(num_cmds_sent, 0);
+	}
+
+	/* Once the sample times out it is published without the missing reads and the next one
+	 * is started
+	 */
+	k_busy_wait(50 * USEC_PER_MSEC);
+	ReadTelemetryInternal(0, &data);
+	zassert_equal(data.vcore_voltage, 740);
+	zassert_equal(num_cmds_sent, 2);
+
+	/* Late responses are picked up again once the regulator recovers */
+	avs_stalled = false;
+	read_settled(&data);
+	zassert_equal(data.vcore_voltage, 760);
+}
+
+ZTEST(telemetry_internal, test_asic_temperature_source)
+{
+	TelemetryInternalData data = {
+		.asic_temperature = 60.0f,
+		.asic_temperature_max = 80.0f,
+	};
+
+	zassert_equal(GetAsicTemperature(&data, ASIC_TEMP_MEAN), 60.0f);
+	zassert_equal(GetAsicTemperature(&data, ASIC_TEMP_MAX), 80.0f);
+	zassert_within(GetAsicTemperature(&data, ASIC_TEMP_WEIGHTED_MAX),
+		       60.0f + 20.0f * CONFIG_TT_BH_ARC_HOTSPOT_WEIGHT / 100.0f, 0.001f);
+}
+
+ZTEST_SUITE(telemetry_internal, NULL, NULL, before, NULL, NULL);
@@ -4,11 +4,55 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/drivers/misc/bh_fwtable.h>
 #include <zephyr/ztest.h>
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/msgqueue.h>
 #include <stdlib.h>
 
+#include "aiclk_ppm.h"
+#include "vf_curve.h"
+#include "voltage.h"
+
+static const struct vf_point test_points[] = {
+	{.freq_mhz = 400, .voltage_mv = 700},
+	{.freq_mhz = 800, .voltage_mv = 750},
+	{.freq_mhz = 1200, .voltage_mv = 850},
+	{.freq_mhz = 1400, .voltage_mv = 950},
+};
+
+static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
+
+static float saved_freq_margin;
+static float saved_voltage_margin;
+
+/* The highest frequency in fmin..fmax whose voltage is within voltage_mv, found by brute force */
+static uint32_t max_freq_reference(uint32_t voltage_mv)
+{
+	uint32_t fmin = GetMaxAiclkForVoltage(0) + 1;
+	uint32_t fmax = GetMaxAiclkForVoltage(UINT32_MAX);
+
+	for (uint32_t freq = fmax; freq >= fmin; freq--) {
+		if (VFCurve(freq) <= voltage_mv) {
+			return freq;
+		}
+	}
+
+	return fmin - 1;
+}
+
+static void check_tables(void)
+{
+	for (uint32_t freq = AICLK_FMIN_MIN; freq <= AICLK_FMAX_MAX; freq++) {
+		zassert_within(VFCurveLookup(freq), VFCurve(freq), 1.0F, "%u MHz", freq);
+	}
+
+	for (uint32_t voltage = 400; voltage <= 1300; voltage++) {
+		zassert_equal(GetMaxAiclkForVoltage(voltage), max_freq_reference(voltage), "%u mV",
+			      voltage);
+	}
+}
+
 ZTEST(vf_curve, test_get_freq_curve_from_voltage_handler)
 {
 	union request req = {0};
@@ -79,4 +123,172 @@ ZTEST(vf_curve, test_voltage_frequency_roundtrip)
 	zassert_true(abs(freq_diff) < 50, "Roundtrip frequency error too large: %d", freq_diff);
 }
 
-ZTEST_SUITE(vf_curve, NULL, NULL, NULL, NULL, NULL);
+ZTEST(vf_curve, test_tables_match_curve)
+{
+	check_tables();
+}
+
+ZTEST(vf_curve, test_tables_follow_margins)
+{
+	float freq_margin;
+	float voltage_margin;
+	uint32_t voltage = VFCurveLookup(1000);
+
+	GetVFCurveMargins(&freq_margin, &voltage_margin);
+
+	SetVFCurveMargins(0.0F, 0.0F);
+	zassert_not_equal(VFCurveLookup(1000), voltage);
+	check_tables();
+
+	SetVFCurveMargins(-300.0F, -150.0F);
+	check_tables();
+
+	SetVFCurveMargins(freq_margin, voltage_margin);
+	zassert_equal(VFCurveLookup(1000), voltage);
+}
+
+ZTEST(vf_curve, test_piecewise_curve)
+{
+	static const struct {
+		float freq_margin;
+		float voltage_margin;
+		uint32_t freq_mhz;
+		float voltage_mv;
+	} cases[] = {
+		{0.0F, 0.0F, 400, 700.0F},   {0.0F, 0.0F, 600, 725.0F},
+		{0.0F, 0.0F, 800, 750.0F},   {0.0F, 0.0F, 1000, 800.0F},
+		{0.0F, 0.0F, 1300, 900.0F},  {0.0F, 0.0F, 1400, 950.0F},
+		/* Extrapolated from the first segment */
+		{0.0F, 0.0F, 200, 675.0F},
+		/* Margins shift the curve */
+		{100.0F, 10.0F, 700, 760.0F}, {-200.0F, -20.0F, 1400, 830.0F},
+	};
+
+	zassert_equal(SetVFCurvePoints(test_points, ARRAY_SIZE(test_points)), 0);
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		SetVFCurveMargins(cases[i].freq_margin, cases[i].voltage_margin);
+		zassert_within(VFCurve(cases[i].freq_mhz), cases[i].voltage_mv, 0.01F, "case %zu",
+			       i);
+		zassert_equal(VFCurveLookup(cases[i].freq_mhz), (uint32_t)cases[i].voltage_mv,
+			      "case %zu", i);
+		check_tables();
+	}
+}
+
+ZTEST(vf_curve, test_invalid_curve_is_rejected)
+{
+	static const struct vf_point unordered[] = {{800, 750}, {800, 800}};
+	static const struct vf_point zero_voltage[] = {{400, 700}, {800, 0}};
+	struct vf_point too_many[VF_CURVE_MAX_POINTS + 1];
+	const struct vf_point *points;
+	size_t count;
+
+	for (size_t i = 0; i < ARRAY_SIZE(too_many); i++) {
+		too_many[i] = (struct vf_point){.freq_mhz = 200 + i * 50, .voltage_mv = 700 + i};
+	}
+
+	zassert_equal(SetVFCurvePoints(test_points, 1), -EINVAL);
+	zassert_equal(SetVFCurvePoints(unordered, ARRAY_SIZE(unordered)), -EINVAL);
+	zassert_equal(SetVFCurvePoints(zero_voltage, ARRAY_SIZE(zero_voltage)), -EINVAL);
+	zassert_equal(SetVFCurvePoints(too_many, ARRAY_SIZE(too_many)), -EINVAL);
+
+	/* The default curve stays in place */
+	zassert_equal(GetVFCurvePoints(&points, &count), VF_CURVE_SOURCE_DEFAULT);
+	zassert_equal(count, 0);
+}
+
+ZTEST(vf_curve, test_get_vf_curve_handler)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	SetVFCurveMargins(25.0F, -10.0F);
+	zassert_equal(SetVFCurvePoints(test_points, ARRAY_SIZE(test_points)), 0);
+
+	req.get_vf_curve.command_code = TT_SMC_MSG_GET_VF_CURVE;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], VF_CURVE_SOURCE_CUSTOM | (ARRAY_SIZE(test_points) << 8));
+	zassert_equal((int32_t)rsp.data[2], 25);
+	zassert_equal((int32_t)rsp.data[3], -10);
+	for (size_t i = 0; i < ARRAY_SIZE(test_points); i++) {
+		zassert_equal(rsp.data[4 + i],
+			      test_points[i].freq_mhz | (test_points[i].voltage_mv << 16));
+	}
+
+	/* Reading past the end returns only the remaining points */
+	req.get_vf_curve.first_point = 3;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[4], 1400 | (950 << 16));
+	zassert_equal(rsp.data[5], 0);
+}
+
+/* Load the points through the fw_table and report which curve InitVFCurve() picked */
+static enum vf_curve_source load_fwtable_points(const struct vf_point *points, size_t count)
+{
+	FwTable *fw_table = (FwTable *)tt_bh_fwtable_get_fw_table(fwtable_dev);
+	const struct vf_point *loaded;
+	size_t loaded_count;
+
+	for (size_t i = 0; i < count; i++) {
+		fw_table->vf_curve.points[i].freq_mhz = points[i].freq_mhz;
+		fw_table->vf_curve.points[i].voltage_mv = points[i].voltage_mv;
+	}
+	fw_table->vf_curve.points_count = count;
+
+	SetVFCurvePoints(NULL, 0);
+	InitVFCurve();
+	fw_table->vf_curve.points_count = 0;
+
+	return GetVFCurvePoints(&loaded, &loaded_count);
+}
+
+ZTEST(vf_curve, test_fwtable_curve_is_validated)
+{
+	static const struct vf_point valid[] = {{400, 700}, {800, 720}, {1200, 780}, {1400, 850}};
+	static const struct vf_point falling[] = {{400, 700}, {800, 760}, {1200, 750}, {1400, 850}};
+	static const struct vf_point over_vdd_max[] = {{400, 700}, {800, 720}, {1400, 950}};
+	static const struct vf_point over_fmax[] = {{400, 700}, {800, 720}, {1600, 880}};
+	static const struct vf_point below_default[] = {{400, 700}, {800, 700}, {1200, 700}};
+	uint32_t saved_vdd_min = voltage_arbiter.vdd_min;
+	uint32_t saved_vdd_max = voltage_arbiter.vdd_max;
+
+	voltage_arbiter.vdd_min = 700;
+	voltage_arbiter.vdd_max = 900;
+
+	zexpect_equal(load_fwtable_points(valid, ARRAY_SIZE(valid)), VF_CURVE_SOURCE_FWTABLE);
+	zexpect_equal(load_fwtable_points(falling, ARRAY_SIZE(falling)), VF_CURVE_SOURCE_DEFAULT);
+	zexpect_equal(load_fwtable_points(over_vdd_max, ARRAY_SIZE(over_vdd_max)),
+		      VF_CURVE_SOURCE_DEFAULT);
+	zexpect_equal(load_fwtable_points(over_fmax, ARRAY_SIZE(over_fmax)),
+		      VF_CURVE_SOURCE_DEFAULT);
+	zexpect_equal(load_fwtable_points(below_default, ARRAY_SIZE(below_default)),
+		      VF_CURVE_SOURCE_DEFAULT);
+
+	voltage_arbiter.vdd_min = saved_vdd_min;
+	voltage_arbiter.vdd_max = saved_vdd_max;
+}
+
+static void before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	GetVFCurveMargins(&saved_freq_margin, &saved_voltage_margin);
+}
+
+static void after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	SetVFCurvePoints(NULL, 0);
+	SetVFCurveMargins(saved_freq_margin, saved_voltage_margin);
+}
+
+ZTEST_SUITE(vf_curve, NULL, NULL, before, after, NULL);